@@ -38,11 +38,13 @@ namespace OpenWifi {
 	AP_WS_Connection::AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 									   Poco::Net::HTTPServerResponse &response,
 									   uint64_t session_id, Poco::Logger &L,
-									   std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> R)
+									   AP_WS_ReactorAssignment R)
 		: Logger_(L) {
 
-		Reactor_ = R.first;
-		DbSession_ = R.second;
+		Reactor_ = R.Reactor;
+		DbSession_ = R.DbSession;
+		ReactorLoad_ = R.Load;
+		ReceiveBuffer_ = R.Receive;
 		State_.sessionId = session_id;
 
 		WS_ = std::make_unique<Poco::Net::WebSocket>(request, response);
@@ -55,8 +57,11 @@ namespace OpenWifi {
 		WS_->setKeepAlive(true);
 		WS_->setBlocking(false);
 		uuid_ = MicroServiceRandom(std::numeric_limits<std::uint64_t>::max()-1);
+		MaxQueuedFrames_ = AP_WS_Server()->SendQueueMaxFrames();
+		MaxQueuedBytes_ = AP_WS_Server()->SendQueueMaxBytes();
 
 		AP_WS_Server()->IncrementConnectionCount();
+		++ReactorLoad_->Connections;
 	}
 
 	void AP_WS_Connection::Start() {
@@ -98,10 +103,14 @@ namespace OpenWifi {
 
 	void AP_WS_Connection::EndConnection() {
 		bool expectedValue=false;
-		if (Dead_.compare_exchange_strong(expectedValue,true,std::memory_order_release,std::memory_order_relaxed)) {
+		if (Dead_.compare_exchange_strong(expectedValue,true)) {
 
-			if(!SerialNumber_.empty() && State_.LastContact!=0) {
-				StorageService()->SetDeviceLastRecordedContact(SerialNumber_, State_.LastContact);
+			if (CountedConnected_.exchange(false)) {
+				AP_WS_Server()->DeviceDisconnected(State_.started);
+			}
+
+			if(!SerialNumber_.empty() && LastContact_!=0) {
+				StorageService()->SetDeviceLastRecordedContact(SerialNumber_, LastContact_);
 			}
 
 			if (Registered_) {
@@ -117,7 +126,13 @@ namespace OpenWifi {
 							  *this, &AP_WS_Connection::OnSocketError));
 				Registered_=false;
 			}
+			{
+				std::lock_guard G(SendQueueMutex_);
+				RemoveWritableHandler();
+				FlushSendQueue();
+			}
 			WS_->close();
+			--ReactorLoad_->Connections;
 
 			if(!SerialNumber_.empty()) {
 				DeviceDisconnectionCleanup(SerialNumber_, uuid_);
@@ -153,6 +168,7 @@ namespace OpenWifi {
 
 			poco_trace(Logger_, fmt::format("TLS-CONNECTION({}): Session={} Connection is secure.",
 											CId_, State_.sessionId));
+			AP_WS_Server()->CountHandshake(SS->sessionWasReused());
 
 			if (!SS->havePeerCertificate()) {
 				State_.VerifiedCertificate = GWObjects::NO_CERTIFICATE;
@@ -321,7 +337,8 @@ namespace OpenWifi {
 				}
 
 				if (Utils::ExtractBase64CompressedData(CompressedData, UncompressedData,
-													   compress_sz)) {
+													   compress_sz,
+													   AP_WS_Server()->MaxDecompressedSize())) {
 					poco_trace(Logger_,
 							   fmt::format("EVENT({}): Found compressed payload expanded to '{}'.",
 										   CId_, UncompressedData));
@@ -330,7 +347,7 @@ namespace OpenWifi {
 				} else {
 					poco_warning(Logger_,
 								 fmt::format("INVALID-COMPRESSED-DATA({}): Compressed cannot be "
-											 "uncompressed - content must be corrupt..: size={}",
+											 "uncompressed - content must be corrupt or too large..: size={}",
 											 CId_, CompressedData.size()));
 					Errors_++;
 					return;
@@ -489,11 +506,6 @@ namespace OpenWifi {
 		return Send(OS.str());
 	}
 
-	void AP_WS_Connection::UpdateCounts() {
-		State_.kafkaClients = TelemetryKafkaRefCount_;
-		State_.webSocketClients = TelemetryWebSocketRefCount_;
-	}
-
 	bool AP_WS_Connection::SetWebSocketTelemetryReporting(
 		std::uint64_t RPCID, std::uint64_t Interval, std::uint64_t LifeTime,
 		const std::vector<std::string> &TelemetryTypes) {
@@ -506,7 +518,6 @@ namespace OpenWifi {
 		TelemetryWebSocketTimer_ = TelemetryWebSocketTimer > (std::uint64_t)TelemetryWebSocketTimer_
 									   ? (std::uint64_t)TelemetryWebSocketTimer
 									   : (std::uint64_t)TelemetryWebSocketTimer_;
-		UpdateCounts();
 		if (!TelemetryReporting_) {
 			TelemetryReporting_ = true;
 			return StartTelemetry(RPCID, TelemetryTypes);
@@ -526,7 +537,6 @@ namespace OpenWifi {
 		auto TelemetryKafkaTimer = LifeTime + Utils::Now();
 		TelemetryKafkaTimer_ =
 			TelemetryKafkaTimer > (std::uint64_t)TelemetryKafkaTimer_ ? (std::uint64_t)TelemetryKafkaTimer : (std::uint64_t)TelemetryKafkaTimer_;
-		UpdateCounts();
 		if (!TelemetryReporting_) {
 			TelemetryReporting_ = true;
 			return StartTelemetry(RPCID, TelemetryTypes);
@@ -538,7 +548,6 @@ namespace OpenWifi {
 		std::unique_lock Lock(TelemetryMutex_);
 		if (TelemetryWebSocketRefCount_)
 			TelemetryWebSocketRefCount_--;
-		UpdateCounts();
 		if (TelemetryWebSocketRefCount_ == 0 && TelemetryKafkaRefCount_ == 0) {
 			TelemetryReporting_ = false;
 			StopTelemetry(RPCID);
@@ -550,7 +559,6 @@ namespace OpenWifi {
 		std::unique_lock Lock(TelemetryMutex_);
 		if (TelemetryKafkaRefCount_)
 			TelemetryKafkaRefCount_--;
-		UpdateCounts();
 		if (TelemetryWebSocketRefCount_ == 0 && TelemetryKafkaRefCount_ == 0) {
 			TelemetryReporting_ = false;
 			StopTelemetry(RPCID);
@@ -580,7 +588,7 @@ namespace OpenWifi {
 
 		std::lock_guard	G(ConnectionMutex_);
 
-		State_.LastContact = LastContact_ = Utils::Now();
+		LastContact_ = Utils::Now();
 		if (AP_WS_Server()->Running() && (DeviceValidated_ || ValidatedDevice())) {
 			try {
 				return ProcessIncomingFrame();
@@ -600,7 +608,7 @@ namespace OpenWifi {
 	}
 
 	void AP_WS_Connection::ProcessIncomingFrame() {
-		Poco::Buffer<char> IncomingFrame(0);
+		auto &IncomingFrame = ReceiveBuffer_->Frame();
 
 		bool	KillConnection=false;
 		try {
@@ -616,18 +624,16 @@ namespace OpenWifi {
 				return EndConnection();
 			}
 
-			IncomingFrame.append(0);
-
-			State_.RX += IncomingSize;
+			RX_ += IncomingSize;
 			AP_WS_Server()->AddRX(IncomingSize);
-			State_.MessageCount++;
-			State_.LastContact = Utils::Now();
+			MessageCount_++;
+			ReactorLoad_->Messages++;
+			ReactorLoad_->Bytes += IncomingSize;
 
 			switch (Op) {
 				case Poco::Net::WebSocket::FRAME_OP_PING: {
 					poco_trace(Logger_, fmt::format("WS-PING({}): received. PONG sent back.", CId_));
-					WS_->sendFrame("", 0,
-								   (int)Poco::Net::WebSocket::FRAME_OP_PONG |
+					QueueFrame("", (int)Poco::Net::WebSocket::FRAME_OP_PONG |
 									   (int)Poco::Net::WebSocket::FRAME_FLAG_FIN);
 
 					if (KafkaManager()->Enabled()) {
@@ -653,10 +659,9 @@ namespace OpenWifi {
 				case Poco::Net::WebSocket::FRAME_OP_TEXT: {
 					poco_trace(Logger_,
 							   fmt::format("FRAME({}): Frame received (length={}, flags={}). Msg={}",
-										   CId_, IncomingSize, flags, IncomingFrame.begin()));
+										   CId_, IncomingSize, flags, ReceiveBuffer_->Text()));
 
-					Poco::JSON::Parser parser;
-					auto ParsedMessage = parser.parse(IncomingFrame.begin());
+					auto ParsedMessage = ReceiveBuffer_->Parse();
 					auto IncomingJSON = ParsedMessage.extract<Poco::JSON::Object::Ptr>();
 
 					if (IncomingJSON->has(uCentralProtocol::JSONRPC)) {
@@ -666,13 +671,13 @@ namespace OpenWifi {
 						} else if (IncomingJSON->has(uCentralProtocol::RESULT) &&
 								   IncomingJSON->has(uCentralProtocol::ID)) {
 							poco_trace(Logger_, fmt::format("RPC-RESULT({}): payload: {}", CId_,
-															IncomingFrame.begin()));
+															ReceiveBuffer_->Text()));
 							ProcessJSONRPCResult(IncomingJSON);
 						} else {
 							poco_warning(
 								Logger_,
 								fmt::format("INVALID-PAYLOAD({}): Payload is not JSON-RPC 2.0: {}",
-											CId_, IncomingFrame.begin()));
+											CId_, ReceiveBuffer_->Text()));
 						}
 					} else if (IncomingJSON->has(uCentralProtocol::RADIUS)) {
 						ProcessIncomingRadiusData(IncomingJSON);
@@ -704,21 +709,21 @@ namespace OpenWifi {
 			poco_warning(Logger_,
 						 fmt::format("ConnectionResetException({}): Text:{} Payload:{} Session:{}",
 									 CId_, E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::JSON::JSONException &E) {
 			poco_warning(Logger_,
 						 fmt::format("JSONException({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::Net::WebSocketException &E) {
 			poco_warning(Logger_,
 						 fmt::format("WebSocketException({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::Net::SSLConnectionUnexpectedlyClosedException &E) {
@@ -727,42 +732,42 @@ namespace OpenWifi {
 				fmt::format(
 					"SSLConnectionUnexpectedlyClosedException({}): Text:{} Payload:{} Session:{}",
 					CId_, E.displayText(),
-					IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+					ReceiveBuffer_->Text(),
 					State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::Net::SSLException &E) {
 			poco_warning(Logger_,
 						 fmt::format("SSLException({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::Net::NetException &E) {
 			poco_warning(Logger_,
 						 fmt::format("NetException({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::IOException &E) {
 			poco_warning(Logger_,
 						 fmt::format("IOException({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger_,
 						 fmt::format("Exception({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.displayText(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (const std::exception &E) {
 			poco_warning(Logger_,
 						 fmt::format("std::exception({}): Text:{} Payload:{} Session:{}", CId_,
 									 E.what(),
-									 IncomingFrame.begin() == nullptr ? "" : IncomingFrame.begin(),
+									 ReceiveBuffer_->Text(),
 									 State_.sessionId));
 			KillConnection=true;
 		} catch (...) {
@@ -779,49 +784,126 @@ namespace OpenWifi {
 		EndConnection();
 	}
 
+	void AP_WS_Connection::RemoveWritableHandler() {
+		//	SendQueueMutex_ must be held by the caller.
+		if (WritableRegistered_) {
+			WritableRegistered_ = false;
+			Reactor_->removeEventHandler(
+				*WS_, Poco::NObserver<AP_WS_Connection, Poco::Net::WritableNotification>(
+						  *this, &AP_WS_Connection::OnSocketWritable));
+		}
+	}
+
+	void AP_WS_Connection::FlushSendQueue() {
+		//	SendQueueMutex_ must be held by the caller.
+		if (!SendQueue_.empty()) {
+			SendQueueDropped_ += SendQueue_.size();
+			AP_WS_Server()->AddTXDropped(SendQueue_.size());
+			SendQueue_.clear();
+		}
+		SendQueueFrames_ = 0;
+		SendQueueBytes_ = 0;
+	}
+
 	bool AP_WS_Connection::Send(const std::string &Payload) {
-		try {
-			size_t BytesSent = WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-
-			/*
-			 * 	There is a possibility to actually try and send data but the device is no longer
-			 * listening. This code attempts to wait 5 seconds to see if the device is actually
-			 * still listening. if the data is not acked under 5 seconds, then we consider that the
-			 * data never made it or the device is disconnected somehow.
-			 */
-#if defined(__APPLE__)
-			tcp_connection_info info;
-			int timeout = 4000;
-			auto expireAt = std::chrono::system_clock::now() + std::chrono::milliseconds(timeout);
-			do {
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				socklen_t opt_len = sizeof(info);
-				getsockopt(WS_->impl()->sockfd(), SOL_SOCKET, TCP_CONNECTION_INFO, (void *)&info,
-						   &opt_len);
-			} while (!info.tcpi_tfo_syn_data_acked && expireAt > std::chrono::system_clock::now());
-			if (!info.tcpi_tfo_syn_data_acked)
-				return false;
-#else
-			tcp_info info;
-			int timeout = 4000;
-			auto expireAt = std::chrono::system_clock::now() + std::chrono::milliseconds(timeout);
-			do {
-				std::this_thread::sleep_for(std::chrono::milliseconds(20));
-				socklen_t opt_len = sizeof(info);
-				getsockopt(WS_->impl()->sockfd(), SOL_TCP, TCP_INFO, (void *)&info, &opt_len);
-			} while (info.tcpi_unacked > 0 && expireAt > std::chrono::system_clock::now());
-
-			if (info.tcpi_unacked > 0) {
+		return QueueFrame(Payload, Poco::Net::WebSocket::FRAME_TEXT);
+	}
+
+	bool AP_WS_Connection::QueueFrame(const std::string &Payload, int Flags) {
+		if (Dead_)
+			return false;
+
+		auto Frame = Utils::EncodeWebSocketFrame(Payload, Flags);
+		std::lock_guard G(SendQueueMutex_);
+		//	EndConnection may have run while we waited for the lock.
+		if (Dead_)
+			return false;
+
+		//	A single frame larger than the byte limit is still accepted when nothing else is
+		//	waiting, otherwise large configurations could never be delivered.
+		if (SendQueue_.size() >= MaxQueuedFrames_ ||
+			(!SendQueue_.empty() && (SendQueueBytes_ + Frame.size()) > MaxQueuedBytes_)) {
+			++SendQueueDropped_;
+			AP_WS_Server()->AddTXDropped(1);
+			poco_warning(Logger_,
+						 fmt::format("SEND-QUEUE({}): Queue full (frames={}, bytes={}). Frame of {} "
+									 "bytes dropped.",
+									 CId_, SendQueue_.size(), (std::uint64_t)SendQueueBytes_,
+									 Payload.size()));
+			return false;
+		}
+
+		SendQueueBytes_ += Frame.size();
+		SendQueue_.emplace_back(std::move(Frame));
+		SendQueueFrames_ = SendQueue_.size();
+		if (SendQueueFrames_ > SendQueueHighWater_)
+			SendQueueHighWater_ = (std::uint64_t)SendQueueFrames_;
+
+		if (!WritableRegistered_) {
+			try {
+				Reactor_->addEventHandler(
+					*WS_, Poco::NObserver<AP_WS_Connection, Poco::Net::WritableNotification>(
+							  *this, &AP_WS_Connection::OnSocketWritable));
+				WritableRegistered_ = true;
+			} catch (const Poco::Exception &E) {
+				Logger_.log(E);
+				FlushSendQueue();
 				return false;
 			}
-#endif
-			State_.TX += BytesSent;
-			AP_WS_Server()->AddTX(BytesSent);
-			return BytesSent == Payload.size();
+		}
+		return true;
+	}
+
+	void AP_WS_Connection::OnSocketWritable(
+		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf) {
+
+		//	Frames are written as raw bytes on the TLS stream under the WebSocket. A write the
+		//	socket only partly accepts leaves the rest of the frame in WireFrame_, and the next
+		//	writable notification resumes at WireOffset_. The socket stays non-blocking and
+		//	SendQueueMutex_ is only held to take the next frame, so callers of Send() never wait
+		//	on the device.
+		try {
+			auto SockImpl = dynamic_cast<Poco::Net::WebSocketImpl *>(WS_->impl());
+			auto Stream = SockImpl->streamSocketImpl();
+			while (true) {
+				if (Dead_) {
+					std::lock_guard G(SendQueueMutex_);
+					RemoveWritableHandler();
+					return;
+				}
+				if (WireOffset_ == WireFrame_.size()) {
+					std::lock_guard G(SendQueueMutex_);
+					if (SendQueue_.empty()) {
+						RemoveWritableHandler();
+						return;
+					}
+					WireFrame_ = std::move(SendQueue_.front());
+					WireOffset_ = 0;
+					SendQueue_.pop_front();
+					SendQueueFrames_ = SendQueue_.size();
+				}
+
+				auto BytesSent = Stream->sendBytes(WireFrame_.data() + WireOffset_,
+												   (int)(WireFrame_.size() - WireOffset_));
+				if (BytesSent <= 0) {
+					//	The socket buffer is full (or TLS wants to retry the same record).
+					return;
+				}
+				WireOffset_ += BytesSent;
+				SendQueueBytes_ -= BytesSent;
+				TX_ += BytesSent;
+				AP_WS_Server()->AddTX(BytesSent);
+			}
 		} catch (const Poco::Exception &E) {
-			Logger_.log(E);
+			poco_warning(Logger_, fmt::format("SEND-QUEUE({}): Cannot write to device: {}", CId_,
+											  E.displayText()));
+			{
+				std::lock_guard G(SendQueueMutex_);
+				RemoveWritableHandler();
+				FlushSendQueue();
+			}
+			EndConnection();
 		}
-		return false;
 	}
 
 	std::string Base64Encode(const unsigned char *buffer, std::size_t size) {
@@ -889,35 +971,53 @@ namespace OpenWifi {
 		}
 	}
 
-	void AP_WS_Connection::SetLastStats(const std::string &LastStats) {
-		RawLastStats_ = LastStats;
+	void AP_WS_Connection::SetLastStats(const Poco::JSON::Object::Ptr &Stats,
+										const std::string &RawStats) {
+		//	Compress and parse first, only the copy into the snapshot is done under the lock.
+		Utils::CompressedString Compressed(RawStats);
+		auto hasGPS = State_.hasGPS;
+		auto uptime = State_.uptime;
+		auto memoryUsed = State_.memoryUsed;
+		auto load = State_.load;
+		auto temperature = State_.temperature;
 		try {
-			Poco::JSON::Parser P;
-			auto Stats = P.parse(LastStats).extract<Poco::JSON::Object::Ptr>();
-			State_.hasGPS = Stats->isObject("gps");
-			auto Unit = Stats->getObject("unit");
-			auto Memory = Unit->getObject("memory");
-			std::uint64_t TotalMemory = Memory->get("total");
-			std::uint64_t FreeMemory = Memory->get("free");
-			if (TotalMemory > 0) {
-				State_.memoryUsed =
-					(100.0 * ((double)TotalMemory - (double)FreeMemory)) / (double)TotalMemory;
-			}
-			if (Unit->isArray("load")) {
-				Poco::JSON::Array::Ptr Load = Unit->getArray("load");
-				if (Load->size() > 1) {
-					State_.load = Load->get(1);
+			hasGPS = Stats->isObject("gps");
+			if (Stats->isObject("unit")) {
+				auto Unit = Stats->getObject("unit");
+				if (Unit->has("uptime")) {
+					uptime = Unit->get("uptime");
 				}
-			}
-			if (Unit->isArray("temperature")) {
-				Poco::JSON::Array::Ptr Temperature = Unit->getArray("temperature");
-				if (Temperature->size() > 1) {
-					State_.temperature = Temperature->get(0);
+				auto Memory = Unit->getObject("memory");
+				std::uint64_t TotalMemory = Memory->get("total");
+				std::uint64_t FreeMemory = Memory->get("free");
+				if (TotalMemory > 0) {
+					memoryUsed =
+						(100.0 * ((double)TotalMemory - (double)FreeMemory)) / (double)TotalMemory;
+				}
+				if (Unit->isArray("load")) {
+					Poco::JSON::Array::Ptr Load = Unit->getArray("load");
+					if (Load->size() > 1) {
+						load = Load->get(1);
+					}
+				}
+				if (Unit->isArray("temperature")) {
+					Poco::JSON::Array::Ptr Temperature = Unit->getArray("temperature");
+					if (Temperature->size() > 1) {
+						temperature = Temperature->get(0);
+					}
 				}
 			}
 		} catch (const Poco::Exception &E) {
 			poco_error(Logger_, "Failed to parse last stats: " + E.displayText());
 		}
+
+		std::unique_lock Lock(StateMutex_);
+		RawLastStats_ = Compressed;
+		State_.hasGPS = hasGPS;
+		State_.uptime = uptime;
+		State_.memoryUsed = memoryUsed;
+		State_.load = load;
+		State_.temperature = temperature;
 	}
 
 } // namespace OpenWifi
\ No newline at end of file
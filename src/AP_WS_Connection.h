@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 
 #include "Poco/JSON/Object.h"
@@ -21,13 +24,13 @@
 
 namespace OpenWifi {
 
-	class AP_WS_Connection {
+	class AP_WS_Connection : public std::enable_shared_from_this<AP_WS_Connection> {
 		static constexpr int BufSize = 256000;
 
 	  public:
 		explicit AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 								  Poco::Net::HTTPServerResponse &response, uint64_t connection_id,
-								  Poco::Logger &L, std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> R);
+								  Poco::Logger &L, AP_WS_ReactorAssignment R);
 		~AP_WS_Connection();
 
 		void EndConnection();
@@ -44,6 +47,7 @@ namespace OpenWifi {
 		bool SendRadiusCoAData(const unsigned char *buffer, std::size_t size);
 
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
+		void OnSocketWritable(const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void OnSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
 		bool LookForUpgrade(Poco::Data::Session &Session, uint64_t UUID, uint64_t &UpgradedUUID);
@@ -60,30 +64,63 @@ namespace OpenWifi {
 
 		inline void GetLastStats(std::string &LastStats) {
 			if(!Dead_) {
-				std::lock_guard G(ConnectionMutex_);
-				LastStats = RawLastStats_;
+				Utils::CompressedString Stats;
+				{
+					std::shared_lock G(StateMutex_);
+					Stats = RawLastStats_;
+				}
+				LastStats = Stats;
 			}
 		}
 
 		inline void GetLastHealthCheck(GWObjects::HealthCheck &H) {
 			if(!Dead_) {
-				std::lock_guard G(ConnectionMutex_);
+				std::shared_lock G(StateMutex_);
 				H = RawLastHealthcheck_;
 			}
 		}
 
 		inline void GetState(GWObjects::ConnectionState &State) {
 			if(!Dead_) {
-				std::lock_guard G(ConnectionMutex_);
+				std::shared_lock G(StateMutex_);
 				State = State_;
 			}
+			State.RX = RX_;
+			State.TX = TX_;
+			State.MessageCount = MessageCount_;
+			State.LastContact = LastContact_;
+			State.kafkaClients = TelemetryKafkaRefCount_;
+			State.webSocketClients = TelemetryWebSocketRefCount_;
+			State.kafkaPackets = TelemetryKafkaPackets_;
+			State.websocketPackets = TelemetryWebSocketPackets_;
+			State.txQueuedFrames = SendQueueFrames_;
+			State.txQueuedBytes = SendQueueBytes_;
+			State.txQueueHighWater = SendQueueHighWater_;
+			State.txDroppedFrames = SendQueueDropped_;
 		}
 
-		inline GWObjects::DeviceRestrictions GetRestrictions() {
+		inline void SetLocale(const std::string &Locale) {
+			std::lock_guard G(ConnectionMutex_);
+			std::unique_lock Lock(StateMutex_);
+			State_.locale = Locale;
+			LocaleLookedUp_ = true;
+		}
+
+		inline void Evict() {
 			std::lock_guard G(ConnectionMutex_);
+			EndConnection();
+		}
+
+		inline GWObjects::DeviceRestrictions GetRestrictions() {
+			std::shared_lock G(StateMutex_);
 			return Restrictions_;
 		}
 
+		[[nodiscard]] inline bool IsConnected() const {
+			std::shared_lock G(StateMutex_);
+			return State_.Connected;
+		}
+
 		[[nodiscard]] inline bool HasGPS() const { return hasGPS_; }
 		[[nodiscard]] bool ValidatedDevice();
 
@@ -108,11 +145,21 @@ namespace OpenWifi {
 		void Start();
 
 	  private:
+		//	ConnectionMutex_ serialises the socket and the processing of the device frames.
+		//	StateMutex_ guards the snapshots read by the REST and server threads: State_,
+		//	RawLastStats_, RawLastHealthcheck_ and Restrictions_. They are only changed with
+		//	ConnectionMutex_ held, and StateMutex_ is taken exclusively just for the change, so the
+		//	frame processing can read them without it. Until the device is registered by
+		//	StartSession() nothing else can reach them. Per-frame counters are atomics folded into
+		//	the snapshot by GetState().
 		mutable std::recursive_mutex ConnectionMutex_;
+		mutable std::shared_mutex StateMutex_;
 		std::mutex TelemetryMutex_;
 		Poco::Logger &Logger_;
 		std::shared_ptr<Poco::Net::SocketReactor> 	Reactor_;
 		std::shared_ptr<LockedDbSession> 	DbSession_;
+		std::shared_ptr<AP_WS_ReactorLoad>	ReactorLoad_;
+		std::shared_ptr<AP_WS_ReceiveBuffer> ReceiveBuffer_;
 		std::unique_ptr<Poco::Net::WebSocket> WS_;
 		std::string SerialNumber_;
 		uint64_t SerialNumberInt_ = 0;
@@ -137,6 +184,8 @@ namespace OpenWifi {
 			std::chrono::high_resolution_clock::now();
 		std::chrono::duration<double, std::milli> ConnectionCompletionTime_{0.0};
 		std::atomic<bool> 	Dead_ = false;
+		std::atomic_bool 	CountedConnected_ = false;	//	included in the server's connected device figures
+		bool 				LocaleLookedUp_ = false;	//	State_.locale came from the IP to country worker (StateMutex_)
 		std::atomic_bool DeviceValidated_ = false;
 		OpenWifi::GWObjects::DeviceRestrictions Restrictions_;
 		bool 			RTTYMustBeSecure_ = false;
@@ -145,15 +194,37 @@ namespace OpenWifi {
 		std::uint64_t 	uuid_=0;
 		bool	Simulated_=false;
 		std::atomic_uint64_t 	LastContact_=0;
+		std::atomic_uint64_t 	RX_=0, TX_=0, MessageCount_=0;
+
+		//	Outbound frames are encoded and queued here by Send() and written by the owning reactor
+		//	when the socket becomes writable, so no caller ever waits on a slow device. Control
+		//	frames such as PONG go through the same queue so they never split a frame being
+		//	written. WireFrame_ and WireOffset_ are the frame being written and are only used by
+		//	the reactor.
+		std::mutex 				SendQueueMutex_;
+		std::deque<std::string>	SendQueue_;
+		bool 					WritableRegistered_ = false;
+		std::string 			WireFrame_;
+		std::size_t 			WireOffset_ = 0;
+		std::uint64_t 			MaxQueuedFrames_ = 64;
+		std::uint64_t 			MaxQueuedBytes_ = 4 * 1024 * 1024;
+		std::atomic_uint64_t 	SendQueueFrames_ = 0;
+		std::atomic_uint64_t 	SendQueueBytes_ = 0;
+		std::atomic_uint64_t 	SendQueueHighWater_ = 0;
+		std::atomic_uint64_t 	SendQueueDropped_ = 0;
 
 		static inline std::atomic_uint64_t ConcurrentStartingDevices_ = 0;
 
 		bool StartTelemetry(uint64_t RPCID, const std::vector<std::string> &TelemetryTypes);
 		bool StopTelemetry(uint64_t RPCID);
-		void UpdateCounts();
+		bool QueueFrame(const std::string &Payload, int Flags);
+		void RemoveWritableHandler();
+		void FlushSendQueue();
 		static void DeviceDisconnectionCleanup(const std::string &SerialNumber, std::uint64_t uuid);
-		void SetLastStats(const std::string &LastStats);
+		void SetLastStats(const Poco::JSON::Object::Ptr &Stats, const std::string &RawStats);
+		struct ConnectContext;
 		void Process_connect(Poco::JSON::Object::Ptr ParamsObj, const std::string &Serial);
+		void CompleteConnect(Poco::Data::Session &Session, const ConnectContext &Ctx);
 		void Process_state(Poco::JSON::Object::Ptr ParamsObj);
 		void Process_healthcheck(Poco::JSON::Object::Ptr ParamsObj);
 		void Process_log(Poco::JSON::Object::Ptr ParamsObj);
@@ -169,7 +240,14 @@ namespace OpenWifi {
 		void Process_alarm(Poco::JSON::Object::Ptr ParamsObj);
 		void Process_rebootLog(Poco::JSON::Object::Ptr ParamsObj);
 
+		inline void SetPendingUUID(std::uint64_t UUID) {
+			std::unique_lock Lock(StateMutex_);
+			State_.PendingUUID = UUID;
+		}
+
 		inline void SetLastHealthCheck(const GWObjects::HealthCheck &H) {
+			std::unique_lock Lock(StateMutex_);
+			State_.sanity = H.Sanity;
 			RawLastHealthcheck_ = H;
 		}
 
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace OpenWifi {
+
+	class AP_WS_Connection;
+
+	//	Connections keyed by serial number or session id. Serial numbers are clustered by OUI, so
+	//	keys go through a full 64-bit mixer before picking one of a power of two number of shards.
+	//	Lookups only take a shared lock on one shard.
+	class AP_WS_ConnectionTable {
+	  public:
+		using ConnectionPtr = std::shared_ptr<AP_WS_Connection>;
+		using Map = std::unordered_map<std::uint64_t, ConnectionPtr>;
+
+		struct alignas(64) Shard {
+			mutable std::shared_mutex 	Mutex;
+			Map 						Entries;
+		};
+
+		//	Must be called before the table is used.
+		inline void Resize(std::uint64_t NumberOfShards) {
+			std::uint64_t Count = 1;
+			while (Count < NumberOfShards && Count < MaxShards)
+				Count <<= 1;
+			Shards_ = std::make_unique<Shard[]>(Count);
+			Mask_ = Count - 1;
+		}
+
+		[[nodiscard]] inline std::uint64_t Size() const { return Mask_ + 1; }
+		[[nodiscard]] inline std::uint64_t Count() const { return Count_; }
+
+		//	splitmix64 finalizer
+		[[nodiscard]] static inline std::uint64_t Hash(std::uint64_t Key) {
+			Key ^= Key >> 30;
+			Key *= 0xbf58476d1ce4e5b9ULL;
+			Key ^= Key >> 27;
+			Key *= 0x94d049bb133111ebULL;
+			Key ^= Key >> 31;
+			return Key;
+		}
+
+		[[nodiscard]] inline Shard &ShardOf(std::uint64_t Key) const {
+			return Shards_[Hash(Key) & Mask_];
+		}
+
+		[[nodiscard]] inline ConnectionPtr Find(std::uint64_t Key) const {
+			auto &S = ShardOf(Key);
+			std::shared_lock Lock(S.Mutex);
+			auto Hint = S.Entries.find(Key);
+			return Hint == S.Entries.end() ? nullptr : Hint->second;
+		}
+
+		inline bool Insert(std::uint64_t Key, ConnectionPtr Connection) {
+			auto &S = ShardOf(Key);
+			std::unique_lock Lock(S.Mutex);
+			if (!S.Entries.try_emplace(Key, std::move(Connection)).second)
+				return false;
+			++Count_;
+			return true;
+		}
+
+		inline void Assign(std::uint64_t Key, ConnectionPtr Connection) {
+			auto &S = ShardOf(Key);
+			std::unique_lock Lock(S.Mutex);
+			if (S.Entries.insert_or_assign(Key, std::move(Connection)).second)
+				++Count_;
+		}
+
+		inline ConnectionPtr Take(std::uint64_t Key) {
+			auto &S = ShardOf(Key);
+			std::unique_lock Lock(S.Mutex);
+			auto Hint = S.Entries.find(Key);
+			if (Hint == S.Entries.end())
+				return nullptr;
+			auto Connection = std::move(Hint->second);
+			S.Entries.erase(Hint);
+			--Count_;
+			return Connection;
+		}
+
+		inline void Erase(std::uint64_t Key) {
+			auto &S = ShardOf(Key);
+			std::unique_lock Lock(S.Mutex);
+			Count_ -= S.Entries.erase(Key);
+		}
+
+		//	Erases the entry only if Pred(Connection) holds, under the shard lock.
+		template <typename Pred> inline bool EraseIf(std::uint64_t Key, Pred &&P) {
+			auto &S = ShardOf(Key);
+			std::unique_lock Lock(S.Mutex);
+			auto Hint = S.Entries.find(Key);
+			if (Hint == S.Entries.end() || Hint->second == nullptr || !P(Hint->second))
+				return false;
+			S.Entries.erase(Hint);
+			--Count_;
+			return true;
+		}
+
+		//	Visits every connection, one shard at a time under its shared lock. Fn must not call
+		//	back into the table.
+		template <typename Func> inline void ForEach(Func &&Fn) const {
+			for (std::uint64_t i = 0; i <= Mask_; ++i) {
+				std::shared_lock Lock(Shards_[i].Mutex);
+				for (const auto &[Key, Connection] : Shards_[i].Entries) {
+					if (Connection != nullptr)
+						Fn(Connection);
+				}
+			}
+		}
+
+		//	Number of connections and size of the fullest shard.
+		inline void Occupancy(std::uint64_t &Entries, std::uint64_t &Largest) const {
+			Entries = Largest = 0;
+			for (std::uint64_t i = 0; i <= Mask_; ++i) {
+				std::shared_lock Lock(Shards_[i].Mutex);
+				Entries += Shards_[i].Entries.size();
+				Largest = std::max<std::uint64_t>(Largest, Shards_[i].Entries.size());
+			}
+		}
+
+	  private:
+		static constexpr std::uint64_t MaxShards = 1 << 16;
+		std::unique_ptr<Shard[]> 	Shards_ = std::make_unique<Shard[]>(1);
+		std::uint64_t 				Mask_ = 0;
+		std::atomic_uint64_t 		Count_ = 0;
+	};
+
+} // namespace OpenWifi
@@ -14,7 +14,7 @@ namespace OpenWifi {
 		uint64_t GoodConfig = GetCurrentConfigurationID(SerialNumberInt_);
 		if (GoodConfig && (GoodConfig == UUID || GoodConfig == State_.PendingUUID)) {
 			UpgradedUUID = UUID;
-			State_.PendingUUID = 0;
+			SetPendingUUID(0);
 			return false;
 		}
 
@@ -27,7 +27,7 @@ namespace OpenWifi {
 			//	so we sent an upgrade to a device, and now it is completing now...
 			UpgradedUUID = UUID;
 			StorageService()->CompleteDeviceConfigurationChange(Session, SerialNumber_);
-			State_.PendingUUID = 0;
+			SetPendingUUID(0);
 			return true;
 		}
 
@@ -46,7 +46,8 @@ namespace OpenWifi {
 
 		if (D.UUID == UUID) {
 			D.UUID = UpgradedUUID = UUID;
-			State_.PendingUUID = D.pendingUUID = 0;
+			D.pendingUUID = 0;
+			SetPendingUUID(0);
 			D.pendingConfiguration.clear();
 			D.pendingConfigurationCmd.clear();
 			StorageService()->UpdateDevice(Session, D);
@@ -65,7 +66,8 @@ namespace OpenWifi {
 
 		Cfg.SetUUID(D.UUID);
 		D.Configuration = Cfg.get();
-		D.pendingUUID = State_.PendingUUID = UpgradedUUID = D.UUID;
+		D.pendingUUID = UpgradedUUID = D.UUID;
+		SetPendingUUID(D.UUID);
 		StorageService()->UpdateDevice(Session, D);
 
 		GWObjects::CommandDetails Cmd;
@@ -10,6 +10,7 @@
 #include "StorageService.h"
 
 #include "CommandManager.h"
+#include "ConnectStage.h"
 
 #include "framework/KafkaManager.h"
 #include "framework/utils.h"
@@ -53,6 +54,21 @@ namespace OpenWifi {
 		}
 	}
 
+	struct AP_WS_Connection::ConnectContext {
+		Poco::JSON::Object::Ptr ParamsObj;
+		std::string SerialNumber;
+		std::uint64_t SerialNumberInt = 0;
+		std::string CId;
+		std::string Compatible;
+		std::uint64_t UUID = 0;
+		std::string Firmware;
+		std::string DevicePassword;
+		std::string Platform;
+		Config::Capabilities Caps;
+		bool RestrictedDevice = false;
+		bool LocaleResolved = false;
+	};
+
 	void AP_WS_Connection::Process_connect(Poco::JSON::Object::Ptr ParamsObj,
 										   const std::string &Serial) {
 		if (ParamsObj->has(uCentralProtocol::UUID) && ParamsObj->has(uCentralProtocol::FIRMWARE) &&
@@ -77,204 +93,105 @@ namespace OpenWifi {
 
 			Compatible_ = Caps.Compatible();
 
-			State_.UUID = UUID;
-			State_.Firmware = Firmware;
-			State_.PendingUUID = 0;
-			State_.Address = Utils::FormatIPv6(WS_->peerAddress().toString());
+			{
+				std::unique_lock Lock(StateMutex_);
+				State_.UUID = UUID;
+				State_.Firmware = Firmware;
+				State_.PendingUUID = 0;
+				State_.Address = Utils::FormatIPv6(WS_->peerAddress().toString());
+				if(ParamsObj->has("reason")) {
+					State_.connectReason = ParamsObj->get("reason").toString();
+				}
+			}
 			CId_ = SerialNumber_ + "@" + CId_;
 
 			auto Platform = Poco::toLower(Caps.Platform());
 
-			if(ParamsObj->has("reason")) {
-				State_.connectReason = ParamsObj->get("reason").toString();
-			}
-
 			auto IP = PeerAddress_.toString();
 			if (IP.substr(0, 7) == "::ffff:") {
 				IP = IP.substr(7);
 			}
 
 			bool RestrictedDevice = false;
+			auto Restrictions = Restrictions_;
 			if (Capabilities->has("restrictions")) {
 				RestrictedDevice = true;
 				Poco::JSON::Object::Ptr RestrictionObject = Capabilities->getObject("restrictions");
-				Restrictions_.from_json(RestrictionObject);
+				Restrictions.from_json(RestrictionObject);
 			}
 
 			if (Capabilities->has("developer") && !Capabilities->isNull("developer")) {
-				Restrictions_.developer = Capabilities->getValue<bool>("developer");
+				Restrictions.developer = Capabilities->getValue<bool>("developer");
+			}
+			{
+				std::unique_lock Lock(StateMutex_);
+				Restrictions_ = Restrictions;
 			}
 
 			if(Capabilities->has("secure-rtty")) {
 				RTTYMustBeSecure_ = Capabilities->getValue<bool>("secure-rtty");
 			}
 
-			State_.locale = FindCountryFromIP()->Get(IP);
-			GWObjects::Device DeviceInfo;
-			std::lock_guard DbSessionLock(DbSession_->Mutex());
-
-			auto DeviceExists = StorageService()->GetDevice(DbSession_->Session(), SerialNumber_, DeviceInfo);
-			if (Daemon()->AutoProvisioning() && !DeviceExists) {
-				//	check the firmware version. if this is too old, we cannot let that device connect yet, we must
-				//	force a firmware upgrade
-				GWObjects::DefaultFirmware	MinimumFirmware;
-				if(FirmwareRevisionCache()->DeviceMustUpgrade(Compatible_, Firmware, MinimumFirmware)) {
-					Poco::JSON::Object	UpgradeCommand, Params;
-					UpgradeCommand.set(uCentralProtocol::JSONRPC,uCentralProtocol::JSONRPC_VERSION);
-					UpgradeCommand.set(uCentralProtocol::METHOD,uCentralProtocol::UPGRADE);
-					Params.set(uCentralProtocol::SERIALNUMBER, SerialNumber_);
-					Params.set(uCentralProtocol::WHEN, 0);
-					Params.set(uCentralProtocol::URI, MinimumFirmware.uri);
-					Params.set(uCentralProtocol::KEEP_REDIRECTOR,1);
-					UpgradeCommand.set(uCentralProtocol::PARAMS, Params);
-					UpgradeCommand.set(uCentralProtocol::ID, 1);
-
-					std::ostringstream Command;
-					UpgradeCommand.stringify(Command);
-					if(Send(Command.str())) {
-						poco_information(
-							Logger(),
-							fmt::format(
-								"Forcing device {} to upgrade to {} before connection is allowed.",
-								SerialNumber_, MinimumFirmware.revision));
-					} else {
-						poco_error(
-							Logger(),
-							fmt::format(
-								"Could not force device {} to upgrade to {} before connection is allowed.",
-								SerialNumber_, MinimumFirmware.revision));
-					}
-					return;
-				} else {
-					StorageService()->CreateDefaultDevice( DbSession_->Session(),
-						SerialNumber_, Caps, Firmware, PeerAddress_,
-						State_.VerifiedCertificate == GWObjects::SIMULATED);
-				}
-			} else if (!Daemon()->AutoProvisioning() && !DeviceExists) {
-				SendKafkaDeviceNotProvisioned(SerialNumber_, Firmware, Compatible_, CId_);
-				poco_warning(Logger(),fmt::format("Device {} is a {} from {} and cannot be provisioned.",SerialNumber_,Compatible_, CId_));
-				return EndConnection();
-			} else if (DeviceExists) {
-				StorageService()->UpdateDeviceCapabilities(DbSession_->Session(), SerialNumber_, Caps);
-				int Updated{0};
-				if (!Firmware.empty()) {
-					if (Firmware != DeviceInfo.Firmware) {
-						DeviceFirmwareChangeKafkaEvent KEvent(SerialNumberInt_, Utils::Now(),
-															  DeviceInfo.Firmware, Firmware);
-						DeviceInfo.Firmware = Firmware;
-						DeviceInfo.LastFWUpdate = Utils::Now();
-						++Updated;
-
-						GWWebSocketNotifications::SingleDeviceFirmwareChange_t Notification;
-						Notification.content.serialNumber = SerialNumber_;
-						Notification.content.newFirmware = Firmware;
-						GWWebSocketNotifications::DeviceFirmwareUpdated(Notification);
-					} else if (DeviceInfo.LastFWUpdate == 0) {
-						DeviceInfo.LastFWUpdate = Utils::Now();
-						++Updated;
-					}
-				}
-
-				if(ParamsObj->has("reason")) {
-					State_.connectReason = ParamsObj->get("reason").toString();
-					DeviceInfo.connectReason = State_.connectReason;
-					++Updated;
-				}
-
-				if(DeviceInfo.DevicePassword!=DevicePassword) {
-					DeviceInfo.DevicePassword = DevicePassword.empty() ? "openwifi" : DevicePassword ;
-					++Updated;
-				}
-
-				if (DeviceInfo.lastRecordedContact==0) {
-					DeviceInfo.lastRecordedContact = Utils::Now();
-					++Updated;
-				}
-
-				if (DeviceInfo.simulated && (State_.VerifiedCertificate!=GWObjects::SIMULATED)) {
-					DeviceInfo.simulated = false;
-					++Updated;
-				}
-
-				if (!DeviceInfo.simulated && (State_.VerifiedCertificate==GWObjects::SIMULATED)) {
-					DeviceInfo.simulated = true;
-					++Updated;
-				}
-
-				if (DeviceInfo.locale != State_.locale) {
-					DeviceInfo.locale = State_.locale;
-					++Updated;
-				}
-
-				if (Compatible_ != DeviceInfo.Compatible) {
-					DeviceInfo.Compatible = Compatible_;
-					++Updated;
-				}
-
-				if (Platform != DeviceInfo.DeviceType) {
-					DeviceInfo.DeviceType = Platform;
-					++Updated;
-				}
-
-				if (RestrictedDevice != DeviceInfo.restrictedDevice) {
-					DeviceInfo.restrictedDevice = RestrictedDevice;
-					++Updated;
-				}
-
-				if (Restrictions_ != DeviceInfo.restrictionDetails) {
-					DeviceInfo.restrictionDetails = Restrictions_;
-					++Updated;
-				}
-
-				if(DeviceInfo.certificateExpiryDate!=State_.certificateExpiryDate) {
-					DeviceInfo.certificateExpiryDate = State_.certificateExpiryDate;
-					++Updated;
-				}
+			//	Never wait on the IP to country provider here: on a cache miss we go on with the
+			//	default (or stored) locale and the worker fixes the state and the DB when it answers.
+			auto DeviceLocale = State_.locale;
+			auto LocaleResolved = FindCountryFromIP()->Get(
+				IP, DeviceLocale,
+				[SerialNumber = SerialNumber_, SerialNumberInt = SerialNumberInt_](const std::string &Country) mutable {
+					std::string Locale{Country};
+					AP_WS_Server()->SetLocale(SerialNumberInt, Locale);
+					StorageService()->SetDeviceLocale(SerialNumber, Locale);
+				});
+			{
+				std::unique_lock Lock(StateMutex_);
+				State_.locale = DeviceLocale;
+			}
 
-				if (Updated) {
-					StorageService()->UpdateDevice(DbSession_->Session(), DeviceInfo);
-				}
+			//	The session is accepted here, on the reactor, so the frames the device sends right
+			//	after its connect message are processed normally. Only the database work and the
+			//	Kafka and UI side effects go to the connect stage. The device is not counted as
+			//	connected, and nothing announces it, until the stage has checked its provisioning: a
+			//	device turned away there only ever had its session marked connected.
+			ConnectionCompletionTime_ =
+				std::chrono::high_resolution_clock::now() - ConnectionStart_;
+			auto ValidCertificate = State_.VerifiedCertificate == GWObjects::VALID_CERTIFICATE;
+			auto SerialMatch = ValidCertificate &&
+							   ((Utils::SerialNumberMatch(CN_, SerialNumber_,
+														  (int)AP_WS_Server()->MismatchDepth())) ||
+								AP_WS_Server()->IsSimSerialNumber(CN_));
+			if (ValidCertificate && !SerialMatch && !AP_WS_Server()->AllowSerialNumberMismatch()) {
+				poco_information(
+					Logger_, fmt::format("CONNECT({}): Serial number mismatch disallowed. "
+										 "Device rejected. CN={} Serial={} Session={}",
+										 CId_, CN_, SerialNumber_, State_.sessionId));
+				return EndConnection();
 			}
 
-			if(!Simulated_) {
-				uint64_t UpgradedUUID = 0;
-				if (LookForUpgrade(DbSession_->Session(), UUID, UpgradedUUID)) {
-					State_.UUID = UpgradedUUID;
+			{
+				std::unique_lock Lock(StateMutex_);
+				State_.Compatible = Compatible_;
+				State_.Connected = true;
+				State_.connectionCompletionTime = ConnectionCompletionTime_.count();
+				if (ValidCertificate) {
+					State_.VerifiedCertificate =
+						SerialMatch ? GWObjects::VERIFIED : GWObjects::MISMATCH_SERIAL;
 				}
 			}
 
-			State_.Compatible = Compatible_;
-			State_.Connected = true;
-			ConnectionCompletionTime_ =
-				std::chrono::high_resolution_clock::now() - ConnectionStart_;
-			State_.connectionCompletionTime = ConnectionCompletionTime_.count();
-
-			if (State_.VerifiedCertificate == GWObjects::VALID_CERTIFICATE) {
-				if ((Utils::SerialNumberMatch(CN_, SerialNumber_,
-											  (int)AP_WS_Server()->MismatchDepth())) ||
-					AP_WS_Server()->IsSimSerialNumber(CN_)) {
-					State_.VerifiedCertificate = GWObjects::VERIFIED;
+			if (ValidCertificate) {
+				if (SerialMatch) {
 					poco_information(Logger_,
 									 fmt::format("CONNECT({}): Fully validated and authenticated "
 												 "device. Session={} ConnectionCompletion Time={}",
 												 CId_, State_.sessionId,
 												 State_.connectionCompletionTime));
 				} else {
-					State_.VerifiedCertificate = GWObjects::MISMATCH_SERIAL;
-					if (AP_WS_Server()->AllowSerialNumberMismatch()) {
-						poco_information(
-							Logger_,
-							fmt::format("CONNECT({}): Serial number mismatch allowed. CN={} "
-										"Serial={} Session={} ConnectionCompletion Time={}",
-										CId_, CN_, SerialNumber_, State_.sessionId,
-										State_.connectionCompletionTime));
-					} else {
-						poco_information(
-							Logger_, fmt::format("CONNECT({}): Serial number mismatch disallowed. "
-												 "Device rejected. CN={} Serial={} Session={}",
-												 CId_, CN_, SerialNumber_, State_.sessionId));
-						return EndConnection();
-					}
+					poco_information(
+						Logger_,
+						fmt::format("CONNECT({}): Serial number mismatch allowed. CN={} "
+									"Serial={} Session={} ConnectionCompletion Time={}",
+									CId_, CN_, SerialNumber_, State_.sessionId,
+									State_.connectionCompletionTime));
 				}
 			} else {
 				poco_information(Logger_,
@@ -284,16 +201,32 @@ namespace OpenWifi {
 											 State_.connectionCompletionTime));
 			}
 
-			GWWebSocketNotifications::SingleDevice_t Notification;
-			Notification.content.serialNumber = SerialNumber_;
-			GWWebSocketNotifications::DeviceConnected(Notification);
-
-			if (KafkaManager()->Enabled()) {
-				ParamsObj->set(uCentralProtocol::CONNECTIONIP, CId_);
-				ParamsObj->set("locale", State_.locale);
-				ParamsObj->set(uCentralProtocol::TIMESTAMP, Utils::Now());
-				ParamsObj->set(uCentralProtocol::UUID, uuid_);
-				KafkaManager()->PostMessage(KafkaTopics::CONNECTION, SerialNumber_, *ParamsObj);
+			auto Context = std::make_shared<const ConnectContext>(ConnectContext{
+				.ParamsObj = ParamsObj,
+				.SerialNumber = SerialNumber_,
+				.SerialNumberInt = SerialNumberInt_,
+				.CId = CId_,
+				.Compatible = Compatible_,
+				.UUID = UUID,
+				.Firmware = Firmware,
+				.DevicePassword = DevicePassword,
+				.Platform = Platform,
+				.Caps = Caps,
+				.RestrictedDevice = RestrictedDevice,
+				.LocaleResolved = LocaleResolved});
+			auto Self = shared_from_this();
+			if (!ConnectStage()->Submit(SerialNumberInt_,
+										[Self, Context](Poco::Data::Session &Session) {
+											Self->CompleteConnect(Session, *Context);
+										})) {
+				//	The stage is full (or stopping). Doing the database work here would stall this
+				//	reactor in the middle of a connection storm, so the device is closed and will
+				//	connect again after its back-off.
+				poco_warning(Logger_,
+							 fmt::format("CONNECT({}): Connect stage is full. Device asked to retry. "
+										 "Session={}",
+										 CId_, State_.sessionId));
+				return EndConnection();
 			}
 		} else {
 			poco_warning(
@@ -304,4 +237,197 @@ namespace OpenWifi {
 		}
 	}
 
-} // namespace OpenWifi
\ No newline at end of file
+	//	Runs on a connect stage worker. The session has already been accepted: this does the
+	//	database work without the connection lock, and only takes it to apply the results.
+	void AP_WS_Connection::CompleteConnect(Poco::Data::Session &Session,
+										   const ConnectContext &Ctx) {
+		if (Dead_)
+			return;
+
+		GWObjects::ConnectionState State;
+		GWObjects::DeviceRestrictions Restrictions;
+		{
+			std::shared_lock G(StateMutex_);
+			State = State_;
+			Restrictions = Restrictions_;
+		}
+
+		GWObjects::Device DeviceInfo;
+		auto DeviceExists = StorageService()->GetDevice(Session, Ctx.SerialNumber, DeviceInfo);
+		if (Daemon()->AutoProvisioning() && !DeviceExists) {
+			//	check the firmware version. if this is too old, we cannot let that device connect yet, we must
+			//	force a firmware upgrade
+			GWObjects::DefaultFirmware	MinimumFirmware;
+			if(FirmwareRevisionCache()->DeviceMustUpgrade(Ctx.Compatible, Ctx.Firmware, MinimumFirmware)) {
+				Poco::JSON::Object	UpgradeCommand, Params;
+				UpgradeCommand.set(uCentralProtocol::JSONRPC,uCentralProtocol::JSONRPC_VERSION);
+				UpgradeCommand.set(uCentralProtocol::METHOD,uCentralProtocol::UPGRADE);
+				Params.set(uCentralProtocol::SERIALNUMBER, Ctx.SerialNumber);
+				Params.set(uCentralProtocol::WHEN, 0);
+				Params.set(uCentralProtocol::URI, MinimumFirmware.uri);
+				Params.set(uCentralProtocol::KEEP_REDIRECTOR,1);
+				UpgradeCommand.set(uCentralProtocol::PARAMS, Params);
+				UpgradeCommand.set(uCentralProtocol::ID, 1);
+
+				//	The device is not allowed in until it runs the minimum firmware: take back the
+				//	session accepted by the reactor.
+				{
+					std::lock_guard G(ConnectionMutex_);
+					std::unique_lock Lock(StateMutex_);
+					State_.Connected = false;
+				}
+
+				std::ostringstream Command;
+				UpgradeCommand.stringify(Command);
+				if(Send(Command.str())) {
+					poco_information(
+						Logger(),
+						fmt::format(
+							"Forcing device {} to upgrade to {} before connection is allowed.",
+							Ctx.SerialNumber, MinimumFirmware.revision));
+				} else {
+					poco_error(
+						Logger(),
+						fmt::format(
+							"Could not force device {} to upgrade to {} before connection is allowed.",
+							Ctx.SerialNumber, MinimumFirmware.revision));
+				}
+				return;
+			} else {
+				StorageService()->CreateDefaultDevice( Session,
+					Ctx.SerialNumber, Ctx.Caps, Ctx.Firmware, PeerAddress_,
+					State.VerifiedCertificate == GWObjects::SIMULATED);
+			}
+		} else if (!Daemon()->AutoProvisioning() && !DeviceExists) {
+			SendKafkaDeviceNotProvisioned(Ctx.SerialNumber, Ctx.Firmware, Ctx.Compatible, Ctx.CId);
+			poco_warning(Logger(),fmt::format("Device {} is a {} from {} and cannot be provisioned.",Ctx.SerialNumber,Ctx.Compatible, Ctx.CId));
+			std::lock_guard G(ConnectionMutex_);
+			return EndConnection();
+		} else if (DeviceExists) {
+			StorageService()->UpdateDeviceCapabilities(Session, Ctx.SerialNumber, Ctx.Caps);
+			int Updated{0};
+			if (!Ctx.Firmware.empty()) {
+				if (Ctx.Firmware != DeviceInfo.Firmware) {
+					DeviceFirmwareChangeKafkaEvent KEvent(Ctx.SerialNumberInt, Utils::Now(),
+														  DeviceInfo.Firmware, Ctx.Firmware);
+					DeviceInfo.Firmware = Ctx.Firmware;
+					DeviceInfo.LastFWUpdate = Utils::Now();
+					++Updated;
+
+					GWWebSocketNotifications::SingleDeviceFirmwareChange_t Notification;
+					Notification.content.serialNumber = Ctx.SerialNumber;
+					Notification.content.newFirmware = Ctx.Firmware;
+					GWWebSocketNotifications::DeviceFirmwareUpdated(Notification);
+				} else if (DeviceInfo.LastFWUpdate == 0) {
+					DeviceInfo.LastFWUpdate = Utils::Now();
+					++Updated;
+				}
+			}
+
+			if(Ctx.ParamsObj->has("reason")) {
+				DeviceInfo.connectReason = State.connectReason;
+				++Updated;
+			}
+
+			if(DeviceInfo.DevicePassword!=Ctx.DevicePassword) {
+				DeviceInfo.DevicePassword = Ctx.DevicePassword.empty() ? "openwifi" : Ctx.DevicePassword ;
+				++Updated;
+			}
+
+			if (DeviceInfo.lastRecordedContact==0) {
+				DeviceInfo.lastRecordedContact = Utils::Now();
+				++Updated;
+			}
+
+			if (DeviceInfo.simulated && (State.VerifiedCertificate!=GWObjects::SIMULATED)) {
+				DeviceInfo.simulated = false;
+				++Updated;
+			}
+
+			if (!DeviceInfo.simulated && (State.VerifiedCertificate==GWObjects::SIMULATED)) {
+				DeviceInfo.simulated = true;
+				++Updated;
+			}
+
+			//	The IP to country worker may have answered since State was taken: use what it found
+			//	rather than writing the stored locale back over it.
+			std::string FoundLocale;
+			{
+				std::shared_lock G(StateMutex_);
+				if (Ctx.LocaleResolved || LocaleLookedUp_)
+					FoundLocale = State_.locale;
+			}
+			if (!FoundLocale.empty() && DeviceInfo.locale != FoundLocale) {
+				DeviceInfo.locale = FoundLocale;
+				++Updated;
+			}
+
+			if (Ctx.Compatible != DeviceInfo.Compatible) {
+				DeviceInfo.Compatible = Ctx.Compatible;
+				++Updated;
+			}
+
+			if (Ctx.Platform != DeviceInfo.DeviceType) {
+				DeviceInfo.DeviceType = Ctx.Platform;
+				++Updated;
+			}
+
+			if (Ctx.RestrictedDevice != DeviceInfo.restrictedDevice) {
+				DeviceInfo.restrictedDevice = Ctx.RestrictedDevice;
+				++Updated;
+			}
+
+			if (Restrictions != DeviceInfo.restrictionDetails) {
+				DeviceInfo.restrictionDetails = Restrictions;
+				++Updated;
+			}
+
+			if(DeviceInfo.certificateExpiryDate!=State.certificateExpiryDate) {
+				DeviceInfo.certificateExpiryDate = State.certificateExpiryDate;
+				++Updated;
+			}
+
+			if (Updated) {
+				StorageService()->UpdateDevice(Session, DeviceInfo);
+			}
+		}
+
+		std::string Locale;
+		{
+			std::lock_guard G(ConnectionMutex_);
+			if (Dead_)
+				return;
+
+			uint64_t UpgradedUUID = 0;
+			auto Upgraded = !Simulated_ && LookForUpgrade(Session, Ctx.UUID, UpgradedUUID);
+
+			if (!CountedConnected_.exchange(true)) {
+				AP_WS_Server()->DeviceConnected(State.started);
+			}
+
+			std::unique_lock Lock(StateMutex_);
+			if (DeviceExists && !Ctx.LocaleResolved && !LocaleLookedUp_ &&
+				!DeviceInfo.locale.empty()) {
+				State_.locale = DeviceInfo.locale;
+			}
+			if (Upgraded) {
+				State_.UUID = UpgradedUUID;
+			}
+			Locale = State_.locale;
+		}
+
+		GWWebSocketNotifications::SingleDevice_t Notification;
+		Notification.content.serialNumber = Ctx.SerialNumber;
+		GWWebSocketNotifications::DeviceConnected(Notification);
+		CommandManager()->DeviceReady(Ctx.SerialNumberInt);
+
+		if (KafkaManager()->Enabled()) {
+			Ctx.ParamsObj->set(uCentralProtocol::CONNECTIONIP, Ctx.CId);
+			Ctx.ParamsObj->set("locale", Locale);
+			Ctx.ParamsObj->set(uCentralProtocol::TIMESTAMP, Utils::Now());
+			Ctx.ParamsObj->set(uCentralProtocol::UUID, uuid_);
+			KafkaManager()->PostMessage(KafkaTopics::CONNECTION, Ctx.SerialNumber, *Ctx.ParamsObj);
+		}
+	}
+
+} // namespace OpenWifi
@@ -4,6 +4,7 @@
 
 #include "AP_WS_Connection.h"
 #include "AP_WS_Server.h"
+#include "StatsWriter.h"
 #include "StorageService.h"
 
 #include "fmt/format.h"
@@ -26,7 +27,6 @@ namespace OpenWifi {
 
 			uint64_t UUID = ParamsObj->get(uCentralProtocol::UUID);
 			auto Sanity = ParamsObj->get(uCentralProtocol::SANITY);
-			State_.sanity = Sanity;
 			auto CheckData = ParamsObj->get(uCentralProtocol::DATA).toString();
 			if (CheckData.empty())
 				CheckData = uCentralProtocol::EMPTY_JSON_DOC;
@@ -50,7 +50,7 @@ namespace OpenWifi {
 			Check.Data = CheckData;
 			Check.Sanity = Sanity;
 
-			StorageService()->AddHealthCheckData(*DbSession_, Check);
+			StatsWriter()->AddHealthCheck(Check);
 
 			if (!request_uuid.empty()) {
 				StorageService()->SetCommandResult(request_uuid, CheckData);
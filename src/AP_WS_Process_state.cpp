@@ -5,6 +5,7 @@
 #include "AP_WS_Connection.h"
 #include "AP_WS_Server.h"
 #include "StateUtils.h"
+#include "StatsWriter.h"
 #include "StorageService.h"
 
 #include "UI_GW_WebSocketNotifications.h"
@@ -40,28 +41,40 @@ namespace OpenWifi {
 												UUID, request_uuid));
 			}
 
-			std::lock_guard	Guard(DbSession_->Mutex());
 			if(!Simulated_) {
+				std::lock_guard	Guard(DbSession_->Mutex());
 				uint64_t UpgradedUUID;
 				LookForUpgrade(DbSession_->Session(), UUID, UpgradedUUID);
+				std::unique_lock Lock(StateMutex_);
 				State_.UUID = UpgradedUUID;
 			}
 
-			SetLastStats(StateStr);
+			SetLastStats(StateObj, StateStr);
 
 			GWObjects::Statistics Stats{
 				.SerialNumber = SerialNumber_, .UUID = UUID, .Data = StateStr};
 			Stats.Recorded = Utils::Now();
-			StorageService()->AddStatisticsData(DbSession_->Session(),Stats);
+			StatsWriter()->AddStatistics(Stats);
 			if (!request_uuid.empty()) {
 				StorageService()->SetCommandResult(request_uuid, StateStr);
 			}
 
-			StateUtils::ComputeAssociations(StateObj, State_.Associations_2G,
-											State_.Associations_5G, State_.Associations_6G, State_.uptime);
+			auto Associations_2G = State_.Associations_2G, Associations_5G = State_.Associations_5G,
+				 Associations_6G = State_.Associations_6G, UpTime = State_.uptime;
+			StateUtils::ComputeAssociations(StateObj, Associations_2G, Associations_5G,
+											Associations_6G, UpTime);
+			{
+				std::unique_lock Lock(StateMutex_);
+				State_.Associations_2G = Associations_2G;
+				State_.Associations_5G = Associations_5G;
+				State_.Associations_6G = Associations_6G;
+				State_.uptime = UpTime;
+			}
 
 			if (KafkaManager()->Enabled() && !AP_WS_Server()->KafkaDisableState()) {
-				KafkaManager()->PostMessage(KafkaTopics::STATE, SerialNumber_, *ParamsObj);
+				KafkaManager()->PostMessage(
+					KafkaTopics::STATE, SerialNumber_,
+					StateUtils::StringifyWithRawMember(ParamsObj, uCentralProtocol::STATE, StateStr));
 			}
 
 			GWWebSocketNotifications::SingleDevice_t N;
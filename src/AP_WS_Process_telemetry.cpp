@@ -37,7 +37,6 @@ namespace OpenWifi {
 					if (now < TelemetryWebSocketTimer_) {
 
 						TelemetryWebSocketPackets_++;
-						State_.websocketPackets = TelemetryWebSocketPackets_;
 						TelemetryStream()->NotifyEndPoint(SerialNumberInt_, KafkaPayload);
 					} else {
 						StopWebSocketTelemetry(CommandManager()->Next_RPC_ID());
@@ -46,7 +45,6 @@ namespace OpenWifi {
 				if (TelemetryKafkaRefCount_) {
 					if (KafkaManager()->Enabled() && now < TelemetryKafkaTimer_) {
 						TelemetryKafkaPackets_++;
-						State_.kafkaPackets = TelemetryKafkaPackets_;
 						KafkaManager()->PostMessage(KafkaTopics::DEVICE_TELEMETRY, SerialNumber_,
 													KafkaPayload);
 					} else {
@@ -4,12 +4,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <framework/utils.h>
 
+#include <Poco/Buffer.h>
 #include <Poco/Environment.h>
+#include <Poco/JSON/Parser.h>
 #include <Poco/Net/SocketAcceptor.h>
 #include <Poco/Data/SessionPool.h>
 
@@ -17,6 +24,91 @@
 
 namespace OpenWifi {
 
+	//	Live figures for one device reactor. Connections update the counters, the pool turns them
+	//	into rates when it picks a reactor for a new connection.
+	struct AP_WS_ReactorLoad {
+		std::atomic_uint64_t Connections = 0;
+		std::atomic_uint64_t Messages = 0;
+		std::atomic_uint64_t Bytes = 0;
+
+		//	protected by the pool mutex
+		double MessageRate = 0.0; //	messages per second
+		double ByteRate = 0.0;	  //	bytes per second
+		std::uint64_t LastMessages = 0;
+		std::uint64_t LastBytes = 0;
+	};
+
+	//	Receive state shared by all the connections of one reactor: frames are read into the same
+	//	buffer and parsed by the same parser, so a frame does not cost any allocation once the
+	//	buffer has grown to the usual frame size. Only the reactor thread may use it.
+	//	A buffer grown by a large frame (configuration, state with many clients) is given back
+	//	once ShrinkAfter frames in a row fit in a quarter of it.
+	class AP_WS_ReceiveBuffer {
+	  public:
+		static constexpr std::size_t DefaultSize = 16 * 1024;
+		static constexpr std::size_t ShrinkAfter = 256;
+
+		AP_WS_ReceiveBuffer() { ParseText_.reserve(DefaultSize); }
+
+		//	Empty buffer for the next frame. receiveFrame() appends to it.
+		inline Poco::Buffer<char> &Frame() {
+			Recycle();
+			Frame_.resize(0);
+			return Frame_;
+		}
+
+		//	Parses the frame just received. The parser takes a std::string, so the frame is copied
+		//	once into a string that keeps its storage between frames.
+		inline Poco::Dynamic::Var Parse() {
+			ParseText_.assign(Frame_.begin(), Frame_.size());
+			Parser_.reset();
+			return Parser_.parse(ParseText_);
+		}
+
+		[[nodiscard]] inline std::string_view Text() const {
+			return {Frame_.begin(), Frame_.size()};
+		}
+
+		[[nodiscard]] inline std::uint64_t Capacity() const { return Capacity_; }
+
+	  private:
+		Poco::Buffer<char> 		Frame_{DefaultSize};
+		std::string 			ParseText_;
+		Poco::JSON::Parser 		Parser_;
+		std::uint64_t 			SmallFrames_ = 0;
+		std::atomic_uint64_t 	Capacity_ = 2 * DefaultSize;
+
+		//	Looks at the size of the previous frame before the buffer is reused.
+		inline void Recycle() {
+			if (Frame_.capacity() <= DefaultSize || (Frame_.size() * 4) > Frame_.capacity()) {
+				SmallFrames_ = 0;
+			} else if (++SmallFrames_ >= ShrinkAfter) {
+				SmallFrames_ = 0;
+				Frame_.setCapacity(DefaultSize, false);
+				std::string().swap(ParseText_);
+				ParseText_.reserve(DefaultSize);
+			}
+			Capacity_ = Frame_.capacity() + ParseText_.capacity();
+		}
+	};
+
+	struct AP_WS_ReactorAssignment {
+		std::shared_ptr<Poco::Net::SocketReactor> Reactor;
+		std::shared_ptr<LockedDbSession> DbSession;
+		std::shared_ptr<AP_WS_ReactorLoad> Load;
+		std::shared_ptr<AP_WS_ReceiveBuffer> Receive;
+	};
+
+	struct AP_WS_ReactorStats {
+		std::uint64_t Id = 0;
+		std::uint64_t Connections = 0;
+		std::uint64_t Messages = 0;
+		std::uint64_t Bytes = 0;
+		double MessageRate = 0.0;
+		double ByteRate = 0.0;
+		std::uint64_t ReceiveBuffer = 0;
+	};
+
 	class AP_WS_ReactorThreadPool {
 	  public:
 		explicit AP_WS_ReactorThreadPool(Poco::Logger &Logger) : Logger_(Logger) {
@@ -32,6 +124,8 @@ namespace OpenWifi {
 			Reactors_.reserve(NumberOfThreads_);
 			DbSessions_.reserve(NumberOfThreads_);
 			Threads_.reserve(NumberOfThreads_);
+			Loads_.reserve(NumberOfThreads_);
+			ReceiveBuffers_.reserve(NumberOfThreads_);
 			Logger_.information(fmt::format("WebSocket Processor: starting {} threads.", NumberOfThreads_));
 			for (uint64_t i = 0; i < NumberOfThreads_; ++i) {
 				auto NewReactor = std::make_shared<Poco::Net::SocketReactor>();
@@ -42,7 +136,10 @@ namespace OpenWifi {
 				Reactors_.emplace_back(std::move(NewReactor));
 				Threads_.emplace_back(std::move(NewThread));
 				DbSessions_.emplace_back(std::make_shared<LockedDbSession>());
+				Loads_.emplace_back(std::make_shared<AP_WS_ReactorLoad>());
+				ReceiveBuffers_.emplace_back(std::make_shared<AP_WS_ReceiveBuffer>());
 			}
+			LastSample_ = std::chrono::steady_clock::now();
 			Logger_.information(fmt::format("WebSocket Processor: {} threads started.", NumberOfThreads_));
 		}
 
@@ -55,13 +152,54 @@ namespace OpenWifi {
 			Reactors_.clear();
 			Threads_.clear();
 			DbSessions_.clear();
+			Loads_.clear();
+			ReceiveBuffers_.clear();
 		}
 
-		auto NextReactor() {
+		//	Picks the least loaded reactor. A reactor's load is its live connection count plus its
+		//	message rate expressed in connections, using the pool-wide messages per connection.
+		//	The scan starts after the last pick so equally loaded reactors still take turns.
+		AP_WS_ReactorAssignment NextReactor() {
 			std::lock_guard Lock(Mutex_);
-			NextReactor_++;
-			NextReactor_ %= NumberOfThreads_;
-			return std::make_pair(Reactors_[NextReactor_], DbSessions_[NextReactor_]);
+			SampleRates();
+
+			std::uint64_t TotalConnections = 0;
+			double TotalMessageRate = 0.0;
+			for (const auto &Load : Loads_) {
+				TotalConnections += Load->Connections;
+				TotalMessageRate += Load->MessageRate;
+			}
+			double ConnectionsPerMessage =
+				TotalMessageRate > 0.0 ? (double)TotalConnections / TotalMessageRate : 0.0;
+
+			auto Best = (NextReactor_ + 1) % NumberOfThreads_;
+			double BestScore = std::numeric_limits<double>::max();
+			for (std::uint64_t i = 0; i < NumberOfThreads_; ++i) {
+				auto Candidate = (NextReactor_ + 1 + i) % NumberOfThreads_;
+				const auto &Load = *Loads_[Candidate];
+				double Score = (double)Load.Connections + Load.MessageRate * ConnectionsPerMessage;
+				if (Score < BestScore) {
+					BestScore = Score;
+					Best = Candidate;
+				}
+			}
+			NextReactor_ = Best;
+			return AP_WS_ReactorAssignment{Reactors_[Best], DbSessions_[Best], Loads_[Best],
+										   ReceiveBuffers_[Best]};
+		}
+
+		std::vector<AP_WS_ReactorStats> GetStats() {
+			std::lock_guard Lock(Mutex_);
+			SampleRates();
+			std::vector<AP_WS_ReactorStats> Stats;
+			Stats.reserve(Loads_.size());
+			for (std::uint64_t i = 0; i < Loads_.size(); ++i) {
+				const auto &Load = *Loads_[i];
+				Stats.emplace_back(AP_WS_ReactorStats{i, Load.Connections, Load.Messages, Load.Bytes,
+													  Load.MessageRate, Load.ByteRate,
+													  ReceiveBuffers_[i]->Capacity()});
+			}
+			return Stats;
 		}
 
 	  private:
@@ -71,7 +209,30 @@ namespace OpenWifi {
 		std::vector<std::shared_ptr<Poco::Net::SocketReactor>> 	Reactors_;
 		std::vector<std::unique_ptr<Poco::Thread>> 				Threads_;
 		std::vector<std::shared_ptr<LockedDbSession>>			DbSessions_;
+		std::vector<std::shared_ptr<AP_WS_ReactorLoad>>			Loads_;
+		std::vector<std::shared_ptr<AP_WS_ReceiveBuffer>>		ReceiveBuffers_;
+		std::chrono::steady_clock::time_point					LastSample_;
 		Poco::Logger &Logger_;
 
+		static constexpr auto SampleInterval = std::chrono::seconds(5);
+
+		//	Exponentially weighted rates, refreshed at most every SampleInterval. Mutex_ must be held.
+		void SampleRates() {
+			auto Now = std::chrono::steady_clock::now();
+			auto Elapsed = std::chrono::duration<double>(Now - LastSample_).count();
+			if (Now - LastSample_ < SampleInterval)
+				return;
+			LastSample_ = Now;
+			for (auto &Load : Loads_) {
+				std::uint64_t Messages = Load->Messages, Bytes = Load->Bytes;
+				auto MessageRate = (double)(Messages - Load->LastMessages) / Elapsed;
+				auto ByteRate = (double)(Bytes - Load->LastBytes) / Elapsed;
+				Load->LastMessages = Messages;
+				Load->LastBytes = Bytes;
+				Load->MessageRate = 0.7 * Load->MessageRate + 0.3 * MessageRate;
+				Load->ByteRate = 0.7 * Load->ByteRate + 0.3 * ByteRate;
+			}
+		}
+
 	};
 } // namespace OpenWifi
\ No newline at end of file
@@ -12,6 +12,7 @@
 
 #include <AP_WS_Connection.h>
 #include <AP_WS_Server.h>
+#include <AP_WS_TicketKeys.h>
 #include <ConfigurationCache.h>
 #include <TelemetryStream.h>
 
@@ -33,12 +34,15 @@ namespace OpenWifi {
 
 		void handleRequest(	Poco::Net::HTTPServerRequest &request,
 						 	Poco::Net::HTTPServerResponse &response) override {
+			AP_WS_Server()->UpgradeStarted();
 			try {
 				auto NewConnection = std::make_shared<AP_WS_Connection>(request, response, session_id_, Logger_,
 																		AP_WS_Server()->NextReactor());
 				AP_WS_Server()->AddConnection(NewConnection);
 				NewConnection->Start();
+				AP_WS_Server()->UpgradeDone(true);
 			} catch (...) {
+				AP_WS_Server()->UpgradeDone(false);
 				poco_warning(Logger_, "Exception during WS creation");
 			}
 		};
@@ -90,11 +94,43 @@ namespace OpenWifi {
 		MismatchDepth_ = MicroServiceConfigGetInt("openwifi.certificates.mismatchdepth", 2);
 
 		SessionTimeOut_ = MicroServiceConfigGetInt("openwifi.session.timeout", 10*60);
+		SendQueueMaxFrames_ = MicroServiceConfigGetInt("openwifi.session.sendqueue.frames", 64);
+		SendQueueMaxBytes_ = MicroServiceConfigGetInt("openwifi.session.sendqueue.bytes", 4 * 1024 * 1024);
+		MaxDecompressedSize_ = MicroServiceConfigGetInt("openwifi.session.decompressed.max",
+														Utils::DefaultMaxDecompressedSize);
+		auto Shards = MicroServiceConfigGetInt("openwifi.session.shards", 256);
+		Sessions_.Resize(Shards);
+		Devices_.Resize(Shards);
 
 		Reactor_pool_ = std::make_unique<AP_WS_ReactorThreadPool>(Logger());
 		Reactor_pool_->Start();
 
-		for (const auto &Svr : ConfigServersList_) {
+		//	Accept and upgrade pipeline: the HTTP threads do the TLS handshake and the websocket
+		//	upgrade before handing the socket to a reactor.
+		auto PoolMin = MicroServiceConfigGetInt("ucentral.websocket.http.pool.min", 4);
+		auto PoolMax = MicroServiceConfigGetInt("ucentral.websocket.http.pool.max", 256);
+		DeviceConnectionPool_ = std::make_unique<Poco::ThreadPool>(
+			"ws:dev-pool", (int)std::max<std::uint64_t>(PoolMin, 1),
+			(int)std::max<std::uint64_t>(PoolMax, std::max<std::uint64_t>(PoolMin, 1)));
+		auto MaxThreads = MicroServiceConfigGetInt("ucentral.websocket.http.maxthreads", 50);
+		auto MaxQueued = MicroServiceConfigGetInt("ucentral.websocket.http.maxqueued", 200);
+		auto HandshakeTimeout = MicroServiceConfigGetInt("ucentral.websocket.http.timeout", 60);
+		auto AdmissionRate = MicroServiceConfigGetInt("ucentral.websocket.admission.rate", 0);
+		UpgradeAdmission_ = new AP_WS_UpgradeAdmission(
+			AdmissionRate, MicroServiceConfigGetInt("ucentral.websocket.admission.burst", AdmissionRate));
+		poco_information(Logger(),
+						 fmt::format("Device listeners: {} HTTP threads, {} queued sockets, pool {}-{}, "
+									 "admission {} per second.",
+									 MaxThreads, MaxQueued, PoolMin, PoolMax,
+									 AdmissionRate ? std::to_string(AdmissionRate) : "unlimited"));
+
+		AP_WS_TicketKeys()->Configure(
+			MicroServiceConfigGetInt("ucentral.websocket.tls.ticket.rotation", 3600),
+			MicroServiceConfigPath("ucentral.websocket.tls.ticket.keyfile", ""), Logger());
+
+		for (std::size_t HostIndex = 0; HostIndex < ConfigServersList_.size(); ++HostIndex) {
+			const auto &Svr = ConfigServersList_[HostIndex];
+			const auto HostPrefix = fmt::format("ucentral.websocket.host.{}.", HostIndex);
 
 			poco_notice(Logger(),
 						fmt::format("Starting: {}:{} Keyfile:{} CertFile: {}", Svr.Address(),
@@ -136,17 +172,42 @@ namespace OpenWifi {
 			Poco::Crypto::RSAKey Key("", Svr.KeyFile(), Svr.KeyFilePassword());
 			Context->usePrivateKey(Key);
 
-			Context->setSessionCacheSize(0);
-			Context->setSessionTimeout(120);
-			Context->flushSessionCache();
-			Context->enableSessionCache(true);
+			//	Let reconnecting devices resume their TLS session instead of paying for a full
+			//	handshake with client certificate verification.
+			auto SessionCache = MicroServiceConfigGetBool(HostPrefix + "session.cache", true);
+			auto SessionTickets = MicroServiceConfigGetBool(HostPrefix + "session.tickets", true);
+			Context->setSessionTimeout(
+				MicroServiceConfigGetInt(HostPrefix + "session.timeout", 3600));
+			if (SessionCache) {
+				Context->enableSessionCache(true, fmt::format("owgw-{}", Svr.Port()));
+				Context->setSessionCacheSize(
+					MicroServiceConfigGetInt(HostPrefix + "session.cache.size", 20480));
+			} else {
+				Context->enableSessionCache(false);
+			}
+			if (SessionTickets) {
+				if (!SessionCache) {
+					//	resumed sessions must carry the same session id context.
+					SSL_CTX_set_session_id_context(
+						Context->sslContext(),
+						reinterpret_cast<const unsigned char *>("owgw"), 4);
+				}
+				AP_WS_TicketKeys()->Install(Context->sslContext());
+			} else {
+				Context->disableStatelessSessionResumption();
+			}
+			poco_information(Logger(),
+							 fmt::format("Listener {}: TLS session cache {}, session tickets {}.",
+										 Svr.Port(), SessionCache ? "on" : "off",
+										 SessionTickets ? "on" : "off"));
 			Context->enableExtendedCertificateVerification(false);
 			Context->disableProtocols(Poco::Net::Context::PROTO_TLSV1 |
 									  Poco::Net::Context::PROTO_TLSV1_1);
 
 			auto WebServerHttpParams = new Poco::Net::HTTPServerParams;
-			WebServerHttpParams->setMaxThreads(50);
-			WebServerHttpParams->setMaxQueued(200);
+			WebServerHttpParams->setMaxThreads((int)MaxThreads);
+			WebServerHttpParams->setMaxQueued((int)MaxQueued);
+			WebServerHttpParams->setTimeout(Poco::Timespan((long)HandshakeTimeout, 0));
 			WebServerHttpParams->setKeepAlive(true);
 			WebServerHttpParams->setName("ws:ap_dispatch");
 
@@ -156,17 +217,19 @@ namespace OpenWifi {
 													  : Poco::Net::AddressFamily::IPv4));
 				Poco::Net::SocketAddress SockAddr(Addr, Svr.Port());
 				auto NewWebServer = std::make_unique<Poco::Net::HTTPServer>(
-					new AP_WS_RequestHandlerFactory(Logger()), DeviceConnectionPool_,
+					new AP_WS_RequestHandlerFactory(Logger()), *DeviceConnectionPool_,
 					Poco::Net::SecureServerSocket(SockAddr, Svr.Backlog(), Context),
 					WebServerHttpParams);
+				NewWebServer->setConnectionFilter(UpgradeAdmission_);
 				WebServers_.push_back(std::move(NewWebServer));
 			} else {
 				Poco::Net::IPAddress Addr(Svr.Address());
 				Poco::Net::SocketAddress SockAddr(Addr, Svr.Port());
 				auto NewWebServer = std::make_unique<Poco::Net::HTTPServer>(
-					new AP_WS_RequestHandlerFactory(Logger()), DeviceConnectionPool_,
+					new AP_WS_RequestHandlerFactory(Logger()), *DeviceConnectionPool_,
 					Poco::Net::SecureServerSocket(SockAddr, Svr.Backlog(), Context),
 					WebServerHttpParams);
+				NewWebServer->setConnectionFilter(UpgradeAdmission_);
 				WebServers_.push_back(std::move(NewWebServer));
 			}
 
@@ -201,233 +264,177 @@ namespace OpenWifi {
 		GarbageCollector_.setName("ws:garbage");
 		GarbageCollector_.start(*this);
 
-		std::thread CleanupThread([this](){ CleanupSessions(); });
-		CleanupThread.detach();
-
 		return 0;
 	}
 
-	bool AP_WS_Server::Disconnect(uint64_t SerialNumber) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == SerialNumbers_[hashIndex].end() || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
-			SerialNumbers_[hashIndex].erase(DeviceHint);
+	AP_WS_Server::UpgradeCounters AP_WS_Server::GetUpgradeCounters() const {
+		UpgradeCounters C;
+		if (UpgradeAdmission_) {
+			C.Admitted = UpgradeAdmission_->Admitted();
+			C.Rejected = UpgradeAdmission_->Rejected();
 		}
-
-		{
-			auto H = SessionHash::Hash(Connection->State_.sessionId);
-			std::lock_guard SessionLock(SessionMutex_[H]);
-			Sessions_[H].erase(Connection->State_.sessionId);
+		for (const auto &Server : WebServers_) {
+			C.Refused += Server->refusedConnections();
+			C.Queued += Server->queuedConnections();
 		}
+		C.InProgress = UpgradesInProgress_;
+		C.Completed = UpgradesCompleted_;
+		C.Failed = UpgradesFailed_;
+		return C;
+	}
 
+	bool AP_WS_Server::Disconnect(uint64_t SerialNumber) {
+		auto Connection = Devices_.Take(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
+		}
+		Sessions_.Erase(Connection->State_.sessionId);
 		return true;
 	}
 
-	void AP_WS_Server::CleanupSessions() {
+	//	Closes the live session of a device, e.g. once it has been blacklisted. The maps are cleaned
+	//	up by the regular session cleanup once the connection has ended.
+	bool AP_WS_Server::Evict(uint64_t SerialNumber) {
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
+		}
 
-		while(Running_) {
-			std::this_thread::sleep_for(std::chrono::seconds(10));
+		if (Connection->Dead_) {
+			return false;
+		}
+		Connection->Evict();
+		return true;
+	}
 
-			while(Running_ && !CleanupSessions_.empty()) {
-				std::pair<uint64_t, uint64_t> Session;
-				{
-					std::lock_guard G(CleanupMutex_);
-					Session = CleanupSessions_.front();
-					CleanupSessions_.pop_front();
+	void AP_WS_Server::ExpireSessions(std::uint64_t Now, Poco::Logger &LocalLogger) {
+		std::vector<std::shared_ptr<AP_WS_Connection>> Idle;
+		{
+			std::lock_guard G(ExpiryMutex_);
+			while (!Expiry_.empty() && Expiry_.top().Deadline <= Now) {
+				auto Connection = Expiry_.top().Connection.lock();
+				Expiry_.pop();
+				if (Connection == nullptr || Connection->Dead_) {
+					//	already gone, or its cleanup is queued.
+					continue;
+				}
+				std::uint64_t LastContact = Connection->LastContact_;
+				if (LastContact + SessionTimeOut_ > Now) {
+					Expiry_.push(ExpiryEntry{.Deadline = LastContact + SessionTimeOut_,
+											 .Connection = Connection});
+				} else {
+					Idle.emplace_back(std::move(Connection));
 				}
-				poco_trace(this->Logger(),fmt::format("Cleaning up session: {} for device: {}", Session.first, Utils::IntToSerialNumber(Session.second)));
-				EndSession(Session.first, Session.second);
 			}
 		}
+
+		for (auto &Connection : Idle) {
+			poco_information(
+				LocalLogger,
+				fmt::format("{}: Session seems idle. Controller disconnecting device.",
+							Connection->SerialNumber_));
+			Connection->Evict();
+		}
 	}
 
+	void AP_WS_Server::PublishLoad(std::uint64_t Now) {
+		GWWebSocketNotifications::NumberOfConnection_t Notification;
+		Notification.content.numberOfConnectingDevices = Sessions_.Count();
+		Notification.content.numberOfDevices = NumberOfConnectedDevices_;
+		Notification.content.averageConnectedTime = AverageDeviceConnectionTime();
+		GetTotalDataStatistics(Notification.content.tx, Notification.content.rx);
+		GWWebSocketNotifications::NumberOfConnections(Notification);
+
+		Poco::JSON::Object KafkaNotification;
+		Notification.to_json(KafkaNotification);
+
+		Poco::JSON::Object FullEvent;
+		FullEvent.set("type", "load-update");
+		FullEvent.set("timestamp", Now);
+		FullEvent.set("payload", KafkaNotification);
+
+		KafkaManager()->PostMessage(KafkaTopics::DEVICE_EVENT_QUEUE, "system", FullEvent);
+	}
+
+	//	Session janitor: removes ended sessions as soon as they are queued, disconnects idle devices
+	//	when their deadline passes, and publishes the load figures every 30 seconds.
 	void AP_WS_Server::run() {
+		constexpr std::uint64_t LoadUpdateInterval = 30;
 		uint64_t last_log = Utils::Now(),
-				 last_zombie_run = 0,
-				 last_garbage_run = 0;
+				 next_load_update = Utils::Now() + LoadUpdateInterval;
 
 		Poco::Logger &LocalLogger = Poco::Logger::create(
 			"WS-Session-Janitor", Poco::Logger::root().getChannel(), Poco::Logger::root().getLevel());
 
-		while(Running_) {
-
-			if(!Poco::Thread::trySleep(30000)) {
-				break;
+		std::deque<std::pair<uint64_t, uint64_t>> Ended;
+		while (true) {
+			{
+				std::unique_lock Lock(CleanupMutex_);
+				CleanupCondition_.wait_for(Lock, std::chrono::seconds(1), [this] {
+					return !Running_ || !CleanupSessions_.empty();
+				});
+				if (!Running_)
+					break;
+				Ended.swap(CleanupSessions_);
 			}
 
-			LocalLogger.information(fmt::format("Garbage collecting starting run."	));
-
-			uint64_t total_connected_time = 0, now = Utils::Now();
-
-			if(now-last_zombie_run > 60) {
-				try {
-					poco_information(LocalLogger,
-									 fmt::format("Garbage collecting zombies... (step 1)"));
-					NumberOfConnectingDevices_ = 0;
-					AverageDeviceConnectionTime_ = 0;
-					int waits = 0;
-					for (int hashIndex = 0; hashIndex < MACHash::HashMax(); hashIndex++) {
-						last_zombie_run = now;
-						waits = 0;
-						while (true) {
-							if (SerialNumbersMutex_[hashIndex].try_lock()) {
-								waits = 0;
-								auto hint = SerialNumbers_[hashIndex].begin();
-								while (hint != end(SerialNumbers_[hashIndex])) {
-									if (hint->second == nullptr) {
-										poco_information(
-											LocalLogger,
-											fmt::format("Dead device found in hash index {}", hashIndex));
-										hint = SerialNumbers_[hashIndex].erase(hint);
-									} else {
-										auto Device = hint->second;
-										auto RightNow = Utils::Now();
-										if (Device->Dead_) {
-											AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
-											++hint;
-											// hint = SerialNumbers_[hashIndex].erase(hint);
-										} else if (RightNow > Device->LastContact_ &&
-												   (RightNow - Device->LastContact_) > SessionTimeOut_) {
-											poco_information(
-												LocalLogger,
-												fmt::format(
-													"{}: Session seems idle. Controller disconnecting device.",
-													Device->SerialNumber_));
-											// hint = SerialNumbers_[hashIndex].erase(hint);
-											AddCleanupSession(Device->State_.sessionId, Device->SerialNumberInt_);
-											++hint;
-										} else {
-											if (Device->State_.Connected) {
-												total_connected_time +=
-													(RightNow - Device->State_.started);
-											}
-											++hint;
-										}
-									}
-								}
-								SerialNumbersMutex_[hashIndex].unlock();
-								break;
-							} else if (waits < 5) {
-								waits++;
-								Poco::Thread::trySleep(10);
-							} else {
-								break;
-							}
-						}
-					}
-
-					poco_information(LocalLogger, fmt::format("Garbage collecting zombies... (step 2)"));
-					LeftOverSessions_ = 0;
-					for (int i = 0; i < SessionHash::HashMax(); i++) {
-						waits = 0;
-						while (true) {
-							if (SessionMutex_[i].try_lock()) {
-								waits = 0;
-								auto hint = Sessions_[i].begin();
-								auto RightNow = Utils::Now();
-								while (hint != end(Sessions_[i])) {
-									if (hint->second == nullptr) {
-										hint = Sessions_[i].erase(hint);
-									} else if (hint->second->Dead_) {
-										// hint = Sessions_[i].erase(hint);
-										AddCleanupSession(hint->second->State_.sessionId, hint->second->SerialNumberInt_);
-										++hint;
-									} else if (RightNow > hint->second->LastContact_ &&
-											   (RightNow - hint->second->LastContact_) >
-												   SessionTimeOut_) {
-										poco_information(
-											LocalLogger,
-											fmt::format("{}: Session seems idle. Controller disconnecting device.",
-														hint->second->SerialNumber_));
-										AddCleanupSession(hint->second->State_.sessionId, hint->second->SerialNumberInt_);
-										++hint;
-										// hint = Sessions_[i].erase(hint);
-									} else {
-										++LeftOverSessions_;
-										++hint;
-									}
-								}
-								SessionMutex_[i].unlock();
-								break;
-							} else if (waits < 5) {
-								Poco::Thread::trySleep(10);
-								waits++;
-							} else {
-								break;
-							}
-						}
-					}
-
-					AverageDeviceConnectionTime_ = NumberOfConnectedDevices_ > 0
-													   ? total_connected_time / NumberOfConnectedDevices_
-													   : 0;
-					poco_information(LocalLogger, fmt::format("Garbage collecting zombies done..."));
-				} catch (const Poco::Exception &E) {
-					poco_error(LocalLogger, fmt::format("Poco::Exception: Garbage collecting zombies failed: {}", E.displayText()));
-				} catch (const std::exception &E) {
-					poco_error(LocalLogger, fmt::format("std::exception: Garbage collecting zombies failed: {}", E.what()));
-				} catch (...) {
-					poco_error(LocalLogger, fmt::format("exception:Garbage collecting zombies failed: {}", "unknown"));
+			try {
+				for (const auto &[session_id, SerialNumber] : Ended) {
+					poco_trace(LocalLogger, fmt::format("Cleaning up session: {} for device: {}", session_id,
+														Utils::IntToSerialNumber(SerialNumber)));
+					EndSession(session_id, SerialNumber);
 				}
+				Ended.clear();
 
-			}
+				auto now = Utils::Now();
+				ExpireSessions(now, LocalLogger);
 
-			if(NumberOfConnectedDevices_) {
-				if (last_garbage_run > 0) {
-					AverageDeviceConnectionTime_ += (now - last_garbage_run);
+				if (now >= next_load_update) {
+					next_load_update = now + LoadUpdateInterval;
+					PublishLoad(now);
 				}
-			}
 
-			try {
 				if ((now - last_log) > 60) {
 					last_log = now;
 					poco_information(
 						LocalLogger,
-						fmt::format("Active AP connections: {} Connecting: {} Average connection time: {} seconds. Left Over Sessions: {}",
-									NumberOfConnectedDevices_, NumberOfConnectingDevices_,
-									AverageDeviceConnectionTime_, LeftOverSessions_));
+						fmt::format("Active AP connections: {} Connecting: {} Average connection time: {} seconds. Dropped frames: {}",
+									NumberOfConnectedDevices_, Sessions_.Count(),
+									AverageDeviceConnectionTime(), TXDropped_));
+					poco_information(LocalLogger,
+									 fmt::format("TLS handshakes: {} full, {} resumed.",
+												 (std::uint64_t)FullHandshakes_, (std::uint64_t)ResumedHandshakes_));
+					auto Upgrades = GetUpgradeCounters();
+					poco_information(LocalLogger,
+									 fmt::format("Upgrades: {} completed, {} failed, {} in progress, {} queued, "
+												 "{} rejected by admission, {} refused by a full queue.",
+												 Upgrades.Completed, Upgrades.Failed, Upgrades.InProgress,
+												 Upgrades.Queued, Upgrades.Rejected, Upgrades.Refused));
+					std::uint64_t Entries = 0, Largest = 0;
+					Devices_.Occupancy(Entries, Largest);
+					poco_information(LocalLogger,
+									 fmt::format("Device table: {} devices in {} shards, largest shard {}.",
+												 Entries, Devices_.Size(), Largest));
 				}
-
-				GWWebSocketNotifications::NumberOfConnection_t Notification;
-				Notification.content.numberOfConnectingDevices = NumberOfConnectingDevices_;
-				Notification.content.numberOfDevices = NumberOfConnectedDevices_;
-				Notification.content.averageConnectedTime = AverageDeviceConnectionTime_;
-				GetTotalDataStatistics(Notification.content.tx, Notification.content.rx);
-				GWWebSocketNotifications::NumberOfConnections(Notification);
-
-				Poco::JSON::Object KafkaNotification;
-				Notification.to_json(KafkaNotification);
-
-				Poco::JSON::Object FullEvent;
-				FullEvent.set("type", "load-update");
-				FullEvent.set("timestamp", now);
-				FullEvent.set("payload", KafkaNotification);
-
-				KafkaManager()->PostMessage(KafkaTopics::DEVICE_EVENT_QUEUE, "system", FullEvent);
-				LocalLogger.information(fmt::format("Garbage collection finished run."));
-				last_garbage_run = now;
 			} catch (const Poco::Exception &E) {
-				LocalLogger.error(fmt::format("Poco::Exception: Garbage collecting failed: {}", E.displayText()));
+				LocalLogger.error(fmt::format("Poco::Exception: Session cleanup failed: {}", E.displayText()));
 			} catch (const std::exception &E) {
-				LocalLogger.error(fmt::format("std::exception: Garbage collecting failed: {}", E.what()));
+				LocalLogger.error(fmt::format("std::exception: Session cleanup failed: {}", E.what()));
 			} catch (...) {
-				LocalLogger.error(fmt::format("exception:Garbage collecting failed: {}", "unknown"));
+				LocalLogger.error(fmt::format("exception: Session cleanup failed: {}", "unknown"));
 			}
+			Ended.clear();
 		}
 		LocalLogger.information(fmt::format("Garbage collector done for the day."	));
 	}
 
 	void AP_WS_Server::Stop() {
 		poco_information(Logger(), "Stopping...");
-		Running_ = false;
-
-		GarbageCollector_.wakeUp();
+		{
+			std::lock_guard G(CleanupMutex_);
+			Running_ = false;
+		}
+		CleanupCondition_.notify_all();
 		GarbageCollector_.join();
 
 		for (auto &server : WebServers_) {
@@ -442,44 +449,29 @@ namespace OpenWifi {
 
 	bool AP_WS_Server::GetHealthDevices(std::uint64_t lowLimit, std::uint64_t  highLimit, std::vector<std::string> & SerialNumbers) {
 		SerialNumbers.clear();
-		for(int i=0;i<SessionHash::HashMax();i++) {
-			std::lock_guard Lock(SessionMutex_[i]);
-			for (const auto &connection : Sessions_[i]) {
-				if (connection.second->RawLastHealthcheck_.Sanity >= lowLimit &&
-					connection.second->RawLastHealthcheck_.Sanity <= highLimit) {
-					SerialNumbers.push_back(connection.second->SerialNumber_);
-				}
+		Devices_.ForEach([&](const std::shared_ptr<AP_WS_Connection> &Connection) {
+			GWObjects::HealthCheck Check;
+			Connection->GetLastHealthCheck(Check);
+			if (Check.Sanity >= lowLimit && Check.Sanity <= highLimit) {
+				SerialNumbers.push_back(Connection->SerialNumber_);
 			}
-		}
+		});
 		return true;
 	}
 
 	bool AP_WS_Server::GetStatistics(uint64_t SerialNumber, std::string &Statistics) const {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == SerialNumbers_[hashIndex].end() || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 		Connection->GetLastStats(Statistics);
 		return true;
 	}
 
 	bool AP_WS_Server::GetState(uint64_t SerialNumber, GWObjects::ConnectionState &State) const {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == SerialNumbers_[hashIndex].end() ||
-				DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 		Connection->GetState(State);
 		return true;
@@ -487,62 +479,47 @@ namespace OpenWifi {
 
 	bool AP_WS_Server::GetHealthcheck(uint64_t SerialNumber,
 									  GWObjects::HealthCheck &CheckData) const {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto Device = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (Device == SerialNumbers_[hashIndex].end() || Device->second == nullptr) {
-				return false;
-			}
-			Connection = Device->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 		Connection->GetLastHealthCheck(CheckData);
 		return true;
 
 	}
 
-	void AP_WS_Server::StartSession(uint64_t session_id, uint64_t SerialNumber) {
-		auto sessionHash = SessionHash::Hash(session_id);
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			std::lock_guard SessionLock(SessionMutex_[sessionHash]);
-			auto SessionHint = Sessions_[sessionHash].find(session_id);
-			if (SessionHint == end(Sessions_[sessionHash])) {
-				return;
-			}
-			Connection = SessionHint->second;
-			Sessions_[sessionHash].erase(SessionHint);
+	bool AP_WS_Server::SetLocale(uint64_t SerialNumber, const std::string &Locale) const {
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
+		Connection->SetLocale(Locale);
+		return true;
+	}
 
-		auto deviceHash = MACHash::Hash(SerialNumber);
-		std::lock_guard DeviceLock(SerialNumbersMutex_[deviceHash]);
-		SerialNumbers_[deviceHash][SerialNumber] = Connection;
+	void AP_WS_Server::StartSession(uint64_t session_id, uint64_t SerialNumber) {
+		auto Connection = Sessions_.Take(session_id);
+		if (Connection == nullptr) {
+			return;
+		}
+		Devices_.Assign(SerialNumber, std::move(Connection));
 	}
 
 	bool AP_WS_Server::EndSession(uint64_t session_id, uint64_t SerialNumber) {
 		{
 			poco_trace(Logger(), fmt::format("Ending session 1: {} for device: {}", session_id, Utils::IntToSerialNumber(SerialNumber)));
-			auto sessionHash = SessionHash::Hash(session_id);
-			std::lock_guard SessionLock(SessionMutex_[sessionHash]);
-			Sessions_[sessionHash].erase(session_id);
+			Sessions_.Erase(session_id);
 			poco_trace(Logger(), fmt::format("Ended session 1: {} for device: {}", session_id, Utils::IntToSerialNumber(SerialNumber)));
 		}
 
 		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			poco_trace(Logger(), fmt::format("Ending session 2.0: {} for device: {} hi:{}", session_id, Utils::IntToSerialNumber(SerialNumber), hashIndex));
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			poco_trace(Logger(), fmt::format("Ending session 2.1: {} for device: {} hi:{}", session_id, Utils::IntToSerialNumber(SerialNumber), hashIndex));
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			poco_trace(Logger(), fmt::format("Ending session 2.2: {} for device: {} hi:{}", session_id, Utils::IntToSerialNumber(SerialNumber), hashIndex));
-			if (DeviceHint == SerialNumbers_[hashIndex].end()
-				|| DeviceHint->second == nullptr
-				|| DeviceHint->second->State_.sessionId != session_id) {
+			poco_trace(Logger(), fmt::format("Ending session 2: {} for device: {}", session_id, Utils::IntToSerialNumber(SerialNumber)));
+			if (!Devices_.EraseIf(SerialNumber, [session_id](const std::shared_ptr<AP_WS_Connection> &Connection) {
+					return Connection->State_.sessionId == session_id;
+				})) {
 				poco_trace(Logger(), fmt::format("Did not end session 2: {} for device: {}", session_id, Utils::IntToSerialNumber(SerialNumber)));
 				return false;
 			}
-			SerialNumbers_[hashIndex].erase(DeviceHint);
 			poco_trace(Logger(), fmt::format("Ended session 2: {} for device: {}", session_id, Utils::IntToSerialNumber(SerialNumber)));
 		}
 		return true;
@@ -551,54 +528,35 @@ namespace OpenWifi {
 
 	bool AP_WS_Server::Connected(uint64_t SerialNumber,
 								 GWObjects::DeviceRestrictions &Restrictions) const {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
 			return false;
 		}
 		Restrictions = Connection->GetRestrictions();
-		return Connection->State_.Connected;
+		return Connection->IsConnected();
 	}
 
 
 	bool AP_WS_Server::Connected(uint64_t SerialNumber) const {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
 			return false;
 		}
-		return Connection->State_.Connected;
+		return Connection->IsConnected();
 	}
 
 	bool AP_WS_Server::SendFrame(uint64_t SerialNumber, const std::string &Payload) const {
-		auto hashIndex = MACHash::Hash(SerialNumber);
-
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
@@ -615,15 +573,9 @@ namespace OpenWifi {
 	}
 
 	void AP_WS_Server::StopWebSocketTelemetry(uint64_t RPCID, uint64_t SerialNumber) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto Device = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (Device == end(SerialNumbers_[hashIndex]) || Device->second == nullptr) {
-				return;
-			}
-			Connection = Device->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return;
 		}
 		Connection->StopWebSocketTelemetry(RPCID);
 	}
@@ -632,15 +584,9 @@ namespace OpenWifi {
 	AP_WS_Server::SetWebSocketTelemetryReporting(uint64_t RPCID, uint64_t SerialNumber,
 												 uint64_t Interval, uint64_t Lifetime,
 												 const std::vector<std::string> &TelemetryTypes) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return;
 		}
 		Connection->SetWebSocketTelemetryReporting(RPCID, Interval, Lifetime, TelemetryTypes);
 	}
@@ -648,29 +594,17 @@ namespace OpenWifi {
 	void AP_WS_Server::SetKafkaTelemetryReporting(uint64_t RPCID, uint64_t SerialNumber,
 												  uint64_t Interval, uint64_t Lifetime,
 												  const std::vector<std::string> &TelemetryTypes) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return;
 		}
 		Connection->SetKafkaTelemetryReporting(RPCID, Interval, Lifetime, TelemetryTypes);
 	}
 
 	void AP_WS_Server::StopKafkaTelemetry(uint64_t RPCID, uint64_t SerialNumber) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DevicesLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return;
 		}
 		Connection->StopKafkaTelemetry(RPCID);
 	}
@@ -681,15 +615,9 @@ namespace OpenWifi {
 		uint64_t &TelemetryWebSocketCount, uint64_t &TelemetryKafkaCount,
 		uint64_t &TelemetryWebSocketPackets, uint64_t &TelemetryKafkaPackets) {
 
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto hashIndex = MACHash::Hash(SerialNumber);
-			std::lock_guard DevicesLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(SerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return;
-			}
-			Connection = DeviceHint->second;
+		auto Connection = Devices_.Find(SerialNumber);
+		if (Connection == nullptr) {
+			return;
 		}
 
 		Connection->GetTelemetryParameters(TelemetryRunning, TelemetryInterval,
@@ -701,16 +629,10 @@ namespace OpenWifi {
 	bool AP_WS_Server::SendRadiusAccountingData(const std::string &SerialNumber,
 												const unsigned char *buffer, std::size_t size) {
 
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
-			auto hashIndex = MACHash::Hash(IntSerialNumber);
-			std::lock_guard DevicesLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(IntSerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
+		auto Connection = Devices_.Find(IntSerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
@@ -730,16 +652,10 @@ namespace OpenWifi {
 
 	bool AP_WS_Server::SendRadiusAuthenticationData(const std::string &SerialNumber,
 													const unsigned char *buffer, std::size_t size) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
-			auto hashIndex = MACHash::Hash(IntSerialNumber);
-			std::lock_guard DevicesLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(IntSerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
+		auto Connection = Devices_.Find(IntSerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
@@ -759,16 +675,10 @@ namespace OpenWifi {
 
 	bool AP_WS_Server::SendRadiusCoAData(const std::string &SerialNumber,
 										 const unsigned char *buffer, std::size_t size) {
-		std::shared_ptr<AP_WS_Connection> Connection;
-		{
-			auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
-			auto hashIndex = MACHash::Hash(IntSerialNumber);
-			std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-			auto DeviceHint = SerialNumbers_[hashIndex].find(IntSerialNumber);
-			if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr) {
-				return false;
-			}
-			Connection = DeviceHint->second;
+		auto IntSerialNumber = Utils::SerialNumberToInt(SerialNumber);
+		auto Connection = Devices_.Find(IntSerialNumber);
+		if (Connection == nullptr) {
+			return false;
 		}
 
 		if(Connection->Dead_) {
@@ -9,8 +9,10 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
 #include <ctime>
 #include <mutex>
+#include <queue>
 #include <thread>
 
 #include "Poco/AutoPtr.h"
@@ -24,52 +26,27 @@
 #include "Poco/Timer.h"
 
 #include "AP_WS_Connection.h"
+#include "AP_WS_ConnectionTable.h"
 #include "AP_WS_Reactor_Pool.h"
+#include "AP_WS_UpgradeAdmission.h"
 
 #include "framework/SubSystemServer.h"
 #include "framework/utils.h"
 
 namespace OpenWifi {
 
-	constexpr uint MACHashMax = 256;
-	constexpr uint MACHashMask = MACHashMax-1;
-	class MACHash {
-	  public:
-		[[nodiscard]] static inline uint16_t Hash(std::uint64_t value) {
-			uint8_t hash = 0, i=6;
-			while(i) {
-				hash ^= (value & MACHashMask) + 1;
-				value >>= 8;
-				--i;
-			}
-			return hash;
-		}
-
-		[[nodiscard]] static inline uint16_t Hash(const std::string & value) {
-			return Hash(Utils::MACToInt(value));
-		}
-
-		[[nodiscard]] static inline uint16_t HashMax() {
-			return MACHashMax;
-		}
-	};
-
-	constexpr uint SessionHashMax = 256;
-	constexpr uint SessionHashMask = SessionHashMax-1;
-	class SessionHash {
-	  public:
-		[[nodiscard]] static inline uint16_t Hash(std::uint64_t value) {
-			return (value & SessionHashMask);
-		}
-
-		[[nodiscard]] static inline uint16_t HashMax() {
-			return SessionHashMax;
-		}
-	};
-
-
 	class AP_WS_Server : public SubSystemServer, public Poco::Runnable {
 	  public:
+		struct UpgradeCounters {
+			std::uint64_t Admitted = 0;		//	sockets let through by the admission filter
+			std::uint64_t Rejected = 0;		//	sockets closed by the admission filter
+			std::uint64_t Refused = 0;		//	sockets dropped because the listener queue was full
+			std::uint64_t Queued = 0;		//	sockets waiting for an HTTP thread right now
+			std::uint64_t InProgress = 0;	//	upgrades being handled right now
+			std::uint64_t Completed = 0;
+			std::uint64_t Failed = 0;
+		};
+
 		static auto instance() {
 			static auto instance_ = new AP_WS_Server;
 			return instance_;
@@ -97,28 +74,23 @@ namespace OpenWifi {
 		[[nodiscard]] inline bool UseProvisioning() const { return LookAtProvisioning_; }
 		[[nodiscard]] inline bool UseDefaults() const { return UseDefaultConfig_; }
 		[[nodiscard]] inline bool Running() const { return Running_; }
-		[[nodiscard]] inline std::pair<std::shared_ptr<Poco::Net::SocketReactor>, std::shared_ptr<LockedDbSession>> NextReactor() {
+		[[nodiscard]] inline AP_WS_ReactorAssignment NextReactor() {
 			return Reactor_pool_->NextReactor();
 		}
+		[[nodiscard]] inline std::vector<AP_WS_ReactorStats> ReactorStats() {
+			return Reactor_pool_->GetStats();
+		}
 
 		inline void AddConnection(std::shared_ptr<AP_WS_Connection> Connection) {
-			std::uint64_t sessionHash = SessionHash::Hash(Connection->State_.sessionId);
-			std::lock_guard SessionLock(SessionMutex_[sessionHash]);
-			if(Sessions_[sessionHash].find(Connection->State_.sessionId)==end(Sessions_[sessionHash])) {
-				Sessions_[sessionHash][Connection->State_.sessionId] = std::move(Connection);
-			}
+			auto SessionId = Connection->State_.sessionId;
+			AddExpiry(Connection, Utils::Now() + SessionTimeOut_);
+			Sessions_.Insert(SessionId, std::move(Connection));
 		}
 
 		[[nodiscard]] inline bool DeviceRequiresSecureRTTY(uint64_t serialNumber) const {
-			std::shared_ptr<AP_WS_Connection> Connection;
-			{
-				auto hashIndex = MACHash::Hash(serialNumber);
-				std::lock_guard DeviceLock(SerialNumbersMutex_[hashIndex]);
-				auto DeviceHint = SerialNumbers_[hashIndex].find(serialNumber);
-				if (DeviceHint == end(SerialNumbers_[hashIndex]) || DeviceHint->second == nullptr)
-					return false;
-				Connection = DeviceHint->second;
-			}
+			auto Connection = Devices_.Find(serialNumber);
+			if (Connection == nullptr)
+				return false;
 			return Connection->RTTYMustBeSecure_;
 		}
 
@@ -138,10 +110,12 @@ namespace OpenWifi {
 			return GetHealthcheck(Utils::SerialNumberToInt(SerialNumber), CheckData);
 		}
 		bool GetHealthcheck(uint64_t SerialNumber, GWObjects::HealthCheck &CheckData) const;
+		bool SetLocale(uint64_t SerialNumber, const std::string &Locale) const;
 
 		bool Connected(uint64_t SerialNumber, GWObjects::DeviceRestrictions &Restrictions) const;
 		bool Connected(uint64_t SerialNumber) const;
 		bool Disconnect(uint64_t SerialNumber);
+		bool Evict(uint64_t SerialNumber);
 		bool SendFrame(uint64_t SerialNumber, const std::string &Payload) const;
 		bool SendRadiusAuthenticationData(const std::string &SerialNumber,
 										  const unsigned char *buffer, std::size_t size);
@@ -175,8 +149,8 @@ namespace OpenWifi {
 		inline void AverageDeviceStatistics(uint64_t &Connections, uint64_t &AverageConnectionTime,
 											uint64_t &NumberOfConnectingDevices) const {
 			Connections = NumberOfConnectedDevices_;
-			AverageConnectionTime = AverageDeviceConnectionTime_;
-			NumberOfConnectingDevices = NumberOfConnectingDevices_;
+			AverageConnectionTime = AverageDeviceConnectionTime();
+			NumberOfConnectingDevices = Sessions_.Count();
 		}
 
 		inline bool SendFrame(const std::string &SerialNumber, const std::string &Payload) const {
@@ -191,11 +165,20 @@ namespace OpenWifi {
 			TX_ += bytes;
 		}
 
+		inline void AddTXDropped(std::uint64_t frames) {
+			TXDropped_ += frames;
+		}
+
 		inline void GetTotalDataStatistics(std::uint64_t &TX, std::uint64_t &RX) const {
 			TX = TX_;
 			RX = RX_;
 		}
 
+		[[nodiscard]] inline std::uint64_t TXDropped() const { return TXDropped_; }
+		[[nodiscard]] inline std::uint64_t SendQueueMaxFrames() const { return SendQueueMaxFrames_; }
+		[[nodiscard]] inline std::uint64_t SendQueueMaxBytes() const { return SendQueueMaxBytes_; }
+		[[nodiscard]] inline std::uint64_t MaxDecompressedSize() const { return MaxDecompressedSize_; }
+
 		bool KafkaDisableState() const { return KafkaDisableState_; }
 		bool KafkaDisableHealthChecks() const { return KafkaDisableHealthChecks_; }
 
@@ -207,24 +190,58 @@ namespace OpenWifi {
 			--NumberOfConnectedDevices_;
 		}
 
-		inline void AddCleanupSession(uint64_t session_id, uint64_t SerialNumber) {
-			std::lock_guard G(CleanupMutex_);
-			CleanupSessions_.emplace_back(session_id, SerialNumber);
+		//	Kept by the connections as they complete or end, so the load figures never need a walk
+		//	over the tables.
+		inline void DeviceConnected(std::uint64_t Started) {
+			SumConnectedSince_ += Started;
+			++ConnectedDevices_;
+		}
+
+		inline void DeviceDisconnected(std::uint64_t Started) {
+			SumConnectedSince_ -= Started;
+			--ConnectedDevices_;
+		}
+
+		[[nodiscard]] inline std::uint64_t AverageDeviceConnectionTime() const {
+			std::uint64_t Count = ConnectedDevices_, Sum = SumConnectedSince_, Now = Utils::Now();
+			if (Count == 0 || (Sum / Count) > Now)
+				return 0;
+			return Now - (Sum / Count);
+		}
+
+		inline void UpgradeStarted() { ++UpgradesInProgress_; }
+		inline void UpgradeDone(bool Success) {
+			--UpgradesInProgress_;
+			if (Success)
+				++UpgradesCompleted_;
+			else
+				++UpgradesFailed_;
+		}
+		UpgradeCounters GetUpgradeCounters() const;
+
+		inline void CountHandshake(bool Resumed) {
+			if (Resumed)
+				++ResumedHandshakes_;
+			else
+				++FullHandshakes_;
 		}
 
-		void CleanupSessions();
+		inline void AddCleanupSession(uint64_t session_id, uint64_t SerialNumber) {
+			{
+				std::lock_guard G(CleanupMutex_);
+				CleanupSessions_.emplace_back(session_id, SerialNumber);
+			}
+			CleanupCondition_.notify_one();
+		}
 
 	  private:
-		std::array<std::mutex,SessionHashMax> 			SessionMutex_;
-		std::array<std::map<std::uint64_t, std::shared_ptr<AP_WS_Connection>>,SessionHashMax> Sessions_;
-		using SerialNumberMap = std::map<uint64_t /* serial number */,
-										 std::shared_ptr<AP_WS_Connection>>;
-		std::array<SerialNumberMap,MACHashMax>			SerialNumbers_;
-		mutable std::array<std::mutex,MACHashMax>		SerialNumbersMutex_;
+		AP_WS_ConnectionTable 	Sessions_;		//	session id -> connection, until the device connects
+		AP_WS_ConnectionTable 	Devices_;		//	serial number -> connection
 
 		std::unique_ptr<Poco::Crypto::X509Certificate> IssuerCert_;
+		std::unique_ptr<Poco::ThreadPool> DeviceConnectionPool_;
+		Poco::AutoPtr<AP_WS_UpgradeAdmission> UpgradeAdmission_;
 		std::list<std::unique_ptr<Poco::Net::HTTPServer>> WebServers_;
-		Poco::ThreadPool DeviceConnectionPool_{"ws:dev-pool", 4, 256};
 		Poco::Net::SocketReactor Reactor_;
 		Poco::Thread ReactorThread_;
 		std::string SimulatorId_;
@@ -233,27 +250,50 @@ namespace OpenWifi {
 		bool SimulatorEnabled_ = false;
 		bool AllowSerialNumberMismatch_ = true;
 
-		Poco::Thread            CleanupThread_;
 		std::mutex              CleanupMutex_;
+		std::condition_variable CleanupCondition_;
 		std::deque<std::pair<uint64_t, uint64_t>> CleanupSessions_;
 
+		//	Inactivity deadlines, earliest first. An entry is only checked when its deadline passes:
+		//	an active connection is then pushed back with its new deadline.
+		struct ExpiryEntry {
+			std::uint64_t 						Deadline;
+			std::weak_ptr<AP_WS_Connection> 	Connection;
+			bool operator>(const ExpiryEntry &E) const { return Deadline > E.Deadline; }
+		};
+		std::mutex 				ExpiryMutex_;
+		std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<>> Expiry_;
+
 		std::unique_ptr<AP_WS_ReactorThreadPool> Reactor_pool_;
 		std::atomic_bool Running_ = false;
 
 		std::uint64_t 			MismatchDepth_ = 2;
 
 		std::atomic_uint64_t 	NumberOfConnectedDevices_ = 0;
-		std::atomic_uint64_t 	AverageDeviceConnectionTime_ = 0;
-		std::uint64_t 			NumberOfConnectingDevices_ = 0;
+		std::atomic_uint64_t 	ConnectedDevices_ = 0;
+		std::atomic_uint64_t 	SumConnectedSince_ = 0;
 		std::uint64_t 			SessionTimeOut_ = 10*60;
-		std::uint64_t 			LeftOverSessions_ = 0;
 		std::atomic_uint64_t 	TX_=0,RX_=0;
+		std::atomic_uint64_t 	TXDropped_=0;
+		std::atomic_uint64_t 	FullHandshakes_=0, ResumedHandshakes_=0;
+		std::atomic_uint64_t 	UpgradesInProgress_=0, UpgradesCompleted_=0, UpgradesFailed_=0;
+		std::uint64_t 			SendQueueMaxFrames_ = 64;
+		std::uint64_t 			SendQueueMaxBytes_ = 4 * 1024 * 1024;
+		std::uint64_t 			MaxDecompressedSize_ = Utils::DefaultMaxDecompressedSize;
 
 		std::atomic_bool 		KafkaDisableState_=false,
 						 		KafkaDisableHealthChecks_=false;
 
 		Poco::Thread 			GarbageCollector_;
 
+		inline void AddExpiry(const std::shared_ptr<AP_WS_Connection> &Connection,
+							  std::uint64_t Deadline) {
+			std::lock_guard G(ExpiryMutex_);
+			Expiry_.push(ExpiryEntry{.Deadline = Deadline, .Connection = Connection});
+		}
+		void ExpireSessions(std::uint64_t Now, Poco::Logger &LocalLogger);
+		void PublishLoad(std::uint64_t Now);
+
 		AP_WS_Server() noexcept
 			: SubSystemServer("WebSocketServer", "WS-SVR", "ucentral.websocket") {}
 	};
@@ -0,0 +1,178 @@
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include <sys/stat.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+#include "Poco/Exception.h"
+#include "Poco/File.h"
+
+#include "AP_WS_TicketKeys.h"
+
+#include "fmt/format.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	using TicketMacContext = EVP_MAC_CTX;
+
+	static bool InitTicketMac(EVP_MAC_CTX *Mac, unsigned char *Key, std::size_t KeySize) {
+		char Digest[] = "SHA256";
+		OSSL_PARAM Params[3];
+		Params[0] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, Key, KeySize);
+		Params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, Digest, 0);
+		Params[2] = OSSL_PARAM_construct_end();
+		return EVP_MAC_CTX_set_params(Mac, Params) == 1;
+	}
+#else
+	using TicketMacContext = HMAC_CTX;
+
+	static bool InitTicketMac(HMAC_CTX *Mac, unsigned char *Key, std::size_t KeySize) {
+		return HMAC_Init_ex(Mac, Key, (int)KeySize, EVP_sha256(), nullptr) == 1;
+	}
+#endif
+
+	bool AP_WS_TicketKeys::NewKey(Key &K) {
+		if (RAND_bytes(K.Name.data(), (int)K.Name.size()) != 1 ||
+			RAND_bytes(K.AES.data(), (int)K.AES.size()) != 1 ||
+			RAND_bytes(K.HMAC.data(), (int)K.HMAC.size()) != 1)
+			return false;
+		K.Created = Utils::Now();
+		return true;
+	}
+
+	void AP_WS_TicketKeys::Configure(std::uint64_t RotationInterval, const std::string &KeyFile,
+									 Poco::Logger &L) {
+		std::unique_lock Lock(Mutex_);
+		Logger_ = &L;
+		RotationInterval_ = RotationInterval ? RotationInterval : 3600;
+		KeyFile_ = KeyFile;
+		if (Current_.Created != 0)
+			return;
+		if (!KeyFile_.empty() && Load()) {
+			poco_information(L, fmt::format("TLS ticket keys loaded from {}.", KeyFile_));
+			return;
+		}
+		NewKey(Current_);
+		Save();
+	}
+
+	void AP_WS_TicketKeys::Install(SSL_CTX *Context) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		SSL_CTX_set_tlsext_ticket_key_evp_cb(Context, &TicketCallback<TicketMacContext>);
+#else
+		SSL_CTX_set_tlsext_ticket_key_cb(Context, &TicketCallback<TicketMacContext>);
+#endif
+	}
+
+	void AP_WS_TicketKeys::RotateIfNeeded() {
+		{
+			std::shared_lock Lock(Mutex_);
+			if ((Utils::Now() - Current_.Created) < RotationInterval_)
+				return;
+		}
+		std::unique_lock Lock(Mutex_);
+		if ((Utils::Now() - Current_.Created) < RotationInterval_)
+			return;
+		Key Next;
+		if (!NewKey(Next))
+			return;
+		Previous_ = Current_;
+		HasPrevious_ = true;
+		Current_ = Next;
+		Save();
+		if (Logger_ != nullptr)
+			poco_information(*Logger_, "TLS ticket keys rotated.");
+	}
+
+	//	Key file: the current key followed by the previous one. Only called with the lock held.
+	bool AP_WS_TicketKeys::Load() {
+		std::ifstream In(KeyFile_, std::ios::binary);
+		if (!In)
+			return false;
+		Key Keys[2];
+		for (auto &K : Keys) {
+			In.read(reinterpret_cast<char *>(K.Name.data()), K.Name.size());
+			In.read(reinterpret_cast<char *>(K.AES.data()), K.AES.size());
+			In.read(reinterpret_cast<char *>(K.HMAC.data()), K.HMAC.size());
+			In.read(reinterpret_cast<char *>(&K.Created), sizeof(K.Created));
+		}
+		if (!In || Keys[0].Created == 0)
+			return false;
+		Current_ = Keys[0];
+		Previous_ = Keys[1];
+		HasPrevious_ = Keys[1].Created != 0;
+		return true;
+	}
+
+	void AP_WS_TicketKeys::Save() {
+		if (KeyFile_.empty())
+			return;
+		try {
+			auto TmpName = KeyFile_ + ".tmp";
+			{
+				std::ofstream Out(TmpName, std::ios::binary | std::ios::trunc);
+				::chmod(TmpName.c_str(), S_IRUSR | S_IWUSR);
+				Key Empty;
+				for (const auto *K : {&Current_, HasPrevious_ ? &Previous_ : &Empty}) {
+					Out.write(reinterpret_cast<const char *>(K->Name.data()), K->Name.size());
+					Out.write(reinterpret_cast<const char *>(K->AES.data()), K->AES.size());
+					Out.write(reinterpret_cast<const char *>(K->HMAC.data()), K->HMAC.size());
+					Out.write(reinterpret_cast<const char *>(&K->Created), sizeof(K->Created));
+				}
+				if (!Out)
+					throw Poco::WriteFileException(TmpName);
+			}
+			Poco::File(TmpName).renameTo(KeyFile_);
+		} catch (const Poco::Exception &E) {
+			if (Logger_ != nullptr)
+				Logger_->log(E);
+		}
+	}
+
+	template <typename MacContext>
+	int AP_WS_TicketKeys::TicketCallback([[maybe_unused]] SSL *S, unsigned char *Name,
+										 unsigned char *IV, EVP_CIPHER_CTX *Cipher,
+										 MacContext *Mac, int Encrypt) {
+		auto Keys = instance();
+		if (Encrypt) {
+			Keys->RotateIfNeeded();
+			std::shared_lock Lock(Keys->Mutex_);
+			auto &K = Keys->Current_;
+			if (RAND_bytes(IV, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1)
+				return -1;
+			std::memcpy(Name, K.Name.data(), K.Name.size());
+			if (EVP_EncryptInit_ex(Cipher, EVP_aes_256_cbc(), nullptr, K.AES.data(), IV) != 1 ||
+				!InitTicketMac(Mac, K.HMAC.data(), K.HMAC.size()))
+				return -1;
+			return 1;
+		}
+
+		std::shared_lock Lock(Keys->Mutex_);
+		const Key *K = nullptr;
+		bool Renew = false;
+		if (std::memcmp(Name, Keys->Current_.Name.data(), Keys->Current_.Name.size()) == 0) {
+			K = &Keys->Current_;
+		} else if (Keys->HasPrevious_ &&
+				   std::memcmp(Name, Keys->Previous_.Name.data(), Keys->Previous_.Name.size()) == 0) {
+			K = &Keys->Previous_;
+			Renew = true;
+		}
+		if (K == nullptr)
+			return 0; //	unknown key: full handshake
+		auto HMACKey = K->HMAC;
+		if (!InitTicketMac(Mac, HMACKey.data(), HMACKey.size()) ||
+			EVP_DecryptInit_ex(Cipher, EVP_aes_256_cbc(), nullptr, K->AES.data(), IV) != 1)
+			return -1;
+		return Renew ? 2 : 1;
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "Poco/Logger.h"
+
+namespace OpenWifi {
+
+	//	Keys used to encrypt the stateless TLS session tickets handed to devices. The current key
+	//	encrypts new tickets and is replaced every rotation interval; the previous one is still
+	//	accepted so tickets issued just before a rotation keep working. When a key file is set, the
+	//	keys are saved there so devices can resume their sessions after a controller restart.
+	class AP_WS_TicketKeys {
+	  public:
+		static auto instance() {
+			static auto instance_ = new AP_WS_TicketKeys;
+			return instance_;
+		}
+
+		void Configure(std::uint64_t RotationInterval, const std::string &KeyFile, Poco::Logger &L);
+		void Install(SSL_CTX *Context);
+
+	  private:
+		struct Key {
+			std::array<unsigned char, 16> Name{};
+			std::array<unsigned char, 32> AES{};
+			std::array<unsigned char, 32> HMAC{};
+			std::uint64_t Created = 0;
+		};
+
+		std::shared_mutex 	Mutex_;
+		Key 				Current_;
+		Key 				Previous_;
+		bool 				HasPrevious_ = false;
+		std::uint64_t 		RotationInterval_ = 3600;
+		std::string 		KeyFile_;
+		Poco::Logger 		*Logger_ = nullptr;
+
+		static bool NewKey(Key &K);
+		void RotateIfNeeded();
+		bool Load();
+		void Save();
+
+		template <typename MacContext>
+		static int TicketCallback(SSL *S, unsigned char *Name, unsigned char *IV,
+								  EVP_CIPHER_CTX *Cipher, MacContext *Mac, int Encrypt);
+
+		AP_WS_TicketKeys() = default;
+	};
+
+	inline auto AP_WS_TicketKeys() { return AP_WS_TicketKeys::instance(); }
+
+} // namespace OpenWifi
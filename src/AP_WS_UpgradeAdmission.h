@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/TCPServerConnectionFilter.h"
+
+namespace OpenWifi {
+
+	//	Token bucket applied to new device sockets by the listener acceptor threads, before the TLS
+	//	handshake and before the socket is queued for an HTTP thread. During a reconnect storm the
+	//	excess sockets are closed right away instead of piling up in the queue, and the devices
+	//	simply retry. A rate of 0 admits everything.
+	class AP_WS_UpgradeAdmission : public Poco::Net::TCPServerConnectionFilter {
+	  public:
+		AP_WS_UpgradeAdmission(std::uint64_t Rate, std::uint64_t Burst)
+			: Rate_((double)Rate), Burst_((double)std::max<std::uint64_t>(Burst, 1)),
+			  Tokens_(Burst_), Last_(Clock::now()) {}
+
+		bool accept([[maybe_unused]] const Poco::Net::StreamSocket &Socket) override {
+			if (Rate_ > 0.0) {
+				std::lock_guard G(Mutex_);
+				auto Now = Clock::now();
+				Tokens_ = std::min(Burst_, Tokens_ + Rate_ * std::chrono::duration<double>(Now - Last_).count());
+				Last_ = Now;
+				if (Tokens_ < 1.0) {
+					++Rejected_;
+					return false;
+				}
+				Tokens_ -= 1.0;
+			}
+			++Admitted_;
+			return true;
+		}
+
+		[[nodiscard]] inline std::uint64_t Admitted() const { return Admitted_; }
+		[[nodiscard]] inline std::uint64_t Rejected() const { return Rejected_; }
+
+	  private:
+		using Clock = std::chrono::steady_clock;
+
+		std::mutex 				Mutex_;
+		double 					Rate_;
+		double 					Burst_;
+		double 					Tokens_;
+		Clock::time_point 		Last_;
+		std::atomic_uint64_t 	Admitted_ = 0;
+		std::atomic_uint64_t 	Rejected_ = 0;
+	};
+
+} // namespace OpenWifi
@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <fstream>
+
+#include "CapabilitiesCache.h"
+
+#include "fmt/format.h"
+#include "framework/utils.h"
+
+namespace OpenWifi {
+
+	int CapabilitiesCache::Start() {
+		poco_information(Logger(), "Starting...");
+		FlushDelay_ = MicroServiceConfigGetInt("capabilities.cache.delay", 2000);
+		{
+			std::unique_lock G(Mutex_);
+			PlatformCacheFileName_ = MicroServiceDataDirectory() + PlatformCacheFileName;
+			CapabilitiesCacheFileName_ = MicroServiceDataDirectory() + CapabilitiesCacheFileName;
+		}
+		EnsureLoaded();
+		{
+			std::lock_guard G(FlushMutex_);
+			Running_ = true;
+		}
+		Worker_.start(*this);
+		return 0;
+	}
+
+	void CapabilitiesCache::Stop() {
+		poco_information(Logger(), "Stopping...");
+		{
+			std::lock_guard G(FlushMutex_);
+			Running_ = false;
+		}
+		FlushCondition_.notify_all();
+		Worker_.join();
+		poco_information(Logger(),
+						 fmt::format("Stopped... Changes={} Writes={} BytesWritten={}",
+									 (std::uint64_t)Changes_, (std::uint64_t)Writes_,
+									 (std::uint64_t)BytesWritten_));
+	}
+
+	void CapabilitiesCache::Add(const Config::Capabilities &Caps) {
+		if (Caps.Compatible().empty() || Caps.Platform().empty())
+			return;
+
+		EnsureLoaded();
+		auto P = Poco::toLower(Caps.Platform());
+		const auto &Raw = Caps.AsString();
+
+		{
+			std::shared_lock G(Mutex_);
+			auto PlatformHint = Platforms_.find(Caps.Compatible());
+			auto RawHint = RawCapabilities_.find(Caps.Compatible());
+			if (PlatformHint != Platforms_.end() && PlatformHint->second == P &&
+				RawHint != RawCapabilities_.end() && RawHint->second == Raw)
+				return;
+		}
+
+		//	parse outside the lock, and before anything changes: a document that does not parse
+		//	leaves the cache as it was.
+		nlohmann::json Parsed;
+		try {
+			Parsed = nlohmann::json::parse(Raw);
+		} catch (const std::exception &E) {
+			poco_warning(Logger(), fmt::format("Invalid capabilities for {}: {}", Caps.Compatible(),
+											   E.what()));
+			return;
+		}
+
+		bool PlatformChanged = false, CapabilitiesChanged = false;
+		{
+			std::unique_lock G(Mutex_);
+			auto PlatformHint = Platforms_.find(Caps.Compatible());
+			if (PlatformHint == Platforms_.end() || PlatformHint->second != P) {
+				Platforms_[Caps.Compatible()] = P;
+				PlatformChanged = true;
+			}
+
+			auto RawHint = RawCapabilities_.find(Caps.Compatible());
+			if (RawHint == RawCapabilities_.end() || RawHint->second != Raw) {
+				//	a device reconnecting after a restart reports the same content, possibly formatted
+				//	differently: only a different document is a change.
+				auto CapHint = Capabilities_.find(Caps.Compatible());
+				if (CapHint == Capabilities_.end() || CapHint->second != Parsed) {
+					Capabilities_[Caps.Compatible()] = std::move(Parsed);
+					CapabilitiesChanged = true;
+				}
+				RawCapabilities_[Caps.Compatible()] = Raw;
+			}
+		}
+
+		if (PlatformChanged || CapabilitiesChanged) {
+			++Changes_;
+			MarkDirty(PlatformChanged, CapabilitiesChanged);
+		}
+	}
+
+	std::string CapabilitiesCache::GetPlatform(const std::string &DeviceType) {
+		EnsureLoaded();
+		std::shared_lock G(Mutex_);
+		auto Hint = Platforms_.find(DeviceType);
+		if (Hint == Platforms_.end())
+			return Platforms::AP;
+		return Hint->second;
+	}
+
+	nlohmann::json CapabilitiesCache::GetCapabilities(const std::string &DeviceType) {
+		EnsureLoaded();
+		std::shared_lock G(Mutex_);
+		auto Hint = Capabilities_.find(DeviceType);
+		if (Hint == Capabilities_.end())
+			return nlohmann::json{};
+		return Hint->second;
+	}
+
+	CapabilitiesCache_t CapabilitiesCache::AllCapabilities() {
+		EnsureLoaded();
+		std::shared_lock G(Mutex_);
+		return Capabilities_;
+	}
+
+	void CapabilitiesCache::EnsureLoaded() {
+		if (Loaded_)
+			return;
+		std::unique_lock G(Mutex_);
+		//	the files are only known once Start() has run
+		if (Loaded_ || PlatformCacheFileName_.empty())
+			return;
+		LoadPlatforms();
+		LoadCapabilities();
+		Loaded_ = true;
+	}
+
+	void CapabilitiesCache::LoadPlatforms() {
+		try {
+			std::ifstream i(PlatformCacheFileName_);
+			nlohmann::json cache;
+			i >> cache;
+
+			for (const auto &[Type, Platform] : cache.items()) {
+				Platforms_[Type] = Poco::toLower(to_string(Platform));
+			}
+		} catch (...) {
+		}
+	}
+
+	void CapabilitiesCache::LoadCapabilities() {
+		try {
+			std::ifstream i(CapabilitiesCacheFileName_, std::ios_base::binary | std::ios_base::in);
+			nlohmann::json cache;
+			i >> cache;
+
+			for (const auto &[Type, Caps] : cache.items()) {
+				Capabilities_[Type] = Caps;
+			}
+		} catch (...) {
+		}
+	}
+
+	void CapabilitiesCache::MarkDirty(bool Platforms, bool Capabilities) {
+		{
+			std::lock_guard G(FlushMutex_);
+			PlatformsDirty_ |= Platforms;
+			CapabilitiesDirty_ |= Capabilities;
+		}
+		FlushCondition_.notify_one();
+	}
+
+	bool CapabilitiesCache::WriteFile(const std::string &FileName, const std::string &Content) {
+		//	write next to the target and rename over it, readers never see a partial file
+		auto TempFileName = FileName + ".tmp";
+		try {
+			{
+				std::ofstream o(TempFileName, std::ios_base::trunc | std::ios_base::out |
+												  std::ios_base::binary);
+				o << Content;
+				o.flush();
+				if (!o.good()) {
+					poco_warning(Logger(), fmt::format("Cannot write {}.", TempFileName));
+					return false;
+				}
+			}
+			if (std::rename(TempFileName.c_str(), FileName.c_str()) != 0) {
+				poco_warning(Logger(), fmt::format("Cannot replace {}.", FileName));
+				return false;
+			}
+			++Writes_;
+			BytesWritten_ += Content.size();
+			return true;
+		} catch (...) {
+			poco_warning(Logger(), fmt::format("Exception while writing {}.", FileName));
+		}
+		return false;
+	}
+
+	void CapabilitiesCache::Flush(bool Platforms, bool Capabilities) {
+		std::string PlatformsDoc, CapabilitiesDoc;
+		{
+			std::shared_lock G(Mutex_);
+			if (Platforms)
+				PlatformsDoc = nlohmann::json(Platforms_).dump();
+			if (Capabilities)
+				CapabilitiesDoc = nlohmann::json(Capabilities_).dump();
+		}
+		if (Platforms && !WriteFile(PlatformCacheFileName_, PlatformsDoc))
+			MarkDirty(true, false);
+		if (Capabilities && !WriteFile(CapabilitiesCacheFileName_, CapabilitiesDoc))
+			MarkDirty(false, true);
+	}
+
+	void CapabilitiesCache::run() {
+		Utils::SetThreadName("caps:writer");
+		while (true) {
+			bool Platforms, Capabilities, Stopping;
+			{
+				std::unique_lock Lock(FlushMutex_);
+				FlushCondition_.wait(
+					Lock, [this] { return !Running_ || PlatformsDirty_ || CapabilitiesDirty_; });
+				if (Running_) {
+					//	let the changes of a connection wave accumulate into one write
+					FlushCondition_.wait_for(Lock, std::chrono::milliseconds(FlushDelay_),
+											 [this] { return !Running_; });
+				}
+				Platforms = PlatformsDirty_;
+				Capabilities = CapabilitiesDirty_;
+				PlatformsDirty_ = CapabilitiesDirty_ = false;
+				Stopping = !Running_;
+			}
+
+			if (Platforms || Capabilities)
+				Flush(Platforms, Capabilities);
+
+			if (Stopping)
+				break;
+		}
+	}
+
+} // namespace OpenWifi
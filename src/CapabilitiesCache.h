@@ -4,12 +4,17 @@
 
 #pragma once
 
-#include <fstream>
+#include <condition_variable>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+
 #include "framework/MicroServiceFuncs.h"
+#include "framework/SubSystemServer.h"
 #include "framework/ow_constants.h"
 
 #include "CentralConfig.h"
@@ -21,138 +26,65 @@ namespace OpenWifi {
 
 	typedef std::map<std::string, nlohmann::json> CapabilitiesCache_t;
 
-	class CapabilitiesCache {
+	//	Platform and capabilities per device model. Devices of a model almost always report the same
+	//	capabilities, so Add() compares the raw document first and only parses and marks the cache
+	//	dirty on a real change. A writer thread persists dirty caches after a short delay, so a
+	//	reconnect storm results in a single atomic rewrite of each file.
+	class CapabilitiesCache : public SubSystemServer, Poco::Runnable {
 	  public:
 		static auto instance() {
 			static auto instance = new CapabilitiesCache;
 			return instance;
 		}
 
-		inline void Add(const Config::Capabilities &Caps) {
-			if (Caps.Compatible().empty() || Caps.Platform().empty())
-				return;
-
-			std::lock_guard G(Mutex_);
-			if (!PlatformsLoaded_)
-				LoadPlatforms();
-			auto P = Poco::toLower(Caps.Platform());
-			auto Hint = Platforms_.find(Caps.Compatible());
-			if (Hint == Platforms_.end()) {
-				Platforms_.insert(std::make_pair(Caps.Compatible(), P));
-				SavePlatforms();
-			} else if (Hint->second != P) {
-				Hint->second = P;
-				SavePlatforms();
-			}
-
-			if (!CapabilitiesLoaded_)
-				LoadCapabilities();
-
-			auto CapHint = Capabilities_.find(Caps.Compatible());
-			if (CapHint == Capabilities_.end()) {
-				auto C = nlohmann::json::parse(Caps.AsString());
-				C.erase("restrictions");
-				Capabilities_[Caps.Compatible()] = nlohmann::json::parse(Caps.AsString());
-				SaveCapabilities();
-			} else {
-				CapHint->second = nlohmann::json::parse(Caps.AsString());
-				SaveCapabilities();
-			}
-		}
-
-		inline std::string GetPlatform(const std::string &DeviceType) {
-			std::lock_guard G(Mutex_);
-
-			if (!PlatformsLoaded_) {
-				LoadPlatforms();
-			}
-
-			auto Hint = Platforms_.find(DeviceType);
-			if (Hint == Platforms_.end())
-				return Platforms::AP;
-			return Hint->second;
-		}
-
-		inline nlohmann::json GetCapabilities(const std::string &DeviceType) {
-			std::lock_guard G(Mutex_);
-
-			if (!CapabilitiesLoaded_) {
-				LoadCapabilities();
-			}
+		int Start() override;
+		void Stop() override;
+		void run() final;
 
-			auto Hint = Capabilities_.find(DeviceType);
-			if (Hint == Capabilities_.end())
-				return nlohmann::json{};
-			return Hint->second;
-		}
+		void Add(const Config::Capabilities &Caps);
+		std::string GetPlatform(const std::string &DeviceType);
+		nlohmann::json GetCapabilities(const std::string &DeviceType);
+		CapabilitiesCache_t AllCapabilities();
 
-		inline const CapabilitiesCache_t &AllCapabilities() {
-			std::lock_guard G(Mutex_);
-			if (!CapabilitiesLoaded_) {
-				LoadCapabilities();
-			}
-			return Capabilities_;
+		inline void GetCounters(std::uint64_t &Changes, std::uint64_t &Writes,
+								std::uint64_t &BytesWritten) const {
+			Changes = Changes_;
+			Writes = Writes_;
+			BytesWritten = BytesWritten_;
 		}
 
 	  private:
-		std::recursive_mutex Mutex_;
-		std::atomic_bool PlatformsLoaded_ = false;
-		std::atomic_bool CapabilitiesLoaded_ = false;
+		std::shared_mutex Mutex_;
+		std::atomic_bool Loaded_ = false;
 		std::map<std::string, std::string> Platforms_;
 		CapabilitiesCache_t Capabilities_;
-		std::string PlatformCacheFileName_{MicroServiceDataDirectory() + PlatformCacheFileName};
-		std::string CapabilitiesCacheFileName_{MicroServiceDataDirectory() +
-											   CapabilitiesCacheFileName};
-
-		inline void LoadPlatforms() {
-			try {
-				std::ifstream i(PlatformCacheFileName_);
-				nlohmann::json cache;
-				i >> cache;
-
-				for (const auto &[Type, Platform] : cache.items()) {
-					Platforms_[Type] = Poco::toLower(to_string(Platform));
-				}
-			} catch (...) {
-			}
-			PlatformsLoaded_ = true;
-		}
-
-		inline void SavePlatforms() {
-			try {
-				std::ofstream i(PlatformCacheFileName_);
-				nlohmann::json cache(Platforms_);
-				i << cache;
-			} catch (...) {
-			}
-		}
-
-		inline void LoadCapabilities() {
-			try {
-				std::ifstream i(CapabilitiesCacheFileName_,
-								std::ios_base::binary | std::ios_base::in);
-				nlohmann::json cache;
-				i >> cache;
-
-				for (const auto &[Type, Caps] : cache.items()) {
-					Capabilities_[Type] = Caps;
-				}
-			} catch (...) {
-			}
-			CapabilitiesLoaded_ = true;
-		}
-
-		inline void SaveCapabilities() {
-			try {
-				std::ofstream i(CapabilitiesCacheFileName_,
-								std::ios_base::trunc | std::ios_base::out | std::ios_base::binary);
-				nlohmann::json cache(Capabilities_);
-				i << cache;
-			} catch (...) {
-			}
-		}
+		std::map<std::string, std::string> RawCapabilities_; //	compatible, document as reported
+		std::string PlatformCacheFileName_;		//	set in Start(), once the data directory is known
+		std::string CapabilitiesCacheFileName_;
+
+		std::mutex FlushMutex_;
+		std::condition_variable FlushCondition_;
+		bool PlatformsDirty_ = false;
+		bool CapabilitiesDirty_ = false;
+		bool Running_ = false;
+		Poco::Thread Worker_;
+		std::uint64_t FlushDelay_ = 2000; //	milliseconds
+
+		std::atomic_uint64_t Changes_ = 0;
+		std::atomic_uint64_t Writes_ = 0;
+		std::atomic_uint64_t BytesWritten_ = 0;
+
+		void EnsureLoaded();
+		void LoadPlatforms();
+		void LoadCapabilities();
+		void MarkDirty(bool Platforms, bool Capabilities);
+		void Flush(bool Platforms, bool Capabilities);
+		bool WriteFile(const std::string &FileName, const std::string &Content);
+
+		CapabilitiesCache() noexcept
+			: SubSystemServer("CapabilitiesCache", "CAPS-CACHE", "capabilities.cache") {}
 	};
 
 	inline auto CapabilitiesCache() { return CapabilitiesCache::instance(); };
 
-} // namespace OpenWifi
\ No newline at end of file
+} // namespace OpenWifi
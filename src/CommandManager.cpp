@@ -42,9 +42,10 @@ namespace OpenWifi {
 						if (ID > 1) {
 							poco_debug(Logger(), fmt::format("({}): Processing {} response.",
 															 SerialNumberStr, ID));
-							std::lock_guard Lock(LocalMutex_);
-							auto RPC = OutStandingRequests_.find(ID);
-							if (RPC == OutStandingRequests_.end()) {
+							auto &Shard = ShardFor(Resp->SerialNumber_);
+							std::lock_guard Lock(Shard.Mutex);
+							auto RPC = Shard.Requests.find(ID);
+							if (RPC == Shard.Requests.end()) {
 								poco_debug(Logger(), fmt::format("({}): RPC {} cannot be found.",
 																 SerialNumberStr, ID));
 							} else if (RPC->second.SerialNumber != Resp->SerialNumber_) {
@@ -77,13 +78,15 @@ namespace OpenWifi {
 										TmpRpcEntry = RPC->second.rpc_entry;
 									}
 									RPC->second.State = 0;
-									OutStandingRequests_.erase(ID);
+									EraseRequest(Shard, ID);
 									if (TmpRpcEntry != nullptr)
 										TmpRpcEntry->set_value(Payload);
 								}
 							}
 						}
 					}
+					//	The device may be free for its next queued command.
+					DeviceReady(Resp->SerialNumber_);
 				}
 			} catch (const Poco::Exception &E) {
 				Logger().log(E);
@@ -107,7 +110,7 @@ namespace OpenWifi {
 		}
 		Command.State = 0;
 
-		OutStandingRequests_.erase(Command.Id);
+		EraseRequest(ShardFor(Command.SerialNumber), Command.Id);
 		if (TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
 		return true;
@@ -144,7 +147,7 @@ namespace OpenWifi {
 			TmpRpcEntry = Command.rpc_entry;
 		}
 
-		OutStandingRequests_.erase(Command.Id);
+		EraseRequest(ShardFor(Command.SerialNumber), Command.Id);
 		if (TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
 		return true;
@@ -192,7 +195,7 @@ namespace OpenWifi {
 		}
 
 		if (Command.State == 0) {
-			OutStandingRequests_.erase(Command.Id);
+			EraseRequest(ShardFor(Command.SerialNumber), Command.Id);
 		}
 		if (Reply && TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
@@ -207,8 +210,11 @@ namespace OpenWifi {
 		commandRetry_ = MicroServiceConfigGetInt("command.retry", 120);
 		janitorInterval_ = MicroServiceConfigGetInt("command.janitor", 2 * 60); //	1 hour
 		queueInterval_ = MicroServiceConfigGetInt("command.queue", 30);
+		queueResync_ = MicroServiceConfigGetInt("command.queue.resync", 10 * 60);
 
+		Running_ = true;
 		ManagerThread.start(*this);
+		DispatcherThread_.start(DispatcherAdapter_);
 
 		JanitorCallback_ = std::make_unique<Poco::TimerCallback<CommandManager>>(
 			*this, &CommandManager::onJanitorTimer);
@@ -233,6 +239,8 @@ namespace OpenWifi {
 		ResponseQueue_.wakeUpAll();
 		ManagerThread.wakeUp();
 		ManagerThread.join();
+		QueueCondition_.notify_all();
+		DispatcherThread_.join();
 		poco_notice(Logger(), "Stopped...");
 	}
 
@@ -242,38 +250,123 @@ namespace OpenWifi {
 	}
 
 	void CommandManager::onJanitorTimer([[maybe_unused]] Poco::Timer &timer) {
-		std::lock_guard Lock(LocalMutex_);
 		Utils::SetThreadName("cmd:janitor");
 		Poco::Logger &MyLogger = Poco::Logger::get("CMD-MGR-JANITOR");
 		std::string TimeOutError("No response.");
 
 		auto now = std::chrono::high_resolution_clock::now();
-		for (auto request = OutStandingRequests_.begin(); request != OutStandingRequests_.end();) {
-			std::chrono::duration<double, std::milli> delta = now - request->second.submitted;
-			if (delta > 10min) {
-				MyLogger.debug(fmt::format("{}: Command={} for {} Timed out.", request->second.UUID,
-										   APCommands::to_string(request->second.Command),
-										   Utils::IntToSerialNumber(request->second.SerialNumber)));
-				if ((request->second.Command == APCommands::Commands::script &&
-					 request->second.Deferred) ||
-					(request->second.Command == APCommands::Commands::trace)) {
-					StorageService()->CancelWaitFile(request->second.UUID, TimeOutError);
+		for (auto &Shard : OutStandingRequests_) {
+			std::lock_guard Lock(Shard.Mutex);
+			for (auto request = Shard.Requests.begin(); request != Shard.Requests.end();) {
+				std::chrono::duration<double, std::milli> delta = now - request->second.submitted;
+				if (delta > 10min) {
+					MyLogger.debug(fmt::format("{}: Command={} for {} Timed out.", request->second.UUID,
+											   APCommands::to_string(request->second.Command),
+											   Utils::IntToSerialNumber(request->second.SerialNumber)));
+					if ((request->second.Command == APCommands::Commands::script &&
+						 request->second.Deferred) ||
+						(request->second.Command == APCommands::Commands::trace)) {
+						StorageService()->CancelWaitFile(request->second.UUID, TimeOutError);
+					}
+					StorageService()->SetCommandTimedOut(request->second.UUID);
+					auto Id = request->first;
+					++request;
+					EraseRequest(Shard, Id);
+				} else {
+					++request;
 				}
-				StorageService()->SetCommandTimedOut(request->second.UUID);
-				request = OutStandingRequests_.erase(request);
-			} else {
-				++request;
 			}
 		}
 		poco_information(MyLogger,
-						 fmt::format("Outstanding-requests {}", OutStandingRequests_.size()));
+						 fmt::format("Outstanding-requests {}", OutstandingRequestCount()));
+	}
+
+	void CommandManager::AddRequest(RequestShard &Shard, const CommandInfo &Command) {
+		Shard.Requests[Command.Id] = Command;
+		Shard.BySerialNumber[Command.SerialNumber].insert(Command.Id);
+		if (!Command.UUID.empty()) {
+			auto &UUIDs = ShardFor(Command.UUID);
+			std::lock_guard G(UUIDs.Mutex);
+			UUIDs.ByUUID[Command.UUID] = std::make_pair(Command.SerialNumber, Command.Id);
+		}
+	}
+
+	void CommandManager::EraseRequest(RequestShard &Shard, std::uint64_t Id) {
+		auto Request = Shard.Requests.find(Id);
+		if (Request == Shard.Requests.end())
+			return;
+		auto Device = Shard.BySerialNumber.find(Request->second.SerialNumber);
+		if (Device != Shard.BySerialNumber.end()) {
+			Device->second.erase(Id);
+			if (Device->second.empty())
+				Shard.BySerialNumber.erase(Device);
+		}
+		if (!Request->second.UUID.empty()) {
+			auto &UUIDs = ShardFor(Request->second.UUID);
+			std::lock_guard G(UUIDs.Mutex);
+			auto Hint = UUIDs.ByUUID.find(Request->second.UUID);
+			if (Hint != UUIDs.ByUUID.end() && Hint->second.second == Id)
+				UUIDs.ByUUID.erase(Hint);
+		}
+		Shard.Requests.erase(Request);
+	}
+
+	void CommandManager::RemovePendingCommand(std::uint64_t SerialNumber, std::uint64_t Id) {
+		auto &Shard = ShardFor(SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		EraseRequest(Shard, Id);
+	}
+
+	bool CommandManager::CommandRunningForDevice(std::uint64_t SerialNumber, std::string &uuid,
+												 APCommands::Commands &command) {
+		auto &Shard = ShardFor(SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		auto Device = Shard.BySerialNumber.find(SerialNumber);
+		if (Device == Shard.BySerialNumber.end() || Device->second.empty())
+			return false;
+		const auto &Command = Shard.Requests[*Device->second.begin()];
+		uuid = Command.UUID;
+		command = Command.Command;
+		return true;
+	}
+
+	void CommandManager::ClearQueue(std::uint64_t SerialNumber) {
+		auto &Shard = ShardFor(SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		auto Device = Shard.BySerialNumber.find(SerialNumber);
+		if (Device == Shard.BySerialNumber.end())
+			return;
+		auto Ids = Device->second;
+		for (const auto Id : Ids)
+			EraseRequest(Shard, Id);
+	}
+
+	void CommandManager::RemoveCommand(const std::string &UUID) {
+		std::pair<std::uint64_t, std::uint64_t> Entry;
+		{
+			auto &UUIDs = ShardFor(UUID);
+			std::lock_guard G(UUIDs.Mutex);
+			auto Hint = UUIDs.ByUUID.find(UUID);
+			if (Hint == UUIDs.ByUUID.end())
+				return;
+			Entry = Hint->second;
+		}
+		RemovePendingCommand(Entry.first, Entry.second);
 	}
 
 	bool CommandManager::IsCommandRunning(const std::string &C) {
-		std::lock_guard Lock(LocalMutex_);
-		return std::any_of(
-			OutStandingRequests_.begin(), OutStandingRequests_.end(),
-			[C](const std::pair<std::uint64_t, CommandInfo> &r) { return r.second.UUID == C; });
+		auto &UUIDs = ShardFor(C);
+		std::lock_guard G(UUIDs.Mutex);
+		return UUIDs.ByUUID.find(C) != UUIDs.ByUUID.end();
+	}
+
+	std::uint64_t CommandManager::OutstandingRequestCount() const {
+		std::uint64_t Count = 0;
+		for (auto &Shard : OutStandingRequests_) {
+			std::lock_guard Lock(Shard.Mutex);
+			Count += Shard.Requests.size();
+		}
+		return Count;
 	}
 
 	void CommandManager::onCommandRunnerTimer([[maybe_unused]] Poco::Timer &timer) {
@@ -283,114 +376,38 @@ namespace OpenWifi {
 		poco_trace(MyLogger, "Scheduler starting.");
 
 		try {
-
 			StorageService()->RemovedExpiredCommands();
 			StorageService()->RemoveTimedOutCommands();
 
-			std::uint64_t offset = 0;
-			bool Done = false;
-			while (!Done) {
-				std::vector<GWObjects::CommandDetails> Commands;
-				if (StorageService()->GetReadyToExecuteCommands(offset, 200, Commands)) {
-					if(Commands.empty()) {
-						Done=true;
-						continue;
-					}
-					poco_trace(MyLogger, fmt::format("Scheduler about to process {} commands.",
-													 Commands.size()));
-					for (auto &Cmd : Commands) {
-						if (!Running_) {
-							poco_warning(MyLogger,
-										 "Scheduler quitting because service is stopping.");
-							break;
-						}
-						poco_trace(MyLogger,
-								   fmt::format("{}: Serial={} Command={} Starting processing.",
-											   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-						try {
-
-							//	Skip an already running command
-							if (IsCommandRunning(Cmd.UUID)) {
-								continue;
-							}
-
-							auto now = Utils::Now();
-							// 2 hour timeout for commands
-							if ((now - Cmd.Submitted) > commandTimeOut_) {
-								poco_information(
-									MyLogger, fmt::format("{}: Serial={} Command={} has expired.",
-														  Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandTimedOut(Cmd.UUID);
-								continue;
-							}
-
-							auto SerialNumberInt = Utils::SerialNumberToInt(Cmd.SerialNumber);
-							if (!AP_WS_Server()->Connected(SerialNumberInt)) {
-								poco_trace(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Device is not connected.",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandLastTry(Cmd.UUID);
-								continue;
-							}
-
-							std::string ExecutingUUID;
-							APCommands::Commands ExecutingCommand = APCommands::Commands::unknown;
-							if (CommandRunningForDevice(SerialNumberInt, ExecutingUUID,
-														ExecutingCommand)) {
-								poco_trace(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Device is already busy "
-												"with command {} (Command={}).",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command,
-												ExecutingUUID,
-												APCommands::to_string(ExecutingCommand)));
-								continue;
-							}
-
-							Poco::JSON::Parser P;
-							bool Sent;
-							poco_information(
-								MyLogger,
-								fmt::format("{}: Serial={} Command={} Preparing execution.",
-											Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							auto Params = P.parse(Cmd.Details).extract<Poco::JSON::Object::Ptr>();
-							auto Result = PostCommandDisk(
-								Next_RPC_ID(), APCommands::to_apcommand(Cmd.Command.c_str()),
-								Cmd.SerialNumber, Cmd.Command, *Params, Cmd.UUID, Sent);
-							if (Sent) {
-								StorageService()->SetCommandExecuted(Cmd.UUID);
-								poco_debug(MyLogger,
-										   fmt::format("{}: Serial={} Command={} Sent.", Cmd.UUID,
-													   Cmd.SerialNumber, Cmd.Command));
-							} else {
-								poco_debug(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Re-queued command.",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandLastTry(Cmd.UUID);
-							}
-						} catch (const Poco::Exception &E) {
-							poco_debug(
-								MyLogger,
-								fmt::format(
-									"{}: Serial={} Command={} Failed. Command marked as completed.",
-									Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							MyLogger.log(E);
-							StorageService()->SetCommandExecuted(Cmd.UUID);
-						} catch (...) {
-							poco_debug(MyLogger,
-									   fmt::format("{}: Serial={} Command={} Hard failure. "
-												   "Command marked as completed.",
-												   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							StorageService()->SetCommandExecuted(Cmd.UUID);
-						}
+			//	The DB already marked these as expired, forget them.
+			auto Now = Utils::Now();
+			std::uint64_t Devices, Commands = 0;
+			{
+				std::lock_guard G(QueueMutex_);
+				for (auto Device = Queued_.begin(); Device != Queued_.end();) {
+					auto &Queue = Device->second;
+					Queue.erase(std::remove_if(Queue.begin(), Queue.end(),
+											   [&](const QueuedCommand &C) {
+												   return (Now - C.Submitted) > commandTimeOut_;
+											   }),
+								Queue.end());
+					if (Queue.empty()) {
+						Device = Queued_.erase(Device);
+					} else {
+						Commands += Queue.size();
+						++Device;
 					}
-					offset += Commands.size();
-				} else {
-					Done=true;
-					continue;
 				}
+				Devices = Queued_.size();
+			}
+			poco_information(MyLogger,
+							 fmt::format("Queued commands: {} for {} devices. Dispatched: {} Retried: {}",
+										 Commands, Devices, (std::uint64_t)Dispatched_,
+										 (std::uint64_t)Retried_));
+
+			//	Pick up pending commands written to the DB by someone else.
+			if (queueResync_ && (Now - LastResync_) > queueResync_) {
+				LoadQueuedCommands();
 			}
 		}
 		catch (Poco::Exception &E) {
@@ -402,6 +419,214 @@ namespace OpenWifi {
 		poco_trace(MyLogger, "Scheduler done.");
 	}
 
+	//	The first load reads every pending command. Later ones only read what was submitted since the
+	//	previous load, going back ResyncOverlap seconds for rows another gateway committed late.
+	void CommandManager::LoadQueuedCommands() {
+		std::vector<GWObjects::CommandDetails> Commands;
+		auto Now = Utils::Now();
+		auto Since = LastResync_ > ResyncOverlap ? LastResync_ - ResyncOverlap : 0;
+		if (StorageService()->GetQueuedCommands(Since, Commands)) {
+			LastResync_ = Now;
+			for (const auto &Cmd : Commands) {
+				QueueCommand(Cmd);
+			}
+			poco_information(Logger(), fmt::format("Loaded {} queued commands submitted since {}.",
+												   Commands.size(), Since));
+		}
+	}
+
+	void CommandManager::QueueCommand(const GWObjects::CommandDetails &Cmd) {
+		auto SerialNumberInt = Utils::SerialNumberToInt(Cmd.SerialNumber);
+		QueuedCommand Entry{Cmd.UUID, Cmd.Command, Cmd.Submitted,
+							std::max(Cmd.RunAt, Cmd.lastTry ? Cmd.lastTry + commandRetry_ : 0)};
+		{
+			std::lock_guard G(QueueMutex_);
+			auto &Queue = Queued_[SerialNumberInt];
+			if (std::any_of(Queue.begin(), Queue.end(),
+							[&](const QueuedCommand &C) { return C.UUID == Cmd.UUID; }))
+				return;
+			//	Storage::AddCommand replaces older pending rows of the same command for the device.
+			Queue.erase(std::remove_if(Queue.begin(), Queue.end(),
+									   [&](const QueuedCommand &C) {
+										   return C.Command == Cmd.Command &&
+												  C.Submitted <= Cmd.Submitted;
+									   }),
+						Queue.end());
+			Queue.emplace_back(std::move(Entry));
+		}
+		//	A device that connected before the command was queued will not announce itself again.
+		if (AP_WS_Server()->Connected(SerialNumberInt)) {
+			DeviceReady(SerialNumberInt);
+		}
+	}
+
+	void CommandManager::RemoveQueuedCommand(std::uint64_t SerialNumber, const std::string &UUID) {
+		std::lock_guard G(QueueMutex_);
+		auto Device = Queued_.find(SerialNumber);
+		if (Device == Queued_.end())
+			return;
+		auto &Queue = Device->second;
+		Queue.erase(std::remove_if(Queue.begin(), Queue.end(),
+								   [&](const QueuedCommand &C) { return C.UUID == UUID; }),
+					Queue.end());
+		if (Queue.empty())
+			Queued_.erase(Device);
+	}
+
+	void CommandManager::DeviceReady(std::uint64_t SerialNumber) {
+		{
+			std::lock_guard G(QueueMutex_);
+			if (Queued_.find(SerialNumber) == Queued_.end())
+				return;
+			ReadyDevices_.insert(SerialNumber);
+		}
+		QueueCondition_.notify_one();
+	}
+
+	void CommandManager::ScheduleDevice(std::uint64_t SerialNumber, std::uint64_t When) {
+		std::lock_guard G(QueueMutex_);
+		Deadlines_.emplace(When, SerialNumber);
+	}
+
+	void CommandManager::DispatchQueuedCommands() {
+		Utils::SetThreadName("cmd:dispatch");
+		LoadQueuedCommands();
+
+		while (Running_) {
+			std::set<std::uint64_t> Ready;
+			{
+				std::unique_lock Lock(QueueMutex_);
+				QueueCondition_.wait_for(Lock, 1s, [this] {
+					return !Running_ || !ReadyDevices_.empty();
+				});
+				if (!Running_)
+					break;
+				auto Now = Utils::Now();
+				while (!Deadlines_.empty() && Deadlines_.begin()->first <= Now) {
+					ReadyDevices_.insert(Deadlines_.begin()->second);
+					Deadlines_.erase(Deadlines_.begin());
+				}
+				Ready.swap(ReadyDevices_);
+			}
+			for (const auto SerialNumber : Ready) {
+				if (!Running_)
+					break;
+				try {
+					DispatchDevice(SerialNumber);
+				} catch (const Poco::Exception &E) {
+					Logger().log(E);
+				} catch (...) {
+					poco_warning(Logger(), "Exception occurred during dispatch.");
+				}
+			}
+		}
+		poco_information(Logger(), "Command dispatcher stopping.");
+	}
+
+	//	Sends the oldest due command queued for one device. Devices that are not connected are left
+	//	alone: they will be announced by DeviceReady when they connect.
+	void CommandManager::DispatchDevice(std::uint64_t SerialNumber) {
+		if (!AP_WS_Server()->Connected(SerialNumber))
+			return;
+
+		auto SerialNumberStr = Utils::IntToSerialNumber(SerialNumber);
+		std::string ExecutingUUID;
+		APCommands::Commands ExecutingCommand = APCommands::Commands::unknown;
+		if (CommandRunningForDevice(SerialNumber, ExecutingUUID, ExecutingCommand)) {
+			poco_trace(Logger(), fmt::format("Serial={} Device is already busy with command {} "
+											 "(Command={}).",
+											 SerialNumberStr, ExecutingUUID,
+											 APCommands::to_string(ExecutingCommand)));
+			//	The completion will wake us up, this is only a safety net.
+			ScheduleDevice(SerialNumber, Utils::Now() + queueInterval_);
+			return;
+		}
+
+		auto Now = Utils::Now();
+		QueuedCommand Next;
+		{
+			std::lock_guard G(QueueMutex_);
+			auto Device = Queued_.find(SerialNumber);
+			if (Device == Queued_.end())
+				return;
+			auto Due = std::find_if(Device->second.begin(), Device->second.end(),
+									[Now](const QueuedCommand &C) { return C.NextTry <= Now; });
+			if (Due == Device->second.end()) {
+				auto Earliest = std::min_element(
+					Device->second.begin(), Device->second.end(),
+					[](const QueuedCommand &A, const QueuedCommand &B) { return A.NextTry < B.NextTry; });
+				Deadlines_.emplace(Earliest->NextTry, SerialNumber);
+				return;
+			}
+			Next = *Due;
+		}
+
+		if ((Now - Next.Submitted) > commandTimeOut_) {
+			poco_information(Logger(), fmt::format("{}: Serial={} Command={} has expired.",
+												   Next.UUID, SerialNumberStr, Next.Command));
+			StorageService()->SetCommandTimedOut(Next.UUID);
+			RemoveQueuedCommand(SerialNumber, Next.UUID);
+			DeviceReady(SerialNumber);
+			return;
+		}
+
+		//	The DB is the reference: the command may have been deleted or run elsewhere.
+		GWObjects::CommandDetails Cmd;
+		if (!StorageService()->GetCommand(Next.UUID, Cmd) || Cmd.UUID.empty() || Cmd.Executed != 0) {
+			RemoveQueuedCommand(SerialNumber, Next.UUID);
+			DeviceReady(SerialNumber);
+			return;
+		}
+
+		try {
+			Poco::JSON::Parser P;
+			bool Sent;
+			poco_information(Logger(), fmt::format("{}: Serial={} Command={} Preparing execution.",
+												   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
+			auto Params = P.parse(Cmd.Details).extract<Poco::JSON::Object::Ptr>();
+			auto Result = PostCommandDisk(Next_RPC_ID(), APCommands::to_apcommand(Cmd.Command.c_str()),
+										  Cmd.SerialNumber, Cmd.Command, *Params, Cmd.UUID, Sent);
+			if (Sent) {
+				StorageService()->SetCommandExecuted(Cmd.UUID);
+				RemoveQueuedCommand(SerialNumber, Cmd.UUID);
+				++Dispatched_;
+				poco_debug(Logger(), fmt::format("{}: Serial={} Command={} Sent.", Cmd.UUID,
+												 Cmd.SerialNumber, Cmd.Command));
+			} else {
+				poco_debug(Logger(), fmt::format("{}: Serial={} Command={} Re-queued command.",
+												 Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
+				StorageService()->SetCommandLastTry(Cmd.UUID);
+				{
+					std::lock_guard G(QueueMutex_);
+					auto Device = Queued_.find(SerialNumber);
+					if (Device != Queued_.end()) {
+						for (auto &C : Device->second) {
+							if (C.UUID == Cmd.UUID)
+								C.NextTry = Now + commandRetry_;
+						}
+					}
+					Deadlines_.emplace(Now + commandRetry_, SerialNumber);
+				}
+				++Retried_;
+			}
+		} catch (const Poco::Exception &E) {
+			poco_debug(Logger(),
+					   fmt::format("{}: Serial={} Command={} Failed. Command marked as completed.",
+								   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
+			Logger().log(E);
+			StorageService()->SetCommandExecuted(Cmd.UUID);
+			RemoveQueuedCommand(SerialNumber, Cmd.UUID);
+			DeviceReady(SerialNumber);
+		} catch (...) {
+			poco_debug(Logger(), fmt::format("{}: Serial={} Command={} Hard failure. "
+											 "Command marked as completed.",
+											 Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
+			StorageService()->SetCommandExecuted(Cmd.UUID);
+			RemoveQueuedCommand(SerialNumber, Cmd.UUID);
+			DeviceReady(SerialNumber);
+		}
+	}
+
 	std::shared_ptr<CommandManager::promise_type_t> CommandManager::PostCommand(
 		uint64_t RPC_ID, APCommands::Commands Command, const std::string &SerialNumber,
 		const std::string &CommandStr, const Poco::JSON::Object &Params, const std::string &UUID,
@@ -437,16 +662,16 @@ namespace OpenWifi {
 		//	Do not change the order. It is possible that an RPC completes before it is entered in
 		// the map. So we insert it 	first, even if we may need to remove it later upon failure.
 		if (!oneway_rpc) {
-			std::lock_guard M(Mutex_);
-			OutStandingRequests_[RPC_ID] = CInfo;
+			auto &Shard = ShardFor(SerialNumberInt);
+			std::lock_guard Lock(Shard.Mutex);
+			AddRequest(Shard, CInfo);
 		}
 		if (AP_WS_Server()->SendFrame(SerialNumber, ToSend.str())) {
 			poco_debug(Logger(), fmt::format("{}: Sent command. ID: {}", UUID, RPC_ID));
 			Sent = true;
 			return CInfo.rpc_entry;
 		} else if (!oneway_rpc) {
-			std::lock_guard M(Mutex_);
-			OutStandingRequests_.erase(RPC_ID);
+			RemovePendingCommand(SerialNumberInt, RPC_ID);
 		}
 
 		poco_warning(Logger(), fmt::format("{}: Failed to send command. ID: {}", UUID, RPC_ID));
@@ -8,11 +8,16 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <map>
 #include <mutex>
+#include <set>
+#include <unordered_map>
 #include <utility>
 
 #include "Poco/JSON/Object.h"
@@ -20,6 +25,7 @@
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Notification.h"
 #include "Poco/NotificationQueue.h"
+#include "Poco/RunnableAdapter.h"
 #include "Poco/Timer.h"
 
 #include "fmt/format.h"
@@ -109,6 +115,14 @@ namespace OpenWifi {
 
 		void run() override;
 
+		//	Pending commands live in the DB (the durable log) and in an in-memory queue indexed by
+		//	serial number. A device's queue is dispatched when it connects, when its previous
+		//	command completes, or when a retry deadline expires. Whoever stores a pending command
+		//	queues it here.
+		void QueueCommand(const GWObjects::CommandDetails &Cmd);
+		void DeviceReady(std::uint64_t SerialNumber);
+		void DispatchQueuedCommands();
+
 		static auto instance() {
 			static auto instance_ = new CommandManager;
 			return instance_;
@@ -119,45 +133,12 @@ namespace OpenWifi {
 		void onCommandRunnerTimer(Poco::Timer &timer);
 		inline uint64_t Next_RPC_ID() { return ++Id_; }
 
-		void RemovePendingCommand(std::uint64_t Id) {
-			std::unique_lock Lock(LocalMutex_);
-			OutStandingRequests_.erase(Id);
-		}
-
-		inline bool CommandRunningForDevice(std::uint64_t SerialNumber, std::string &uuid,
-											APCommands::Commands &command) {
-			std::lock_guard Lock(LocalMutex_);
-
-			for (const auto &[Request, Command] : OutStandingRequests_) {
-				if (Command.SerialNumber == SerialNumber) {
-					uuid = Command.UUID;
-					command = Command.Command;
-					return true;
-				}
-			}
-			return false;
-		}
-
-		inline void ClearQueue(std::uint64_t SerialNumber) {
-			std::lock_guard Lock(LocalMutex_);
-			for (auto Request = OutStandingRequests_.begin();
-				 Request != OutStandingRequests_.end();) {
-				if (Request->second.SerialNumber == SerialNumber)
-					Request = OutStandingRequests_.erase(Request);
-				else
-					++Request;
-			}
-		}
-
-		inline void RemoveCommand(const std::string &UUID) {
-			std::lock_guard Lock(LocalMutex_);
-			for (const auto &[Id, Cmd] : OutStandingRequests_) {
-				if (Cmd.UUID == UUID) {
-					OutStandingRequests_.erase(Id);
-					return;
-				}
-			}
-		}
+		void RemovePendingCommand(std::uint64_t SerialNumber, std::uint64_t Id);
+		bool CommandRunningForDevice(std::uint64_t SerialNumber, std::string &uuid,
+									 APCommands::Commands &command);
+		void ClearQueue(std::uint64_t SerialNumber);
+		void RemoveCommand(const std::string &UUID);
+		std::uint64_t OutstandingRequestCount() const;
 
 		inline auto CommandTimeout() const { return commandTimeOut_; }
 		inline auto CommandRetry() const { return commandRetry_; }
@@ -165,11 +146,35 @@ namespace OpenWifi {
 		bool FireAndForget(const std::string &SerialNumber, const std::string &Method,
 						   const Poco::JSON::Object &Params);
 	  private:
-		mutable std::mutex LocalMutex_;
+		//	Outstanding RPCs are sharded by serial number, so everything about one device is in
+		//	one shard. The UUID index has its own shards and is only ever locked alone or while
+		//	holding a request shard (request shard first).
+		static constexpr std::size_t RequestShards = 32;
+		struct RequestShard {
+			mutable std::mutex Mutex;
+			std::map<std::uint64_t, CommandInfo> Requests;						//	RPC id
+			std::map<std::uint64_t, std::set<std::uint64_t>> BySerialNumber;	//	serial -> RPC ids
+		};
+		struct UUIDShard {
+			std::mutex Mutex;
+			std::unordered_map<std::string, std::pair<std::uint64_t, std::uint64_t>> ByUUID; //	serial, RPC id
+		};
+
 		std::atomic_bool Running_ = false;
 		Poco::Thread ManagerThread;
 		std::atomic_uint64_t Id_ = 3; //	do not start @1. We ignore ID=1 & 0 is illegal..
-		std::map<std::uint64_t, CommandInfo> OutStandingRequests_;
+		std::array<RequestShard, RequestShards> OutStandingRequests_;
+		std::array<UUIDShard, RequestShards> RequestsByUUID_;
+
+		inline RequestShard &ShardFor(std::uint64_t SerialNumber) {
+			return OutStandingRequests_[(SerialNumber ^ (SerialNumber >> 24)) % RequestShards];
+		}
+		inline UUIDShard &ShardFor(const std::string &UUID) {
+			return RequestsByUUID_[std::hash<std::string>{}(UUID) % RequestShards];
+		}
+		//	Caller holds Shard.Mutex.
+		void AddRequest(RequestShard &Shard, const CommandInfo &Command);
+		void EraseRequest(RequestShard &Shard, std::uint64_t Id);
 		Poco::Timer JanitorTimer_;
 		std::unique_ptr<Poco::TimerCallback<CommandManager>> JanitorCallback_;
 		Poco::Timer CommandRunnerTimer_;
@@ -179,6 +184,31 @@ namespace OpenWifi {
 		std::uint64_t commandRetry_ = 0;
 		std::uint64_t janitorInterval_ = 0;
 		std::uint64_t queueInterval_ = 0;
+		std::uint64_t queueResync_ = 0;
+
+		struct QueuedCommand {
+			std::string UUID;
+			std::string Command;
+			std::uint64_t Submitted = 0;
+			std::uint64_t NextTry = 0;
+		};
+
+		std::mutex QueueMutex_;
+		std::condition_variable QueueCondition_;
+		std::map<std::uint64_t, std::deque<QueuedCommand>> Queued_;
+		std::multimap<std::uint64_t, std::uint64_t> Deadlines_;
+		std::set<std::uint64_t> ReadyDevices_;
+		Poco::Thread DispatcherThread_;
+		Poco::RunnableAdapter<CommandManager> DispatcherAdapter_{*this, &CommandManager::DispatchQueuedCommands};
+		std::atomic_uint64_t LastResync_ = 0;
+		static constexpr std::uint64_t ResyncOverlap = 60;	//	seconds
+		std::atomic_uint64_t Dispatched_ = 0;
+		std::atomic_uint64_t Retried_ = 0;
+
+		void LoadQueuedCommands();
+		void DispatchDevice(std::uint64_t SerialNumber);
+		void RemoveQueuedCommand(std::uint64_t SerialNumber, const std::string &UUID);
+		void ScheduleDevice(std::uint64_t SerialNumber, std::uint64_t When);
 
 		std::shared_ptr<promise_type_t>
 		PostCommand(uint64_t RPCID, APCommands::Commands Command, const std::string &SerialNumber,
@@ -0,0 +1,127 @@
+#include "ConnectStage.h"
+#include "StorageService.h"
+
+#include <fmt/format.h>
+#include <framework/MicroServiceFuncs.h>
+#include <framework/utils.h>
+
+namespace OpenWifi {
+
+	int ConnectStage::Start() {
+		poco_information(Logger(), "Starting...");
+		auto NumberOfWorkers = MicroServiceConfigGetInt("openwifi.connect.workers", 4);
+		MaxQueued_ = MicroServiceConfigGetInt("openwifi.connect.maxqueue", 10000);
+		if (NumberOfWorkers == 0)
+			NumberOfWorkers = 1;
+		if (MaxQueued_ == 0)
+			MaxQueued_ = 1;
+
+		Running_ = true;
+		for (std::uint64_t i = 0; i < NumberOfWorkers; ++i) {
+			Workers_.emplace_back(std::make_unique<Worker>(*this, i));
+			Workers_.back()->Thread_.start(*Workers_.back());
+		}
+		return 0;
+	}
+
+	void ConnectStage::Stop() {
+		poco_information(Logger(), "Stopping...");
+		for (auto &W : Workers_) {
+			{
+				std::lock_guard G(W->Mutex_);
+				Running_ = false;
+			}
+			W->Condition_.notify_all();
+		}
+		for (auto &W : Workers_) {
+			W->Thread_.join();
+		}
+		Workers_.clear();
+		auto C = GetCounters();
+		poco_information(Logger(), fmt::format("Stopped... Processed={} Overflow={} Failed={} "
+											   "AverageLatency={}us MaxLatency={}us",
+											   C.Processed, C.Overflow, C.Failed,
+											   C.AverageLatency, C.MaxLatency));
+	}
+
+	bool ConnectStage::Submit(std::uint64_t SerialNumber, Work W) {
+		if (Workers_.empty())
+			return false;
+		auto &Target = *Workers_[SerialNumber % Workers_.size()];
+		{
+			std::lock_guard G(Target.Mutex_);
+			if (!Running_ || Target.Jobs_.size() >= MaxQueued_) {
+				++Overflow_;
+				return false;
+			}
+			Target.Jobs_.emplace_back(Job{.W = std::move(W), .Submitted = Clock::now()});
+		}
+		Target.Condition_.notify_one();
+		return true;
+	}
+
+	ConnectStage::Counters ConnectStage::GetCounters() {
+		Counters C;
+		for (auto &W : Workers_) {
+			std::lock_guard G(W->Mutex_);
+			C.Queued += W->Jobs_.size();
+		}
+		C.Processed = Processed_;
+		C.Overflow = Overflow_;
+		C.Failed = Failed_;
+		C.AverageLatency = C.Processed ? (TotalLatency_ / C.Processed) : 0;
+		C.MaxLatency = MaxLatency_;
+		return C;
+	}
+
+	void ConnectStage::Execute(Poco::Data::Session &Session, Job &J) {
+		try {
+			J.W(Session);
+		} catch (const Poco::Exception &E) {
+			++Failed_;
+			Logger().log(E);
+		} catch (const std::exception &E) {
+			++Failed_;
+			poco_warning(Logger(), fmt::format("Exception during connect processing: {}", E.what()));
+		} catch (...) {
+			++Failed_;
+			poco_warning(Logger(), "Exception during connect processing.");
+		}
+
+		std::uint64_t Latency = std::chrono::duration_cast<std::chrono::microseconds>(
+									Clock::now() - J.Submitted)
+									.count();
+		TotalLatency_ += Latency;
+		++Processed_;
+		auto Max = MaxLatency_.load();
+		while (Latency > Max && !MaxLatency_.compare_exchange_weak(Max, Latency)) {
+		}
+	}
+
+	void ConnectStage::Worker::run() {
+		Utils::SetThreadName(fmt::format("connect:{}", Id_).c_str());
+
+		std::deque<Job> Batch;
+		while (true) {
+			{
+				std::unique_lock Lock(Mutex_);
+				Condition_.wait(Lock, [this] { return !Stage_.Running_ || !Jobs_.empty(); });
+				if (Jobs_.empty())
+					break;
+				Batch.swap(Jobs_);
+			}
+
+			try {
+				Poco::Data::Session Session(StorageService()->Pool().get());
+				for (auto &J : Batch) {
+					Stage_.Execute(Session, J);
+				}
+			} catch (const Poco::Exception &E) {
+				Stage_.Failed_ += Batch.size();
+				Stage_.Logger().log(E);
+			}
+			Batch.clear();
+		}
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Poco/Data/Session.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <framework/SubSystemServer.h>
+
+namespace OpenWifi {
+
+	//	Database work done when a device connects. Reactors hand it to this stage and keep serving
+	//	the other devices. A device always lands on the same worker, so its jobs run in order.
+	class ConnectStage : public SubSystemServer {
+	  public:
+		using Work = std::function<void(Poco::Data::Session &Session)>;
+
+		struct Counters {
+			std::uint64_t Queued = 0;
+			std::uint64_t Processed = 0;
+			std::uint64_t Overflow = 0;
+			std::uint64_t Failed = 0;
+			std::uint64_t AverageLatency = 0; 	//	microseconds, from submission to completion
+			std::uint64_t MaxLatency = 0; 		//	microseconds
+		};
+
+		static auto instance() {
+			static auto instance_ = new ConnectStage;
+			return instance_;
+		}
+
+		int Start() override;
+		void Stop() override;
+
+		//	Returns false when the stage is stopped or the worker queue is full: the caller then turns
+		//	the device away rather than doing the work on its own thread.
+		bool Submit(std::uint64_t SerialNumber, Work W);
+		Counters GetCounters();
+
+	  private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Job {
+			Work 				W;
+			Clock::time_point 	Submitted;
+		};
+
+		struct Worker : public Poco::Runnable {
+			explicit Worker(ConnectStage &Stage, std::size_t Id) : Stage_(Stage), Id_(Id) {}
+			void run() final;
+
+			ConnectStage 			&Stage_;
+			std::size_t 			Id_;
+			std::mutex 				Mutex_;
+			std::condition_variable Condition_;
+			std::deque<Job> 		Jobs_;
+			Poco::Thread 			Thread_;
+		};
+
+		std::vector<std::unique_ptr<Worker>> Workers_;
+		std::atomic_bool 					Running_ = false;
+		std::uint64_t 						MaxQueued_ = 10000;
+
+		std::atomic_uint64_t 				Processed_ = 0;
+		std::atomic_uint64_t 				Overflow_ = 0;
+		std::atomic_uint64_t 				Failed_ = 0;
+		std::atomic_uint64_t 				TotalLatency_ = 0;
+		std::atomic_uint64_t 				MaxLatency_ = 0;
+
+		void Execute(Poco::Data::Session &Session, Job &J);
+
+		ConnectStage() noexcept
+			: SubSystemServer("ConnectStage", "CONNECT-STAGE", "openwifi.connect") {}
+	};
+
+	inline auto ConnectStage() { return ConnectStage::instance(); }
+
+} // namespace OpenWifi
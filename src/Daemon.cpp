@@ -16,6 +16,8 @@
 #include <framework/default_device_types.h>
 
 #include "AP_WS_Server.h"
+#include "CapabilitiesCache.h"
+#include "ConnectStage.h"
 #include "CommandManager.h"
 #include "Daemon.h"
 #include "FileUploader.h"
@@ -27,6 +29,7 @@
 #include "ScriptManager.h"
 #include "SerialNumberCache.h"
 #include "SignatureMgr.h"
+#include "StatsWriter.h"
 #include "StorageArchiver.h"
 #include "StorageService.h"
 #include "TelemetryStream.h"
@@ -42,11 +45,11 @@ namespace OpenWifi {
 		static Daemon instance(
 			vDAEMON_PROPERTIES_FILENAME, vDAEMON_ROOT_ENV_VAR, vDAEMON_CONFIG_ENV_VAR,
 			vDAEMON_APP_NAME, vDAEMON_BUS_TIMER,
-			SubSystemVec{GenericScheduler(), StorageService(), SerialNumberCache(), ConfigurationValidator(),
+			SubSystemVec{GenericScheduler(), StorageService(), StatsWriter(), CapabilitiesCache(), SerialNumberCache(), ConfigurationValidator(),
 				UI_WebSocketClientServer(), OUIServer(), FindCountryFromIP(),
 				CommandManager(), FileUploader(), StorageArchiver(), TelemetryStream(),
 				RTTYS_server(), RADIUS_proxy_server(), VenueBroadcaster(), ScriptManager(),
-				SignatureManager(), AP_WS_Server(),
+				SignatureManager(), ConnectStage(), AP_WS_Server(),
 				RegulatoryInfo(),
 				RADIUSSessionTracker(),
 			 	AP_WS_ConfigAutoUpgradeAgent(),
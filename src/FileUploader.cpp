@@ -6,12 +6,15 @@
 //	Arilia Wireless Inc.
 //
 
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "Poco/CountingStream.h"
 #include "Poco/DynamicAny.h"
 #include "Poco/Exception.h"
 #include "Poco/File.h"
+#include "Poco/Path.h"
 #include "Poco/Net/HTTPServerParams.h"
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Net/MessageHeader.h"
@@ -19,6 +22,7 @@
 #include "Poco/Net/PartHandler.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/StringTokenizer.h"
+#include "Poco/TemporaryFile.h"
 
 #include "framework/MicroServiceFuncs.h"
 #include "framework/ow_constants.h"
@@ -31,18 +35,70 @@
 namespace OpenWifi {
 
 	static const std::string URI_BASE{"/v1/upload/"};
+	static const std::string SPOOL_EXTENSION{".part"};
+
+	//	Copies the upload to disk in fixed size chunks, so memory use does not depend on the size
+	//	of the file. Returns false as soon as the upload goes over Limit.
+	static bool SpoolUpload(std::istream &In, std::ostream &Out, std::uint64_t Limit,
+							std::uint64_t &Size) {
+		std::vector<char> Buffer(64 * 1024);
+		Size = 0;
+		while (In) {
+			In.read(Buffer.data(), (std::streamsize)Buffer.size());
+			auto Count = In.gcount();
+			if (Count <= 0)
+				break;
+			Size += Count;
+			if (Size > Limit)
+				return false;
+			Out.write(Buffer.data(), Count);
+			if (!Out)
+				throw Poco::WriteFileException("Cannot write upload spool file");
+		}
+		return true;
+	}
 
 	int FileUploader::Start() {
 		poco_notice(Logger(), "Starting.");
 
-		Poco::File UploadsDir(MicroServiceConfigPath("openwifi.fileuploader.path", "/tmp"));
-		Path_ = UploadsDir.path();
-		if (!UploadsDir.exists()) {
+		//	Without a configured directory, uploads are kept in the database, which any gateway
+		//	sharing it can serve. A configured directory holds files until their command is deleted
+		//	or archived, so it must survive restarts and be shared by those gateways.
+		Path_ = MicroServiceConfigPath("openwifi.fileuploader.path", "");
+		if (Path_.empty()) {
+			poco_information(Logger(), "No upload directory configured: uploaded files will be kept "
+									   "in the database.");
+		} else {
+			Poco::File UploadsDir(Path_);
+			Path_ = UploadsDir.path();
+			try {
+				UploadsDir.createDirectories();
+				if (!UploadsDir.canWrite())
+					throw Poco::FileAccessDeniedException(Path_);
+				poco_warning(Logger(),
+							 fmt::format("Uploaded files are kept in {}. Every gateway using the same "
+										 "database must share this directory.",
+										 Path_));
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
+				poco_warning(Logger(), fmt::format("Upload directory {} cannot be used: uploaded "
+												   "files will be kept in the database.",
+												   Path_));
+				Path_.clear();
+			}
+		}
+
+		//	Uploads interrupted by a restart.
+		if (!Path_.empty()) {
 			try {
-				UploadsDir.createDirectory();
+				std::vector<Poco::File> Files;
+				Poco::File(Path_).list(Files);
+				for (auto &File : Files) {
+					if (Poco::Path(File.path()).getFileName().ends_with(SPOOL_EXTENSION))
+						File.remove();
+				}
 			} catch (const Poco::Exception &E) {
 				Logger().log(E);
-				Path_ = "/tmp";
 			}
 		}
 
@@ -218,13 +274,52 @@ namespace OpenWifi {
 
 							const auto PartContentType = Hdr.get("Content-Type", "");
 							if (PartContentType == "application/octet-stream") {
-								std::stringstream FileContent;
-								Poco::StreamCopier::copyStream(Reader.stream(), FileContent);
+								//	The UUID was issued by us and validated by the factory, so it
+								//	is safe as a file name. Without an upload directory, the file
+								//	is spooled to a temporary file and then kept in the database.
+								bool InDatabase = FileUploader()->Path().empty();
+								Poco::TemporaryFile Temporary;
+								Poco::Path FilePath(FileUploader()->Path(), UUID_);
+								Poco::Path SpoolPath =
+									InDatabase ? Poco::Path(Temporary.path())
+											   : Poco::Path(FileUploader()->Path(),
+															UUID_ + SPOOL_EXTENSION);
+								std::uint64_t Size = 0;
+								bool Complete = false;
+								{
+									std::ofstream Spool(SpoolPath.toString(),
+														std::ios::binary | std::ios::trunc);
+									if (!Spool)
+										throw Poco::CreateFileException(SpoolPath.toString());
+									Complete = SpoolUpload(Reader.stream(), Spool,
+														   FileUploader()->MaxSize(), Size);
+								}
+								if (!Complete) {
+									poco_warning(Logger(), fmt::format("File {} is too large.", UUID_));
+									Poco::File(SpoolPath).remove();
+									break;
+								}
+								if (InDatabase) {
+									std::string Content;
+									{
+										std::ifstream In(SpoolPath.toString(), std::ios::binary);
+										Poco::StreamCopier::copyToString(In, Content);
+									}
+									if (!StorageService()->AttachFileContentToCommand(UUID_, Content,
+																					  Type_)) {
+										break;
+									}
+								} else {
+									Poco::File(SpoolPath).renameTo(FilePath.toString());
+									if (!StorageService()->AttachFileDataToCommand(UUID_, UUID_, Size,
+																				   Type_)) {
+										Poco::File(FilePath).remove();
+										break;
+									}
+								}
 								Answer.set("filename", UUID_);
 								Answer.set("error", 0);
 								poco_debug(Logger(), fmt::format("{}: File uploaded.", UUID_));
-								StorageService()->AttachFileDataToCommand(UUID_, FileContent,
-																		  Type_);
 								std::ostream &ResponseStream = Response.send();
 								Poco::JSON::Stringifier::stringify(Answer, ResponseStream);
 								return;
@@ -245,6 +340,12 @@ namespace OpenWifi {
 			}
 
 			poco_debug(Logger(), fmt::format("{}: Failed to upload a file.", UUID_));
+			if (!FileUploader()->Path().empty()) {
+				try {
+					Poco::File(Poco::Path(FileUploader()->Path(), UUID_ + SPOOL_EXTENSION)).remove();
+				} catch (...) {
+				}
+			}
 			std::string Error{"File rejected"};
 			StorageService()->CancelWaitFile(UUID_, Error);
 			Answer.set("filename", UUID_);
@@ -4,11 +4,27 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 #include "Poco/Net/IPAddress.h"
+#include "Poco/Runnable.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/Thread.h"
 
 #include "framework/MicroServiceFuncs.h"
 #include "framework/SubSystemServer.h"
+#include "framework/utils.h"
 
+#include "fmt/format.h"
 #include "nlohmann/json.hpp"
 
 namespace OpenWifi {
@@ -18,6 +34,15 @@ namespace OpenWifi {
 		virtual bool Init() = 0;
 		virtual Poco::URI URI(const std::string &IPAddress) = 0;
 		virtual std::string Country(const std::string &Response) = 0;
+		//	Local providers answer from memory and never need the worker threads.
+		[[nodiscard]] virtual bool IsLocal() const { return false; }
+		virtual std::string Lookup(const std::string &IPAddress) {
+			std::string Response;
+			if (Utils::wgets(URI(IPAddress).toString(), Response)) {
+				return Country(Response);
+			}
+			return "";
+		}
 		virtual ~IPToCountryProvider(){};
 	};
 
@@ -113,6 +138,94 @@ namespace OpenWifi {
 		std::string Key_;
 	};
 
+	//	Offline database: one "cidr,country" entry per line, '#' starts a comment.
+	class IPToCountryFile : public IPToCountryProvider {
+	  public:
+		static std::string Name() { return "file"; }
+		inline bool Init() override {
+			auto FileName = MicroServiceConfigPath("iptocountry.file.path", "");
+			if (FileName.empty())
+				return false;
+			std::ifstream Input(FileName);
+			std::string Line;
+			while (std::getline(Input, Line)) {
+				Poco::trimInPlace(Line);
+				if (Line.empty() || Line[0] == '#')
+					continue;
+				Poco::StringTokenizer Tokens(Line, ",", Poco::StringTokenizer::TOK_TRIM);
+				if (Tokens.count() < 2)
+					continue;
+				AddRange(Tokens[0], Poco::toUpper(Tokens[1]));
+			}
+			return !V4Ranges_.empty() || !V6Ranges_.empty();
+		}
+
+		[[nodiscard]] inline Poco::URI URI([[maybe_unused]] const std::string &IPAddress) override {
+			return Poco::URI{};
+		}
+
+		inline std::string Country(const std::string &Response) override { return Response; }
+
+		[[nodiscard]] inline bool IsLocal() const override { return true; }
+
+		inline std::string Lookup(const std::string &IPAddress) override {
+			Poco::Net::IPAddress IP;
+			if (!Poco::Net::IPAddress::tryParse(IPAddress, IP))
+				return "";
+			//	Most specific prefix first, so a range carved out of a larger one wins.
+			if (IP.family() == Poco::Net::IPAddress::IPv4) {
+				auto Address = ntohl(static_cast<const in_addr *>(IP.addr())->s_addr);
+				for (const auto &[Bits, Networks] : V4Ranges_) {
+					auto Hint = Networks.find(Address & V4Mask(Bits));
+					if (Hint != Networks.end())
+						return Hint->second;
+				}
+				return "";
+			}
+			const auto *Address = static_cast<const std::uint8_t *>(IP.addr());
+			for (const auto &[Bits, Networks] : V6Ranges_) {
+				auto Hint = Networks.find(V6Network(Address, Bits));
+				if (Hint != Networks.end())
+					return Hint->second;
+			}
+			return "";
+		}
+
+	  private:
+		//	prefix length, longest first -> (masked network -> country)
+		std::map<int, std::unordered_map<std::uint32_t, std::string>, std::greater<>> V4Ranges_;
+		std::map<int, std::unordered_map<std::string, std::string>, std::greater<>> V6Ranges_;
+
+		static inline std::uint32_t V4Mask(int Bits) {
+			return Bits == 0 ? 0 : (0xFFFFFFFFu << (32 - Bits));
+		}
+
+		static inline std::string V6Network(const std::uint8_t *Address, int Bits) {
+			std::string Network(reinterpret_cast<const char *>(Address), 16);
+			for (int i = 0; i < 16; ++i) {
+				auto Keep = std::clamp(Bits - i * 8, 0, 8);
+				Network[i] = (char)(Network[i] & (0xFF00 >> Keep));
+			}
+			return Network;
+		}
+
+		inline void AddRange(const std::string &Range, const std::string &Country) {
+			Poco::StringTokenizer Tokens(Range, "/", Poco::StringTokenizer::TOK_TRIM);
+			Poco::Net::IPAddress Network;
+			if (!Poco::Net::IPAddress::tryParse(Tokens[0], Network))
+				return;
+			if (Network.family() == Poco::Net::IPAddress::IPv4) {
+				auto Bits = Tokens.count() == 2 ? std::clamp(std::atoi(Tokens[1].c_str()), 0, 32) : 32;
+				auto Start = ntohl(static_cast<const in_addr *>(Network.addr())->s_addr);
+				V4Ranges_[Bits][Start & V4Mask(Bits)] = Country;
+			} else {
+				auto Bits = Tokens.count() == 2 ? std::clamp(std::atoi(Tokens[1].c_str()), 0, 128) : 128;
+				V6Ranges_[Bits][V6Network(static_cast<const std::uint8_t *>(Network.addr()), Bits)] =
+					Country;
+			}
+		}
+	};
+
 	template <typename BaseClass, typename T, typename... Args>
 	std::unique_ptr<BaseClass> IPLocationProvider(const std::string &RequestProvider) {
 		if (T::Name() == RequestProvider) {
@@ -125,8 +238,13 @@ namespace OpenWifi {
 		}
 	}
 
-	class FindCountryFromIP : public SubSystemServer {
+	//	Lookups are answered from an LRU cache. On a miss, the non-blocking Get returns the default
+	//	country right away and a small worker pool resolves the address, coalescing concurrent
+	//	requests for the same key, then calls back with the real value.
+	class FindCountryFromIP : public SubSystemServer, Poco::Runnable {
 	  public:
+		using ResolvedCallback = std::function<void(const std::string &Country)>;
+
 		static auto instance() {
 			static auto instance_ = new FindCountryFromIP;
 			return instance_;
@@ -136,20 +254,43 @@ namespace OpenWifi {
 			poco_notice(Logger(), "Starting...");
 			ProviderName_ = MicroServiceConfigGetString("iptocountry.provider", "");
 			if (!ProviderName_.empty()) {
-				Provider_ = IPLocationProvider<IPToCountryProvider, IPInfo, IPData, IP2Location>(
-					ProviderName_);
+				Provider_ = IPLocationProvider<IPToCountryProvider, IPInfo, IPData, IP2Location,
+											   IPToCountryFile>(ProviderName_);
 				if (Provider_ != nullptr) {
 					Enabled_ = Provider_->Init();
 				}
 			}
 			Default_ = MicroServiceConfigGetString("iptocountry.default", "US");
+			CacheSize_ = MicroServiceConfigGetInt("iptocountry.cache.size", 100000);
+			CacheTTL_ = MicroServiceConfigGetInt("iptocountry.cache.ttl", 24 * 60 * 60);
+			PrefixKeys_ = MicroServiceConfigGetBool("iptocountry.cache.prefix", true);
+			MaxPending_ = MicroServiceConfigGetInt("iptocountry.queue.max", 10000);
+
+			if (Enabled_ && !Provider_->IsLocal()) {
+				Running_ = true;
+				auto NumberOfWorkers = std::max<std::uint64_t>(
+					1, MicroServiceConfigGetInt("iptocountry.workers", 4));
+				for (std::uint64_t i = 0; i < NumberOfWorkers; ++i) {
+					Workers_.emplace_back(std::make_unique<Poco::Thread>());
+					Workers_.back()->start(*this);
+				}
+			}
 			return 0;
 		}
 
 		inline void Stop() final {
 			poco_notice(Logger(), "Stopping...");
-			//	Nothing to do - just to provide the same look at the others.
-			poco_notice(Logger(), "Stopped...");
+			{
+				std::lock_guard G(QueueMutex_);
+				Running_ = false;
+			}
+			QueueCondition_.notify_all();
+			for (auto &Worker : Workers_)
+				Worker->join();
+			Workers_.clear();
+			poco_notice(Logger(),
+						fmt::format("Stopped... Hits={} Misses={} Dropped={}", (std::uint64_t)Hits_,
+									(std::uint64_t)Misses_, (std::uint64_t)Dropped_));
 		}
 
 		[[nodiscard]] static inline std::string ReformatAddress(const std::string &I) {
@@ -166,30 +307,200 @@ namespace OpenWifi {
 			return Get(ReformatAddress(IP.toString()));
 		}
 
+		//	Blocking lookup, still served from the cache when possible.
 		inline std::string Get(const std::string &IP) {
 			if (!Enabled_)
 				return Default_;
-			try {
-				std::string URL = Provider_->URI(IP).toString();
-				std::string Response;
-				if (Utils::wgets(URL, Response)) {
-					auto Answer = Provider_->Country(Response);
-					if (!Answer.empty())
-						return Answer;
+			std::string Answer;
+			auto Key = CacheKey(IP);
+			if (CacheGet(Key, Answer))
+				return Answer;
+			Answer = Resolve(IP);
+			if (Answer.empty())
+				return Default_;
+			CachePut(Key, Answer);
+			return Answer;
+		}
+
+		//	Non-blocking lookup. Returns true when Country holds the real value. Otherwise Country
+		//	is set to the default, and OnResolved (if any) is called from a worker thread once the
+		//	provider answers.
+		inline bool Get(const std::string &IP, std::string &Country,
+						ResolvedCallback OnResolved) {
+			if (!Enabled_) {
+				Country = Default_;
+				return true;
+			}
+			auto Key = CacheKey(IP);
+			if (CacheGet(Key, Country))
+				return true;
+			if (Provider_->IsLocal()) {
+				Country = Get(IP);
+				return true;
+			}
+
+			Country = Default_;
+			{
+				std::lock_guard G(QueueMutex_);
+				auto Hint = Pending_.find(Key);
+				if (Hint != Pending_.end()) {
+					if (OnResolved)
+						Hint->second.Callbacks.emplace_back(std::move(OnResolved));
+					return false;
+				}
+				if (!Running_ || Pending_.size() >= MaxPending_) {
+					++Dropped_;
+					return false;
+				}
+				auto &Entry = Pending_[Key];
+				Entry.IP = IP;
+				if (OnResolved)
+					Entry.Callbacks.emplace_back(std::move(OnResolved));
+				Queue_.push_back(Key);
+			}
+			QueueCondition_.notify_one();
+			return false;
+		}
+
+		inline void run() final {
+			Utils::SetThreadName("iptocountry");
+			while (true) {
+				std::string Key, IP;
+				{
+					std::unique_lock Lock(QueueMutex_);
+					QueueCondition_.wait(Lock, [this] { return !Running_ || !Queue_.empty(); });
+					if (!Running_)
+						return;
+					Key = std::move(Queue_.front());
+					Queue_.pop_front();
+					IP = Pending_[Key].IP;
+				}
+
+				auto Answer = Resolve(IP);
+				if (!Answer.empty())
+					CachePut(Key, Answer);
+
+				std::vector<ResolvedCallback> Callbacks;
+				{
+					std::lock_guard G(QueueMutex_);
+					auto Hint = Pending_.find(Key);
+					if (Hint != Pending_.end()) {
+						Callbacks = std::move(Hint->second.Callbacks);
+						Pending_.erase(Hint);
+					}
+				}
+				if (Answer.empty())
+					continue;
+				for (const auto &Callback : Callbacks) {
+					try {
+						Callback(Answer);
+					} catch (...) {
+					}
 				}
-			} catch (...) {
 			}
-			return Default_;
 		}
 
 		inline auto Enabled() const { return Enabled_; }
 
+		inline void GetCounters(std::uint64_t &Hits, std::uint64_t &Misses, std::uint64_t &Dropped) const {
+			Hits = Hits_;
+			Misses = Misses_;
+			Dropped = Dropped_;
+		}
+
 	  private:
+		struct CacheEntry {
+			std::string Key;
+			std::string Country;
+			std::uint64_t Expires = 0;
+		};
+		struct PendingEntry {
+			std::string IP;
+			std::vector<ResolvedCallback> Callbacks;
+		};
+
 		bool Enabled_ = false;
 		std::string Default_;
 		std::unique_ptr<IPToCountryProvider> Provider_;
 		std::string ProviderName_;
 
+		std::uint64_t CacheSize_ = 100000;
+		std::uint64_t CacheTTL_ = 24 * 60 * 60;
+		bool PrefixKeys_ = true;
+		std::mutex CacheMutex_;
+		std::list<CacheEntry> LRU_;
+		std::unordered_map<std::string, std::list<CacheEntry>::iterator> Cache_;
+
+		std::uint64_t MaxPending_ = 10000;
+		std::mutex QueueMutex_;
+		std::condition_variable QueueCondition_;
+		std::deque<std::string> Queue_;
+		std::unordered_map<std::string, PendingEntry> Pending_;
+		std::vector<std::unique_ptr<Poco::Thread>> Workers_;
+		bool Running_ = false;
+
+		std::atomic_uint64_t Hits_ = 0;
+		std::atomic_uint64_t Misses_ = 0;
+		std::atomic_uint64_t Dropped_ = 0;
+
+		//	Country allocations are never finer than a /24 (IPv4) or /64 (IPv6), so neighbours
+		//	share a cache entry when prefix keys are enabled.
+		inline std::string CacheKey(const std::string &IP) const {
+			if (!PrefixKeys_)
+				return IP;
+			Poco::Net::IPAddress Address;
+			if (!Poco::Net::IPAddress::tryParse(IP, Address))
+				return IP;
+			auto Bits = Address.family() == Poco::Net::IPAddress::IPv4 ? 24 : 64;
+			return (Address & Poco::Net::IPAddress(Bits, Address.family())).toString();
+		}
+
+		inline std::string Resolve(const std::string &IP) {
+			try {
+				return Provider_->Lookup(IP);
+			} catch (...) {
+			}
+			return "";
+		}
+
+		inline bool CacheGet(const std::string &Key, std::string &Country) {
+			std::lock_guard G(CacheMutex_);
+			auto Hint = Cache_.find(Key);
+			if (Hint == Cache_.end()) {
+				++Misses_;
+				return false;
+			}
+			if (Hint->second->Expires < Utils::Now()) {
+				LRU_.erase(Hint->second);
+				Cache_.erase(Hint);
+				++Misses_;
+				return false;
+			}
+			LRU_.splice(LRU_.begin(), LRU_, Hint->second);
+			Country = Hint->second->Country;
+			++Hits_;
+			return true;
+		}
+
+		inline void CachePut(const std::string &Key, const std::string &Country) {
+			if (CacheSize_ == 0)
+				return;
+			std::lock_guard G(CacheMutex_);
+			auto Hint = Cache_.find(Key);
+			if (Hint != Cache_.end()) {
+				Hint->second->Country = Country;
+				Hint->second->Expires = Utils::Now() + CacheTTL_;
+				LRU_.splice(LRU_.begin(), LRU_, Hint->second);
+				return;
+			}
+			LRU_.push_front(CacheEntry{Key, Country, Utils::Now() + CacheTTL_});
+			Cache_[Key] = LRU_.begin();
+			while (Cache_.size() > CacheSize_) {
+				Cache_.erase(LRU_.back().Key);
+				LRU_.pop_back();
+			}
+		}
+
 		FindCountryFromIP() noexcept : SubSystemServer("IpToCountry", "IPTOC-SVR", "iptocountry") {}
 	};
 
@@ -34,8 +34,57 @@ namespace OpenWifi {
 		poco_information(Logger(),"Stopped...");
 	}
 
+	static void RemoveFromIndex(std::multimap<std::string,RADIUSSessionPtr> &Index, const std::string &Key, const RADIUSSessionPtr &Session) {
+		if(Key.empty())
+			return;
+		auto [First, Last] = Index.equal_range(Key);
+		for(; First != Last; ++First) {
+			if(First->second == Session) {
+				Index.erase(First);
+				return;
+			}
+		}
+	}
+
+	void RADIUSSessionTracker::AddSession(SessionMap &Sessions, const std::string &Index, const RADIUSSessionPtr &Session) {
+		Sessions[Index] = Session;
+		if(!Session->userName.empty())
+			UserNameIndex_.emplace(Session->userName, Session);
+		if(!Session->callingStationId.empty())
+			MACIndex_.emplace(Session->callingStationId, Session);
+		if(!Session->accountingSessionId.empty())
+			AccountingSessionIndex_.emplace(Session->accountingSessionId, Session);
+	}
+
+	RADIUSSessionTracker::SessionMap::iterator RADIUSSessionTracker::RemoveSession(SessionMap &Sessions, SessionMap::iterator Hint) {
+		const auto &Session = Hint->second;
+		RemoveFromIndex(UserNameIndex_, Session->userName, Session);
+		RemoveFromIndex(MACIndex_, Session->callingStationId, Session);
+		RemoveFromIndex(AccountingSessionIndex_, Session->accountingSessionId, Session);
+		return Sessions.erase(Hint);
+	}
+
+	//	Without wildcards this is a plain lookup. Otherwise only the keys starting with the literal
+	//	prefix of the pattern are matched.
+	void RADIUSSessionTracker::SearchIndex(const SessionIndex &Index, const std::string &Pattern, GWObjects::RADIUSSessionList &list) {
+		auto Wildcard = Pattern.find_first_of("*?");
+		if(Wildcard == std::string::npos) {
+			auto [First, Last] = Index.equal_range(Pattern);
+			for(; First != Last; ++First) {
+				list.sessions.emplace_back(*First->second);
+			}
+			return;
+		}
+		auto Prefix = Pattern.substr(0, Wildcard);
+		for(auto It = Index.lower_bound(Prefix); It != Index.end() && It->first.compare(0, Prefix.size(), Prefix) == 0; ++It) {
+			if(Utils::match(Pattern.c_str(), It->first.c_str())) {
+				list.sessions.emplace_back(*It->second);
+			}
+		}
+	}
+
 	void RADIUSSessionTracker::GarbageCollection([[maybe_unused]] Poco::Timer &timer) {
-		std::lock_guard		G(Mutex_);
+		std::unique_lock	G(SessionsMutex_);
 
 		auto Now = Utils::Now();
 		std::uint64_t active_sessions=0, active_devices=0;
@@ -47,7 +96,7 @@ namespace OpenWifi {
 				auto & session = session_it->second;
 				if((Now-session->lastTransaction)>SessionTimeout_) {
 					poco_debug(Logger(),fmt::format("{}: Session {} timeout for {}", serialNumber, session_name, session->userName));
-					session_it = session_list.erase(session_it);
+					session_it = RemoveSession(session_list, session_it);
 				} else {
 					++active_sessions;
 					++session_it;
@@ -96,7 +145,7 @@ namespace OpenWifi {
 	}
 
 	void RADIUSSessionTracker::ProcessAuthenticationSession([[maybe_unused]] OpenWifi::SessionNotification &Notification) {
-		std::lock_guard Guard(Mutex_);
+		std::unique_lock Guard(SessionsMutex_);
 
 		std::string CallingStationId, CalledStationId, AccountingSessionId, AccountingMultiSessionId, UserName, ChargeableUserIdentity, Interface, nasId;
 		for (const auto &attribute : Notification.Packet_.Attrs_) {
@@ -173,7 +222,7 @@ namespace OpenWifi {
 			NewSession->interface = Interface;
 			NewSession->nasId = nasId;
 			NewSession->secret = Notification.Secret_;
-			ap_hint->second[Index] = NewSession;
+			AddSession(ap_hint->second, Index, NewSession);
 		} else {
 			session_hint->second->lastTransaction = Utils::Now();
 		}
@@ -191,7 +240,7 @@ namespace OpenWifi {
 
 	void
 	RADIUSSessionTracker::ProcessAccountingSession(OpenWifi::SessionNotification &Notification) {
-		std::lock_guard     Guard(Mutex_);
+		std::unique_lock    Guard(SessionsMutex_);
 
 		std::string CallingStationId, CalledStationId, AccountingSessionId, AccountingMultiSessionId, UserName, ChargeableUserIdentity, Interface;
 		std::uint8_t AccountingPacketType = 0;
@@ -310,14 +359,14 @@ namespace OpenWifi {
 			NewSession->secret = Notification.Secret_;
 
 			poco_debug(Logger(),fmt::format("{}: Creating session", CallingStationId));
-			ap_hint->second[Index] = NewSession;
+			AddSession(ap_hint->second, Index, NewSession);
 
 		} else {
 
 			//  If we receive a stop, just remove that session
 			if(AccountingPacketType==OpenWifi::RADIUS::AccountingPacketTypes::ACCT_STATUS_TYPE_STOP) {
 				poco_debug(Logger(),fmt::format("{}: Deleting session", CallingStationId));
-				ap_hint->second.erase(Index);
+				RemoveSession(ap_hint->second, session_hint);
 			} else {
 				poco_debug(Logger(),fmt::format("{}: Updating session", CallingStationId));
 				session_hint->second->accountingPacket = Notification.Packet_;
@@ -383,7 +432,7 @@ namespace OpenWifi {
 
 	bool RADIUSSessionTracker::SendCoADM(const std::string &serialNumber, const std::string &sessionId) {
 		poco_information(Logger(),fmt::format("{}: SendCoADM for {}.", serialNumber, sessionId));
-		std::lock_guard		Guard(Mutex_);
+		std::shared_lock	Guard(SessionsMutex_);
 
 		auto ap_hint = AccountingSessions_.find(serialNumber);
 		if(ap_hint==end(AccountingSessions_)) {
@@ -400,14 +449,11 @@ namespace OpenWifi {
 
 	bool RADIUSSessionTracker::DisconnectUser(const std::string &UserName) {
 		poco_information(Logger(),fmt::format("Disconnect user {}.", UserName));
-		std::lock_guard		Guard(Mutex_);
+		std::shared_lock	Guard(SessionsMutex_);
 
-		for(const auto &AP:AccountingSessions_) {
-			for(const auto &Session:AP.second) {
-				if(Session.second->userName==UserName) {
-					SendCoADM(Session.second);
-				}
-			}
+		auto [First, Last] = UserNameIndex_.equal_range(UserName);
+		for(; First != Last; ++First) {
+			SendCoADM(First->second);
 		}
 
 		return true;
@@ -415,7 +461,7 @@ namespace OpenWifi {
 
 	void RADIUSSessionTracker::DisconnectSession(const std::string &SerialNumber) {
 
-		std::lock_guard		Guard(Mutex_);
+		std::unique_lock	Guard(SessionsMutex_);
 		auto hint = AccountingSessions_.find(SerialNumber);
 		if(hint==end(AccountingSessions_)) {
 			return;
@@ -436,6 +482,9 @@ namespace OpenWifi {
 			RADIUS_proxy_server()->RouteAndSendAccountingPacket(session.second->destination, SerialNumber, P, true, session.second->secret);
 		}
 
+		for(auto session_it = hint->second.begin(); session_it != end(hint->second); ) {
+			session_it = RemoveSession(hint->second, session_it);
+		}
 		AccountingSessions_.erase(hint);
 	}
 
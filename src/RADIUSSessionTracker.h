@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <map>
+#include <shared_mutex>
+
 #include <framework/SubSystemServer.h>
 #include <Poco/Runnable.h>
 #include <Poco/Notification.h>
@@ -103,7 +106,7 @@ namespace OpenWifi {
 
 		inline void AddAuthenticationSession(const std::string &Destination, const std::string &SerialNumber,
 											 const RADIUS::RadiusPacket &P, const std::string &secret) {
-			std::lock_guard	G(Mutex_);
+			std::shared_lock	G(SessionsMutex_);
 			auto ap_hint = AccountingSessions_.find(SerialNumber);
 			if(AccountingSessions_.find(SerialNumber)!=end(AccountingSessions_)) {
 				//	if we have already added the info, do not need to add it again
@@ -121,7 +124,7 @@ namespace OpenWifi {
 		}
 
 		inline void GetAPList(std::vector<std::string> &SerialNumbers) {
-			std::lock_guard	G(Mutex_);
+			std::shared_lock	G(SessionsMutex_);
 
 			for(const auto &[serialNumber,_]:AccountingSessions_) {
 				SerialNumbers.emplace_back(serialNumber);
@@ -129,7 +132,7 @@ namespace OpenWifi {
 		}
 
 		inline void GetAPSessions(const std::string &SerialNumber, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
+			std::shared_lock	G(SessionsMutex_);
 
 			auto ap_hint = AccountingSessions_.find(SerialNumber);
 			if(ap_hint!=end(AccountingSessions_)) {
@@ -139,28 +142,20 @@ namespace OpenWifi {
 			}
 		}
 
+		//	userName, mac and accountingSessionId accept the '*' and '?' wildcards.
 		inline void GetUserNameAPSessions(const std::string &userName, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
-
-			for(const auto &[_,sessions]:AccountingSessions_) {
-				for(const auto &[_,session]:sessions) {
-					if(Utils::match(userName.c_str(),session->userName.c_str())) {
-						list.sessions.emplace_back(*session);
-					}
-				}
-			}
+			std::shared_lock	G(SessionsMutex_);
+			SearchIndex(UserNameIndex_, userName, list);
 		}
 
 		inline void GetMACAPSessions(const std::string &mac, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
+			std::shared_lock	G(SessionsMutex_);
+			SearchIndex(MACIndex_, mac, list);
+		}
 
-			for(const auto &[_,sessions]:AccountingSessions_) {
-				for(const auto &[_,session]:sessions) {
-					if(Utils::match(mac.c_str(),session->callingStationId.c_str())) {
-						list.sessions.emplace_back(*session);
-					}
-				}
-			}
+		inline void GetAccountingSessionIdSessions(const std::string &accountingSessionId, GWObjects::RADIUSSessionList & list) {
+			std::shared_lock	G(SessionsMutex_);
+			SearchIndex(AccountingSessionIndex_, accountingSessionId, list);
 		}
 
 		bool SendCoADM(const std::string &serialNumber, const std::string &sessionId);
@@ -168,7 +163,7 @@ namespace OpenWifi {
 		bool DisconnectUser(const std::string &UserName);
 
 		inline std::uint32_t HasSessions(const std::string & serialNumber) {
-			std::lock_guard	G(Mutex_);
+			std::shared_lock	G(SessionsMutex_);
 			auto ap_hint = AccountingSessions_.find(serialNumber);
 			if(ap_hint==end(AccountingSessions_)) {
 				return 0;
@@ -186,6 +181,16 @@ namespace OpenWifi {
 		using SessionMap = std::map<std::string,RADIUSSessionPtr>;	//	calling-station-id + accounting-session-id
 		std::map<std::string,SessionMap>		AccountingSessions_;				//	serial-number -> session< accounting-session -> session>
 
+		//	Sorted secondary indexes over the same sessions, so searches only visit the keys sharing
+		//	the literal prefix of the pattern. Session user name, calling station and accounting
+		//	session id never change once the session is created. Everything is guarded by
+		//	SessionsMutex_: searches take it shared, the session thread and the collector exclusive.
+		using SessionIndex = std::multimap<std::string,RADIUSSessionPtr>;
+		SessionIndex							UserNameIndex_;
+		SessionIndex							MACIndex_;
+		SessionIndex							AccountingSessionIndex_;
+		mutable std::shared_mutex				SessionsMutex_;
+
 		Poco::Timer 												GarbageCollectionTimer_;
 		std::unique_ptr<Poco::TimerCallback<RADIUSSessionTracker>> 	GarbageCollectionCallback_;
 
@@ -196,6 +201,10 @@ namespace OpenWifi {
 		void ProcessAuthenticationSession(SessionNotification &Notification);
 		void DisconnectSession(const std::string &SerialNumber);
 
+		void AddSession(SessionMap &Sessions, const std::string &Index, const RADIUSSessionPtr &Session);
+		SessionMap::iterator RemoveSession(SessionMap &Sessions, SessionMap::iterator Hint);
+		static void SearchIndex(const SessionIndex &Index, const std::string &Pattern, GWObjects::RADIUSSessionList &list);
+
 		RADIUSSessionTracker() noexcept
 			: SubSystemServer("RADIUSSessionTracker", "RADIUS-SESSION", "radius.session") {}
 
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "Poco/HMACEngine.h"
 #include "Poco/MD5Engine.h"
@@ -55,6 +57,7 @@ namespace OpenWifi::RADIUS {
 		constexpr std::uint8_t CALLING_STATION_ID = 31;
 		constexpr std::uint8_t NAS_IDENTIFIER = 32;
 		constexpr std::uint8_t PROXY_STATE = 33;
+		constexpr std::uint8_t VENDOR_SPECIFIC = 26;
 		constexpr std::uint8_t ACCT_STATUS_TYPE = 40;
 		constexpr std::uint8_t ACCT_INPUT_OCTETS = 42;
 		constexpr std::uint8_t ACCT_OUTPUT_OCTETS = 43;
@@ -244,6 +247,12 @@ namespace OpenWifi::RADIUS {
 		uint16_t pos{0};
 		unsigned len{0};
 	};
+	struct RadiusVendorAttribute {
+		uint32_t vendor{0};
+		unsigned char type{0};
+		uint16_t pos{0};
+		unsigned len{0};
+	};
 	struct RawRadiusPacket {
 		unsigned char code{1};
 		unsigned char identifier{0};
@@ -296,7 +305,8 @@ namespace OpenWifi::RADIUS {
 	// From: https://github.com/Telecominfraproject/wlan-dictionary/blob/main/dictionary.tip
 	//
 
-	using AttributeList = std::list<RadiusAttribute>;
+	using AttributeList = std::vector<RadiusAttribute>;
+	using VendorAttributeList = std::vector<RadiusVendorAttribute>;
 
 	inline std::ostream &operator<<(std::ostream &os, AttributeList const &P) {
 		for (const auto &attr : P) {
@@ -306,31 +316,24 @@ namespace OpenWifi::RADIUS {
 		return os;
 	}
 
-	inline bool ParseRadius(uint32_t offset, const unsigned char *Buffer, uint16_t Size,
-							AttributeList &Attrs) {
-		Attrs.clear();
-		uint16_t pos = 0;
-		auto x = 25;
-		while (pos < Size && x) {
-			RadiusAttribute Attr{.type = Buffer[pos],
-								 .pos = (uint16_t)(pos + 2 + offset),
-								 .len = (unsigned int)(Buffer[pos + 1] - 2)};
-			if (pos + Attr.len <= Size) {
-				Attrs.emplace_back(Attr);
-			} else {
-				std::cout << "Bad parse1: " << (uint32_t)(pos + Attr.len) << "  S:" << Size
-						  << std::endl;
-				return false;
-			}
-			if (Buffer[pos + 1] == 0) {
-				std::cout << "Bad parse2: " << (uint32_t)(pos + Attr.len) << "  S:" << Size
-						  << std::endl;
-				return false;
+	//	Proxy-State is "serial|ip|port|interface", or ':' separated for older firmware.
+	inline bool SplitProxyState(std::string_view State, std::array<std::string_view, 4> &Parts) {
+		for (char Separator : {'|', ':'}) {
+			std::size_t Count = 0, Start = 0;
+			while (true) {
+				auto End = State.find(Separator, Start);
+				if (Count < Parts.size())
+					Parts[Count] = State.substr(
+						Start, End == std::string_view::npos ? End : End - Start);
+				++Count;
+				if (End == std::string_view::npos)
+					break;
+				Start = End + 1;
 			}
-			pos += Buffer[pos + 1];
-			x--;
+			if (Count == Parts.size())
+				return true;
 		}
-		return true;
+		return false;
 	}
 
 	class RadiusPacket {
@@ -344,7 +347,7 @@ namespace OpenWifi::RADIUS {
 			Size_ = Buf.size();
 			Valid_ = (Size_ == ntohs(P_.rawlen));
 			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+				Valid_ = Parse();
 		}
 
 		explicit RadiusPacket(const unsigned char *buffer, uint16_t size) {
@@ -356,7 +359,7 @@ namespace OpenWifi::RADIUS {
 			Size_ = size;
 			Valid_ = (Size_ == ntohs(P_.rawlen));
 			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+				Valid_ = Parse();
 		}
 
 		explicit RadiusPacket(const std::string &p) {
@@ -368,7 +371,7 @@ namespace OpenWifi::RADIUS {
 			Size_ = p.size();
 			Valid_ = (Size_ == ntohs(P_.rawlen));
 			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+				Valid_ = Parse();
 		}
 
 		RadiusPacket(const RadiusPacket &P) {
@@ -376,11 +379,13 @@ namespace OpenWifi::RADIUS {
 			Size_ = P.Size_;
 			P_ = P.P_;
 			Attrs_ = P.Attrs_;
+			VendorAttrs_ = P.VendorAttrs_;
+			Index_ = P.Index_;
 		}
 
         void ReParse() {
             P_.rawlen = htons(Size_);
-            Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+            Valid_ = Parse();
         }
 
 		inline RadiusPacket& operator=(const RadiusPacket& other) {
@@ -388,6 +393,8 @@ namespace OpenWifi::RADIUS {
 			Size_ = other.Size_;
 			P_ = other.P_;
 			Attrs_ = other.Attrs_;
+			VendorAttrs_ = other.VendorAttrs_;
+			Index_ = other.Index_;
 			return *this;
 		}
 
@@ -401,11 +408,29 @@ namespace OpenWifi::RADIUS {
 
 		void Evaluate(uint16_t size) {
 			Size_ = size;
-			Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+			Valid_ = Parse();
 		}
 
 		[[nodiscard]] uint16_t Len() const { return ntohs(P_.rawlen); }
 		[[nodiscard]] uint16_t Size() const { return Size_; }
+		[[nodiscard]] bool IsValid() const { return Valid_; }
+
+		//	Value of the first attribute of this type, pointing into the packet. Empty when absent.
+		[[nodiscard]] inline std::string_view AttributeValue(std::uint8_t Type) const {
+			if (Index_[Type] == 0)
+				return {};
+			const auto &A = Attrs_[Index_[Type] - 1];
+			return {(const char *)&P_.attributes[A.pos], A.len};
+		}
+
+		[[nodiscard]] inline std::string_view VendorAttributeValue(std::uint32_t Vendor,
+																   std::uint8_t Type) const {
+			for (const auto &A : VendorAttrs_) {
+				if (A.vendor == Vendor && A.type == Type)
+					return {(const char *)&P_.attributes[A.pos], A.len};
+			}
+			return {};
+		}
 
 		friend std::ostream &operator<<(std::ostream &os, RadiusPacket const &P);
 
@@ -439,23 +464,18 @@ namespace OpenWifi::RADIUS {
 		}
 
 		inline bool IsStatusMessageReply(std::string &ReplySource) {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE) {
-					std::string Attr33;
-					// format is statis:server name
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, ":");
-					if(Parts.count() == 2 && Parts[0] == "status") {
-						ReplySource = Parts[1];
-						return true;
-					}
-					return false;
-				}
+			if (!HasAttribute(RADIUS::Attributes::PROXY_STATE)) {
+				DBGLINE
+				return false;
 			}
-			DBGLINE
-			return false;
+			// format is statis:server name
+			auto State = AttributeValue(RADIUS::Attributes::PROXY_STATE);
+			auto Separator = State.find(':');
+			if (Separator == std::string_view::npos || State.substr(0, Separator) != "status" ||
+				State.find(':', Separator + 1) != std::string_view::npos)
+				return false;
+			ReplySource = State.substr(Separator + 1);
+			return true;
 		}
 		void Log(std::ostream &os) {
 			uint16_t p = 0;
@@ -619,159 +639,54 @@ namespace OpenWifi::RADIUS {
 
 		std::string ExtractSerialNumberTIP() {
 			std::string R;
-
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == 26) {
-					AttributeList VendorAttributes;
-					uint32_t VendorId = htonl(*(const uint32_t *)&(P_.attributes[attribute.pos]));
-					// std::cout << VendorId << std::endl;
-					if (VendorId == TIP_vendor_id && attribute.len > (4 + 2)) {
-						if (ParseRadius(attribute.pos + 4, &P_.attributes[attribute.pos + 4],
-										attribute.len - 4 - 2, VendorAttributes)) {
-							// std::cout << VendorAttributes << std::endl;
-							for (const auto &vendorAttr : VendorAttributes) {
-								if (vendorAttr.type == TIP_serial) {
-									for (uint16_t i = 0; i < vendorAttr.len; i++) {
-										if (P_.attributes[vendorAttr.pos + i] == '-')
-											continue;
-										R += (char)P_.attributes[vendorAttr.pos + i];
-									}
-									return R;
-								}
-							}
-						}
-					}
-				}
+			for (auto c : VendorAttributeValue(TIP_vendor_id, TIP_serial)) {
+				if (c != '-')
+					R += c;
 			}
 			return R;
 		}
 
 		std::string ExtractSerialNumberFromProxyState() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE) {
-					std::string Attr33;
-					// format is serial:IP:port:interface
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						return Parts[0];
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						return Parts[0];
-					}
-					return Result;
-				}
-			}
-			return Result;
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(AttributeValue(RADIUS::Attributes::PROXY_STATE), Parts))
+				return std::string(Parts[0]);
+			return "";
 		}
 
 		std::string ExtractProxyStateDestination() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE && attribute.len > 2) {
-					std::string Attr33;
-					// format is
-
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						Poco::Net::SocketAddress D(Parts[1], Parts[2]);
-						return D.toString();
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						Poco::Net::SocketAddress D(Parts[1], Parts[2]);
-						return D.toString();
-					}
-					return Result;
-				}
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(AttributeValue(RADIUS::Attributes::PROXY_STATE), Parts)) {
+				Poco::Net::SocketAddress D{std::string(Parts[1]), std::string(Parts[2])};
+				return D.toString();
 			}
-			return Result;
+			return "";
 		}
 
 		std::uint32_t ExtractProxyStateDestinationIPint() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE && attribute.len > 2) {
-					std::string Attr33;
-					// format is
-
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						return Utils::IPtoInt(Parts[1]);
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						return Utils::IPtoInt(Parts[1]);
-					}
-					return 0;
-				}
-			}
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(AttributeValue(RADIUS::Attributes::PROXY_STATE), Parts))
+				return Utils::IPtoInt(std::string(Parts[1]));
 			return 0;
 		}
 
 		std::string ExtractCallingStationID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::CALLING_STATION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					return Result;
-				}
-			}
-			return Result;
+			return std::string(AttributeValue(RADIUS::Attributes::CALLING_STATION_ID));
 		}
 
 		std::string ExtractAccountingSessionID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::ACCT_SESSION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len );
-					return Result;
-				}
-			}
-			return Result;
+			return std::string(AttributeValue(RADIUS::Attributes::ACCT_SESSION_ID));
 		}
 
 		std::string ExtractAccountingMultiSessionID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::ACCT_MULTI_SESSION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len );
-					return Result;
-				}
-			}
-			return Result;
+			return std::string(AttributeValue(RADIUS::Attributes::ACCT_MULTI_SESSION_ID));
 		}
 
 		std::string ExtractCalledStationID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::CALLED_STATION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					return Result;
-				}
-			}
-			return Result;
+			return std::string(AttributeValue(RADIUS::Attributes::CALLED_STATION_ID));
 		}
 
 		[[nodiscard]] std::string UserName() const {
-			for (const auto &attr : Attrs_) {
-				if (attr.type == RADIUS::Attributes::AUTH_USERNAME) {
-					std::string user_name{(const char *)&P_.attributes[attr.pos], attr.len};
-					return user_name;
-				}
-			}
-			return "";
+			return std::string(AttributeValue(RADIUS::Attributes::AUTH_USERNAME));
 		}
 
 		void ReplaceAttribute(std::uint8_t attribute, std::uint8_t value) {
@@ -966,7 +881,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		bool HasAttribute(std::uint8_t attribute) const {
-			return std::any_of(Attrs_.begin(),Attrs_.end(),[attribute](const RadiusAttribute &Attr) { return Attr.type ==attribute; });
+			return Index_[attribute] != 0;
 		}
 
 		void ReplaceOrAdd(std::uint8_t attribute, std::uint8_t attribute_value) {
@@ -1009,6 +924,60 @@ namespace OpenWifi::RADIUS {
 		RawRadiusPacket P_;
 		uint16_t Size_{0};
 		bool Valid_ = false;
+
+	  private:
+		//	Position + 1 in Attrs_ of the first attribute of each type, 0 when absent.
+		std::array<std::uint16_t, 256> Index_{};
+		//	Sub-attributes of the RFC 2865 formatted Vendor-Specific attributes.
+		VendorAttributeList VendorAttrs_;
+
+		//	One pass over the attributes builds Attrs_, the type index and the vendor attributes.
+		//	What was read before a bad attribute is kept, but the packet is not valid.
+		inline bool Parse() {
+			Attrs_.clear();
+			VendorAttrs_.clear();
+			Index_.fill(0);
+			if (Size_ < AttributeOffset)
+				return false;
+			const auto *Buffer = &P_.attributes[0];
+			std::uint16_t Size = Size_ - AttributeOffset, pos = 0;
+			while (pos < Size) {
+				if ((pos + 2) > Size || Buffer[pos + 1] < 2 || (pos + Buffer[pos + 1]) > Size)
+					return false;
+				const auto &A = Attrs_.emplace_back(
+					RadiusAttribute{.type = Buffer[pos],
+									.pos = (uint16_t)(pos + 2),
+									.len = (unsigned int)(Buffer[pos + 1] - 2)});
+				if (Index_[A.type] == 0)
+					Index_[A.type] = (std::uint16_t)Attrs_.size();
+				if (A.type == RADIUS::Attributes::VENDOR_SPECIFIC && A.len > 4)
+					IndexVendorAttributes(A);
+				pos += Buffer[pos + 1];
+			}
+			return true;
+		}
+
+		//	Vendor id, then type/length/value sub-attributes. Vendors using another layout are
+		//	skipped without invalidating the packet.
+		inline void IndexVendorAttributes(const RadiusAttribute &A) {
+			const auto *Value = &P_.attributes[A.pos];
+			std::uint32_t Vendor = ((std::uint32_t)Value[0] << 24) | ((std::uint32_t)Value[1] << 16) |
+								   ((std::uint32_t)Value[2] << 8) | (std::uint32_t)Value[3];
+			auto First = VendorAttrs_.size();
+			unsigned pos = 4;
+			while (pos < A.len) {
+				if ((pos + 2) > A.len || Value[pos + 1] < 2 || (pos + Value[pos + 1]) > A.len) {
+					VendorAttrs_.resize(First);
+					return;
+				}
+				VendorAttrs_.emplace_back(
+					RadiusVendorAttribute{.vendor = Vendor,
+										  .type = Value[pos],
+										  .pos = (uint16_t)(A.pos + pos + 2),
+										  .len = (unsigned int)(Value[pos + 1] - 2)});
+				pos += Value[pos + 1];
+			}
+		}
 	};
 
 	class RadiusOutputPacket {
@@ -62,55 +62,131 @@ namespace OpenWifi {
 
 	void RADIUS_proxy_server::StartRADIUSDestinations() {
 		std::lock_guard G(Mutex_);
+		auto Routes = std::make_shared<RoutingTable>();
 		for (const auto &pool : PoolList_.pools) {
 			if(pool.enabled) {
-				RADIUS_Destinations_[Utils::IPtoInt(pool.poolProxyIp)] =
-						std::make_unique<RADIUS_Destination>(RadiusReactor_, pool);
+				auto &R = (*Routes)[Utils::IPtoInt(pool.poolProxyIp)];
+				R.Destination = std::make_shared<RADIUS_Destination>(RadiusReactor_, pool);
+				R.Generic = R.Destination->ServerType() == GWObjects::RadiusEndpointType::generic;
+				if (!pool.acctConfig.servers.empty())
+					R.AcctSecret = pool.acctConfig.servers[0].secret;
+				if (!pool.authConfig.servers.empty())
+					R.AuthServer = pool.authConfig.servers[0].ip;
+				if (!pool.coaConfig.servers.empty())
+					R.CoAServer = pool.coaConfig.servers[0].ip;
 			} else {
 				poco_information(Logger(),fmt::format("Pool {} is not enabled.", pool.name));
 			}
 		}
+		Routes_.Publish(std::move(Routes));
 	}
 
 	void RADIUS_proxy_server::StopRADIUSDestinations() {
 		std::lock_guard G(Mutex_);
-		RADIUS_Destinations_.clear();
+		auto Previous = Routes_.Load();
+		Routes_.Publish(std::make_shared<const RoutingTable>());
+		//	Threads that have not sent a packet since may still hold the old table: stop its
+		//	destinations now rather than whenever the last of them lets go. A send that already
+		//	found its route holds SendMutex, so each route is marked stopped under it first and the
+		//	sockets are only closed once no send can reach them.
+		for (const auto &[_, R] : *Previous) {
+			std::unique_lock G(R.SendMutex);
+			R.Stopped = true;
+		}
+		for (const auto &[_, R] : *Previous) {
+			R.Destination->Stop();
+		}
+	}
+
+	bool RADIUS_proxy_server::Forward(const Route &R, radius_type Type,
+									  const std::string &serialNumber,
+									  const unsigned char *buffer, std::size_t size) {
+		bool Sent = false;
+		if (!R.Generic) {
+			std::unique_lock G(R.SendMutex);
+			if (!R.Stopped)
+				Sent = R.Destination->SendData(serialNumber, buffer, size);
+		} else {
+			std::shared_lock G(R.SendMutex);
+			if (!R.Stopped) {
+				switch (Type) {
+				case radius_type::auth:
+					Sent = R.Destination->SendRadiusDataAuthData(serialNumber, buffer, size);
+					break;
+				case radius_type::acct:
+					Sent = R.Destination->SendRadiusDataAcctData(serialNumber, buffer, size);
+					break;
+				case radius_type::coa:
+				default:
+					Sent = R.Destination->SendRadiusDataCoAData(serialNumber, buffer, size);
+					break;
+				}
+			}
+		}
+		switch (Type) {
+		case radius_type::auth:
+			++R.Authentication;
+			break;
+		case radius_type::acct:
+			++R.Accounting;
+			break;
+		case radius_type::coa:
+		default:
+			++R.CoA;
+			break;
+		}
+		if (Sent)
+			R.Bytes += size;
+		else
+			++R.Failed;
+		return Sent;
+	}
+
+	void RADIUS_proxy_server::GetRouteCounters(std::vector<RouteCounters> &Counters) {
+		auto Routes = Routes_.Load();
+		Counters.clear();
+		Counters.reserve(Routes->size());
+		for (const auto &[_, R] : *Routes) {
+			Counters.emplace_back(RouteCounters{.Name = R.Destination->Pool().name,
+												.ProxyIp = R.Destination->Pool().poolProxyIp,
+												.Authentication = R.Authentication,
+												.Accounting = R.Accounting,
+												.CoA = R.CoA,
+												.Bytes = R.Bytes,
+												.Failed = R.Failed});
+		}
 	}
 
 	void RADIUS_proxy_server::RouteAndSendAccountingPacket(const std::string &Destination,const std::string &serialNumber, RADIUS::RadiusPacket &P, bool RecomputeAuthenticator, std::string &Secret) {
 		try{
 
-			//	are we sending this to a pool?
-			auto DstParts = Utils::Split(Destination, ':');
-			std::uint32_t DtsIp = Utils::IPtoInt(DstParts[0]);
-
-			std::lock_guard G(Mutex_);
+			//	are we sending this to a pool? Destination is "ip:port".
+			std::uint32_t DtsIp = Utils::IPtoInt(Destination.substr(0, Destination.rfind(':')));
 
-			auto DestinationServer = RADIUS_Destinations_.find(DtsIp);
-			if (DestinationServer != end(RADIUS_Destinations_)) {
-				if(Logger().trace()) {
-					auto CallingStationID = P.ExtractCallingStationID();
-					auto CalledStationID = P.ExtractCalledStationID();
-					auto SessionID = P.ExtractAccountingSessionID();
-					auto MultiSessionID = P.ExtractAccountingMultiSessionID();
-					Logger().trace(
-						fmt::format("{}: Sending Accounting {} bytes to {}. CalledStationID={} CallingStationID={} SessionID={}:{}",
-									serialNumber, P.Size(),
-									DestinationServer->second->Pool().authConfig.servers[0].ip,
-									CalledStationID, CallingStationID, SessionID, MultiSessionID));
-				}
-				if(DestinationServer->second->ServerType()!=GWObjects::RadiusEndpointType::generic) {
-					Secret = DestinationServer->second->Pool().acctConfig.servers[0].secret;
-					if(RecomputeAuthenticator) {
-						P.RecomputeAuthenticator(Secret);
-					}
-					DestinationServer->second->SendData(serialNumber, (const unsigned char *)P.Buffer(),
-														P.Size());
-				} else {
-					DestinationServer->second->SendRadiusDataAcctData(
-						serialNumber, (const unsigned char *)P.Buffer(), P.Size());
+			const auto &Routes = Routes_.Get();
+			auto DestinationServer = Routes.find(DtsIp);
+			if (DestinationServer == Routes.end()) {
+				++Unrouted_;
+				return;
+			}
+			const auto &R = DestinationServer->second;
+			if(Logger().trace()) {
+				auto CallingStationID = P.ExtractCallingStationID();
+				auto CalledStationID = P.ExtractCalledStationID();
+				auto SessionID = P.ExtractAccountingSessionID();
+				auto MultiSessionID = P.ExtractAccountingMultiSessionID();
+				Logger().trace(
+					fmt::format("{}: Sending Accounting {} bytes to {}. CalledStationID={} CallingStationID={} SessionID={}:{}",
+								serialNumber, P.Size(), R.AuthServer,
+								CalledStationID, CallingStationID, SessionID, MultiSessionID));
+			}
+			if(!R.Generic) {
+				Secret = R.AcctSecret;
+				if(RecomputeAuthenticator) {
+					P.RecomputeAuthenticator(Secret);
 				}
 			}
+			Forward(R, radius_type::acct, serialNumber, (const unsigned char *)P.Buffer(), P.Size());
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		} catch (...) {
@@ -163,31 +239,24 @@ namespace OpenWifi {
 		try {
 			RADIUS::RadiusPacket P((unsigned char *)buffer, size);
 
-			std::lock_guard G(Mutex_);
-
-			std::uint32_t 	DstIp = P.ExtractProxyStateDestinationIPint();
-			auto DestinationServer = RADIUS_Destinations_.find(DstIp);
-			if (DestinationServer != end(RADIUS_Destinations_)) {
-				if(Logger().trace()) {
-					auto CallingStationID = P.ExtractCallingStationID();
-					auto CalledStationID = P.ExtractCalledStationID();
-					auto SessionID = P.ExtractAccountingSessionID();
-					auto MultiSessionID = P.ExtractAccountingMultiSessionID();
-					Logger().trace(
-						fmt::format("{}: Sending Authentication {} bytes to {}. CalledStationID={} CallingStationID={} SessionID={}:{}",
-									serialNumber, P.Size(),
-									DestinationServer->second->Pool().authConfig.servers[0].ip,
-									CalledStationID, CallingStationID, SessionID, MultiSessionID));
-				}
-				if(DestinationServer->second->ServerType()!=GWObjects::RadiusEndpointType::generic) {
-						DestinationServer->second->SendData(serialNumber,
-															(const unsigned char *)buffer, size);
-				}
-				else {
-					DestinationServer->second->SendRadiusDataAuthData(
-						serialNumber, (const unsigned char *)buffer, size);
-				}
+			const auto &Routes = Routes_.Get();
+			auto DestinationServer = Routes.find(P.ExtractProxyStateDestinationIPint());
+			if (DestinationServer == Routes.end()) {
+				++Unrouted_;
+				return;
+			}
+			const auto &R = DestinationServer->second;
+			if(Logger().trace()) {
+				auto CallingStationID = P.ExtractCallingStationID();
+				auto CalledStationID = P.ExtractCalledStationID();
+				auto SessionID = P.ExtractAccountingSessionID();
+				auto MultiSessionID = P.ExtractAccountingMultiSessionID();
+				Logger().trace(
+					fmt::format("{}: Sending Authentication {} bytes to {}. CalledStationID={} CallingStationID={} SessionID={}:{}",
+								serialNumber, P.Size(), R.AuthServer,
+								CalledStationID, CallingStationID, SessionID, MultiSessionID));
 			}
+			Forward(R, radius_type::auth, serialNumber, (const unsigned char *)buffer, size);
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		} catch (...) {
@@ -204,23 +273,16 @@ namespace OpenWifi {
 
 		try {
 			RADIUS::RadiusPacket P((unsigned char *)buffer, size);
-			auto CallingStationID = P.ExtractCallingStationID();
-			auto CalledStationID = P.ExtractCalledStationID();
-			Poco::Net::SocketAddress Dst(Destination);
 
-			std::lock_guard G(Mutex_);
-			std::uint32_t 	DstIp = P.ExtractProxyStateDestinationIPint();
-			auto DestinationServer = RADIUS_Destinations_.find(DstIp);
-			if (DestinationServer != end(RADIUS_Destinations_)) {
-				poco_trace(Logger(),fmt::format("{}: Sending CoA {} bytes to {}", serialNumber, P.Size(), DestinationServer->second->Pool().coaConfig.servers[0].ip));
-				if(DestinationServer->second->ServerType()!=GWObjects::RadiusEndpointType::generic) {
-					DestinationServer->second->SendData(serialNumber, (const unsigned char *)buffer,
-														size);
-				} else {
-					DestinationServer->second->SendRadiusDataCoAData(
-						serialNumber, (const unsigned char *)buffer, size);
-				}
+			const auto &Routes = Routes_.Get();
+			auto DestinationServer = Routes.find(P.ExtractProxyStateDestinationIPint());
+			if (DestinationServer == Routes.end()) {
+				++Unrouted_;
+				return;
 			}
+			const auto &R = DestinationServer->second;
+			poco_trace(Logger(),fmt::format("{}: Sending CoA {} bytes to {}", serialNumber, P.Size(), R.CoAServer));
+			Forward(R, radius_type::coa, serialNumber, (const unsigned char *)buffer, size);
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		} catch (...) {
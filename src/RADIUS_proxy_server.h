@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
 #include "RESTObjects/RESTAPI_GWobjects.h"
 
 #include "Poco/Net/DatagramSocket.h"
@@ -12,6 +18,7 @@
 #include "framework/SubSystemServer.h"
 
 #include "RADIUS_Destination.h"
+#include "SharedSnapshot.h"
 
 namespace OpenWifi {
 
@@ -59,7 +66,23 @@ namespace OpenWifi {
 			std::string poolProxyIp;
 		};
 
-		inline bool Continue() const { return Running_ && Enabled_ && !Pools_.empty(); }
+		struct RouteCounters {
+			std::string 	Name;
+			std::string 	ProxyIp;
+			std::uint64_t 	Authentication = 0;
+			std::uint64_t 	Accounting = 0;
+			std::uint64_t 	CoA = 0;
+			std::uint64_t 	Bytes = 0;
+			std::uint64_t 	Failed = 0;
+		};
+		void GetRouteCounters(std::vector<RouteCounters> &Counters);
+		[[nodiscard]] inline std::uint64_t Unrouted() const { return Unrouted_; }
+
+		//	Routes_ is read first so every thread that handles RADIUS traffic lets go of a replaced
+		//	table, even once the proxy is disabled.
+		inline bool Continue() const {
+			return !Routes_.Get().empty() && Running_ && Enabled_;
+		}
 
 	  private:
 		Poco::Net::SocketReactor 	RadiusReactor_;
@@ -68,7 +91,29 @@ namespace OpenWifi {
 		GWObjects::RadiusProxyPoolList PoolList_;
 		std::string ConfigFilename_;
 
-		std::map<std::uint32_t, std::unique_ptr<RADIUS_Destination>> RADIUS_Destinations_;
+		//	One route per enabled pool, keyed by the pool proxy address carried in the Proxy-State
+		//	attribute. The table is rebuilt on each configuration change and published whole, so
+		//	packets read their thread's copy of it without a lock. Only the counters change afterwards.
+		struct Route {
+			std::shared_ptr<RADIUS_Destination> Destination;
+			bool 						Generic = true;
+			std::string 				AcctSecret;
+			std::string 				AuthServer;
+			std::string 				CoAServer;
+			//	Generic destinations send under a shared lock, RADSEC destinations under the exclusive
+			//	one as they write to a single TLS stream. Stopped is set under the exclusive lock
+			//	before the destination closes its sockets, so no send can still be using them.
+			mutable std::shared_mutex 	SendMutex;
+			mutable bool 				Stopped = false;
+			mutable std::atomic_uint64_t Authentication = 0;
+			mutable std::atomic_uint64_t Accounting = 0;
+			mutable std::atomic_uint64_t CoA = 0;
+			mutable std::atomic_uint64_t Bytes = 0;
+			mutable std::atomic_uint64_t Failed = 0;
+		};
+		using RoutingTable = std::unordered_map<std::uint32_t, Route>;
+		SharedSnapshot<RoutingTable> Routes_;
+		std::atomic_uint64_t 		Unrouted_ = 0;
 
 		struct RadiusPool {
 			std::vector<Destination> AuthV4;
@@ -90,6 +135,8 @@ namespace OpenWifi {
 
 		static bool SendData(Poco::Net::DatagramSocket &Sock, const unsigned char *buf,
 							 std::size_t size, const Poco::Net::SocketAddress &S);
+		static bool Forward(const Route &R, radius_type Type, const std::string &serialNumber,
+							const unsigned char *buffer, std::size_t size);
 
 		void ParseConfig();
 		void ResetConfig();
@@ -23,6 +23,9 @@ namespace OpenWifi::RESTAPI_RPC {
 						  RESTAPIHandler *Handler, OpenWifi::Storage::CommandExecutionType Status,
 						  [[maybe_unused]] Poco::Logger &Logger) {
 		if (StorageService()->AddCommand(Cmd.SerialNumber, Cmd, Status)) {
+			if (Status == Storage::CommandExecutionType::COMMAND_PENDING) {
+				CommandManager()->QueueCommand(Cmd);
+			}
 			Poco::JSON::Object RetObj;
 			Cmd.to_json(RetObj);
 			if (Handler == nullptr) {
@@ -166,7 +169,8 @@ namespace OpenWifi::RESTAPI_RPC {
 					sz = rpc_answer->get(uCentralProtocol::RESULT_SZ);
 				std::string UnCompressedData;
 				Utils::ExtractBase64CompressedData(
-					rpc_answer->get(uCentralProtocol::RESULT_64).toString(), UnCompressedData, sz);
+					rpc_answer->get(uCentralProtocol::RESULT_64).toString(), UnCompressedData, sz,
+					AP_WS_Server()->MaxDecompressedSize());
 				Poco::JSON::Stringifier::stringify(UnCompressedData, ResultText);
 			}
 			Cmd.Results = ResultText.str();
@@ -223,7 +227,7 @@ namespace OpenWifi::RESTAPI_RPC {
 				fmt::format("{},{}: Completed in {:.3f}ms.", Cmd.UUID, RPCID, Cmd.executionTime));
 			return;
 		}
-		CommandManager()->RemovePendingCommand(RPCID);
+		CommandManager()->RemovePendingCommand(SerialNumberInt, RPCID);
 		if (RetryLater) {
 			Logger.information(fmt::format("{},{}: Pending completion.", Cmd.UUID, RPCID));
 			SetCommandStatus(Cmd, Request, Response, Handler,
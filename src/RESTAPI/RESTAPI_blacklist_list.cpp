@@ -5,7 +5,10 @@
 #include "RESTAPI_blacklist_list.h"
 #include "Poco/JSON/Parser.h"
 #include "Poco/JSON/Stringifier.h"
+#include "AP_WS_Server.h"
 #include "StorageService.h"
+#include "framework/ow_constants.h"
+#include "framework/utils.h"
 
 namespace OpenWifi {
 	void RESTAPI_blacklist_list::DoGet() {
@@ -17,9 +20,59 @@ namespace OpenWifi {
 		if (QB_.CountOnly) {
 			auto Count = StorageService()->GetBlackListDeviceCount();
 			return ReturnCountOnly(Count);
+		} else if (GetBoolParameter("export", false)) {
+			StorageService()->ExportBlackListDevices(Devices);
+			return Object("devices", Devices);
 		} else if (StorageService()->GetBlackListDevices(QB_.Offset, QB_.Limit, Devices)) {
 			return Object("devices", Devices);
 		}
 		NotFound();
 	}
+
+	//	Bulk import: {"devices":[{"serialNumber":"...","reason":"..."},...]}. Existing entries are
+	//	replaced, and devices that were not blacklisted before lose their live session.
+	void RESTAPI_blacklist_list::DoPost() {
+		if (!ParsedBody_->has("devices") || !ParsedBody_->isArray("devices")) {
+			return BadRequest(RESTAPI::Errors::MissingOrInvalidParameters);
+		}
+
+		const auto &Entries = *ParsedBody_->getArray("devices");
+		std::vector<GWObjects::BlackListedDevice> Devices;
+		Devices.reserve(Entries.size());
+		auto Now = Utils::Now();
+		for (const auto &Entry : Entries) {
+			if (!Entry.isStruct()) {
+				return BadRequest(RESTAPI::Errors::InvalidJSONDocument);
+			}
+			GWObjects::BlackListedDevice D;
+			if (!D.from_json(Entry.extract<Poco::JSON::Object::Ptr>())) {
+				return BadRequest(RESTAPI::Errors::InvalidJSONDocument);
+			}
+			if (D.serialNumber.empty() || !Utils::NormalizeMac(D.serialNumber)) {
+				return BadRequest(RESTAPI::Errors::InvalidSerialNumber);
+			}
+			D.author = UserInfo_.userinfo.email;
+			D.created = Now;
+			Devices.push_back(std::move(D));
+		}
+
+		poco_debug(Logger(), fmt::format("BLACKLIST-POST: Importing {} devices", Devices.size()));
+
+		std::vector<std::uint64_t> NewlyBlackListed;
+		if (!StorageService()->AddBlackListDevices(Devices, NewlyBlackListed)) {
+			return BadRequest(RESTAPI::Errors::MissingOrInvalidParameters);
+		}
+
+		std::uint64_t Evicted = 0;
+		for (const auto SerialNumber : NewlyBlackListed) {
+			if (AP_WS_Server()->Evict(SerialNumber))
+				++Evicted;
+		}
+
+		Poco::JSON::Object Answer;
+		Answer.set("imported", Devices.size());
+		Answer.set("added", NewlyBlackListed.size());
+		Answer.set("evicted", Evicted);
+		return ReturnObject(Answer);
+	}
 } // namespace OpenWifi
\ No newline at end of file
@@ -14,12 +14,13 @@ namespace OpenWifi {
 							   bool Internal)
 			: RESTAPIHandler(bindings, L,
 							 std::vector<std::string>{Poco::Net::HTTPRequest::HTTP_GET,
+													  Poco::Net::HTTPRequest::HTTP_POST,
 													  Poco::Net::HTTPRequest::HTTP_OPTIONS},
 							 Server, TransactionId, Internal) {}
 		static auto PathName() { return std::list<std::string>{"/api/v1/blacklist"}; }
 		void DoGet() final;
 		void DoDelete() final{};
-		void DoPost() final{};
+		void DoPost() final;
 		void DoPut() final{};
 	};
 } // namespace OpenWifi
@@ -21,9 +21,10 @@ namespace OpenWifi {
 		auto SerialNumber = GetParameter(RESTAPI::Protocol::SERIALNUMBER, "");
 
 		std::string FileType;
+		std::string FilePath;
 		std::string FileContent;
 		int WaitingForFile = 0;
-		if (!StorageService()->GetAttachedFileContent(UUID, SerialNumber, FileContent, FileType, WaitingForFile) && !WaitingForFile) {
+		if (!StorageService()->GetAttachedFile(UUID, SerialNumber, FilePath, FileContent, FileType, WaitingForFile) && !WaitingForFile) {
 			return NotFound();
 		}
 		else if (WaitingForFile) {
@@ -31,18 +32,30 @@ namespace OpenWifi {
 			return Accepted();
 		}
 
+		std::string ContentType{"application/octet-stream"}, Name{UUID + ".bin"};
 		if (FileType == "pcap") {
-			SendFileContent(FileContent, "application/vnd.tcpdump.pcap", UUID + ".pcap");
+			ContentType = "application/vnd.tcpdump.pcap";
+			Name = UUID + ".pcap";
 		}
 		else if (FileType == "tgz" ) {
-			SendFileContent(FileContent, "application/gzip", UUID + ".tgz");
+			ContentType = "application/gzip";
+			Name = UUID + ".tgz";
 		}
 		else if (FileType == "txt") {
-			SendFileContent(FileContent, "txt/plain", UUID + ".txt");
+			ContentType = "txt/plain";
+			Name = UUID + ".txt";
 		}
-		else {
-			SendFileContent(FileContent, "application/octet-stream", UUID + ".bin");
+
+		if (FilePath.empty()) {
+			return SendFileContent(FileContent, ContentType, Name);
+		}
+
+		//	Streamed from the upload directory.
+		Poco::File File(FilePath);
+		if (!File.exists()) {
+			return NotFound();
 		}
+		SendFile(File, ContentType, Name);
 	}
 
 	void RESTAPI_file::DoDelete() {
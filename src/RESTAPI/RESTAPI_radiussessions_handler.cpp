@@ -89,6 +89,13 @@ namespace OpenWifi {
 			return ReturnObject("sessions",L.sessions);
 		}
 
+		auto accountingSessionId = GetParameter("accountingSessionId","");
+		if(!accountingSessionId.empty()) {
+			GWObjects::RADIUSSessionList	L;
+			RADIUSSessionTracker()->GetAccountingSessionIdSessions(accountingSessionId,L);
+			return ReturnObject("sessions",L.sessions);
+		}
+
 		auto SerialNumber = GetBinding("serialNumber","");
 		if(SerialNumber.empty() || !Utils::ValidSerialNumber(SerialNumber)) {
 			return BadRequest(RESTAPI::Errors::MissingOrInvalidParameters);
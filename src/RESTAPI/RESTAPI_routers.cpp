@@ -17,6 +17,7 @@
 #include "RESTAPI/RESTAPI_iptocountry_handler.h"
 #include "RESTAPI/RESTAPI_ouis.h"
 #include "RESTAPI/RESTAPI_radiusProxyConfig_handler.h"
+#include "RESTAPI/RESTAPI_runtimestats_handler.h"
 #include "RESTAPI/RESTAPI_regulatory.h"
 #include "RESTAPI/RESTAPI_script_handler.h"
 #include "RESTAPI/RESTAPI_scripts_handler.h"
@@ -59,6 +60,6 @@ namespace OpenWifi {
 			RESTAPI_iptocountry_handler, RESTAPI_radiusProxyConfig_handler, RESTAPI_scripts_handler,
 			RESTAPI_script_handler, RESTAPI_blacklist_list, RESTAPI_radiussessions_handler,
 			RESTAPI_regulatory, RESTAPI_default_firmwares,
-			RESTAPI_default_firmware>(Path, Bindings, L, S, TransactionId);
+			RESTAPI_default_firmware, RESTAPI_runtimestats_handler>(Path, Bindings, L, S, TransactionId);
 	}
 } // namespace OpenWifi
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "RESTAPI_runtimestats_handler.h"
+#include "AP_WS_Server.h"
+#include "ConnectStage.h"
+#include "RADIUS_proxy_server.h"
+
+namespace OpenWifi {
+
+	void RESTAPI_runtimestats_handler::DoGet() {
+		Poco::JSON::Array Reactors;
+		for (const auto &Stats : AP_WS_Server()->ReactorStats()) {
+			Poco::JSON::Object Reactor;
+			Reactor.set("id", Stats.Id);
+			Reactor.set("connections", Stats.Connections);
+			Reactor.set("messages", Stats.Messages);
+			Reactor.set("bytes", Stats.Bytes);
+			Reactor.set("messageRate", Stats.MessageRate);
+			Reactor.set("byteRate", Stats.ByteRate);
+			Reactor.set("receiveBuffer", Stats.ReceiveBuffer);
+			Reactors.add(Reactor);
+		}
+
+		auto Counters = ConnectStage()->GetCounters();
+		Poco::JSON::Object Connect;
+		Connect.set("queued", Counters.Queued);
+		Connect.set("processed", Counters.Processed);
+		Connect.set("overflow", Counters.Overflow);
+		Connect.set("failed", Counters.Failed);
+		Connect.set("averageLatency", Counters.AverageLatency);
+		Connect.set("maxLatency", Counters.MaxLatency);
+
+		auto Upgrades = AP_WS_Server()->GetUpgradeCounters();
+		Poco::JSON::Object Upgrade;
+		Upgrade.set("admitted", Upgrades.Admitted);
+		Upgrade.set("rejected", Upgrades.Rejected);
+		Upgrade.set("refused", Upgrades.Refused);
+		Upgrade.set("queued", Upgrades.Queued);
+		Upgrade.set("inProgress", Upgrades.InProgress);
+		Upgrade.set("completed", Upgrades.Completed);
+		Upgrade.set("failed", Upgrades.Failed);
+
+		std::vector<RADIUS_proxy_server::RouteCounters> Routes;
+		RADIUS_proxy_server()->GetRouteCounters(Routes);
+		Poco::JSON::Array Destinations;
+		for (const auto &Route : Routes) {
+			Poco::JSON::Object Destination;
+			Destination.set("name", Route.Name);
+			Destination.set("poolProxyIp", Route.ProxyIp);
+			Destination.set("authentication", Route.Authentication);
+			Destination.set("accounting", Route.Accounting);
+			Destination.set("coa", Route.CoA);
+			Destination.set("bytes", Route.Bytes);
+			Destination.set("failed", Route.Failed);
+			Destinations.add(Destination);
+		}
+		Poco::JSON::Object Radius;
+		Radius.set("unrouted", RADIUS_proxy_server()->Unrouted());
+		Radius.set("destinations", Destinations);
+
+		Poco::JSON::Object Answer;
+		Answer.set("reactors", Reactors);
+		Answer.set("connectStage", Connect);
+		Answer.set("upgrades", Upgrade);
+		Answer.set("radiusProxy", Radius);
+		return ReturnObject(Answer);
+	}
+
+} // namespace OpenWifi
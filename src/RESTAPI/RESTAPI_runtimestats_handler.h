@@ -0,0 +1,24 @@
+#pragma once
+
+#include "framework/RESTAPI_Handler.h"
+
+namespace OpenWifi {
+
+	//	Runtime figures of the device pipeline: reactors, connect stage, websocket upgrades and RADIUS
+	//	proxy routes. Only routed on the internal API.
+	class RESTAPI_runtimestats_handler : public RESTAPIHandler {
+	  public:
+		RESTAPI_runtimestats_handler(const RESTAPIHandler::BindingMap &bindings, Poco::Logger &L,
+									 RESTAPI_GenericServerAccounting &Server, uint64_t TransactionId,
+									 bool Internal)
+			: RESTAPIHandler(bindings, L,
+							 std::vector<std::string>{Poco::Net::HTTPRequest::HTTP_GET,
+													  Poco::Net::HTTPRequest::HTTP_OPTIONS},
+							 Server, TransactionId, Internal){};
+		static auto PathName() { return std::list<std::string>{"/api/v1/runtimeStats"}; };
+		void DoGet() final;
+		void DoDelete() final{};
+		void DoPost() final{};
+		void DoPut() final{};
+	};
+} // namespace OpenWifi
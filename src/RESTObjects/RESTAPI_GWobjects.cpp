@@ -300,6 +300,10 @@ namespace OpenWifi::GWObjects {
 		field_to_json(Obj, "connectReason", connectReason);
 		field_to_json(Obj, "uptime", uptime);
         field_to_json(Obj, "compatible", Compatible);
+		field_to_json(Obj, "txQueuedFrames", txQueuedFrames);
+		field_to_json(Obj, "txQueuedBytes", txQueuedBytes);
+		field_to_json(Obj, "txQueueHighWater", txQueueHighWater);
+		field_to_json(Obj, "txDroppedFrames", txDroppedFrames);
 
 #ifdef TIP_GATEWAY_SERVICE
 		hasRADIUSSessions = RADIUSSessionTracker()->HasSessions(SerialNumber);
@@ -367,6 +371,10 @@ namespace OpenWifi::GWObjects {
             field_from_json(Obj, "sanity", sanity);
             field_from_json(Obj, "load", load);
             field_from_json(Obj, "temperature", temperature);
+            field_from_json(Obj, "txQueuedFrames", txQueuedFrames);
+            field_from_json(Obj, "txQueuedBytes", txQueuedBytes);
+            field_from_json(Obj, "txQueueHighWater", txQueueHighWater);
+            field_from_json(Obj, "txDroppedFrames", txDroppedFrames);
             return true;
         } catch(const Poco::Exception &E) {
         }
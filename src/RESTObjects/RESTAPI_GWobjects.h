@@ -51,6 +51,10 @@ namespace OpenWifi::GWObjects {
 		std::string 	connectReason;
 		std::uint64_t 	uptime=0;
         std::uint64_t 	totalConnectionTime=0;
+		std::uint64_t 	txQueuedFrames=0;
+		std::uint64_t 	txQueuedBytes=0;
+		std::uint64_t 	txQueueHighWater=0;
+		std::uint64_t 	txDroppedFrames=0;
 
 		void to_json(const std::string &SerialNumber, Poco::JSON::Object &Obj) ;
         bool from_json(const Poco::JSON::Object::Ptr &Obj);
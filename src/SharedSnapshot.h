@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace OpenWifi {
+
+	//	A read mostly table published as an immutable snapshot. Every thread keeps its own reference
+	//	to the last snapshot it read, and only goes back to the shared copy, under the mutex, when
+	//	the generation number says a newer one was published. The common read is then an atomic load
+	//	and a compare: no lock, and no reference count shared with the other threads.
+	//
+	//	The per-thread reference is shared by all the instances of SharedSnapshot<T>, so this is meant
+	//	for the few process wide tables. The reference returned by Get() is valid until the same thread
+	//	calls Get() again on a SharedSnapshot<T>. A thread that stops reading keeps its last snapshot
+	//	alive until it exits.
+	template <typename T> class SharedSnapshot {
+	  public:
+		SharedSnapshot() : Current_(std::make_shared<const T>()), Generation_(NextGeneration()) {}
+
+		[[nodiscard]] const T &Get() const {
+			auto &Cache = ThreadCache();
+			auto Generation = Generation_.load(std::memory_order_acquire);
+			if (Cache.Generation != Generation) {
+				std::lock_guard G(Mutex_);
+				Cache.Value = Current_;
+				Cache.Generation = Generation_.load(std::memory_order_relaxed);
+			}
+			return *Cache.Value;
+		}
+
+		//	For the rare readers that hold the table across other calls, such as an export.
+		[[nodiscard]] std::shared_ptr<const T> Load() const {
+			std::lock_guard G(Mutex_);
+			return Current_;
+		}
+
+		void Publish(std::shared_ptr<const T> Next) {
+			std::lock_guard W(WriteMutex_);
+			Swap(std::move(Next));
+		}
+
+		//	Writers are serialised: copy the current table, change the copy and publish it.
+		template <typename Func> void Update(Func &&Change) {
+			std::lock_guard W(WriteMutex_);
+			auto Next = std::make_shared<T>(*Load());
+			Change(*Next);
+			Swap(std::move(Next));
+		}
+
+	  private:
+		struct Cached {
+			std::uint64_t 				Generation = 0;
+			std::shared_ptr<const T> 	Value;
+		};
+
+		mutable std::mutex 			Mutex_;
+		std::mutex 					WriteMutex_;
+		std::shared_ptr<const T> 	Current_;
+		std::atomic_uint64_t 		Generation_;
+
+		void Swap(std::shared_ptr<const T> Next) {
+			std::lock_guard G(Mutex_);
+			Current_ = std::move(Next);
+			Generation_.store(NextGeneration(), std::memory_order_release);
+		}
+
+		static Cached &ThreadCache() {
+			thread_local Cached Cache;
+			return Cache;
+		}
+
+		//	Unique over every instance, so a cached generation can never match another table.
+		static std::uint64_t NextGeneration() {
+			static std::atomic_uint64_t Generation = 0;
+			return ++Generation;
+		}
+	};
+
+} // namespace OpenWifi
@@ -5,6 +5,8 @@
 #include "StateUtils.h"
 #include "Poco/JSON/Parser.h"
 
+#include <sstream>
+
 namespace OpenWifi::StateUtils {
 
 	static int ChannelToBand(uint64_t C) {
@@ -101,4 +103,26 @@ namespace OpenWifi::StateUtils {
 		}
 		return false;
 	}
+
+	std::string StringifyWithRawMember(const Poco::JSON::Object::Ptr &Obj, const std::string &Key,
+									   const std::string &RawValue) {
+		Poco::JSON::Object Others;
+		for (const auto &[Name, Value] : *Obj) {
+			if (Name != Key)
+				Others.set(Name, Value);
+		}
+		std::ostringstream OS;
+		Others.stringify(OS);
+		auto Result = OS.str();
+		Result.pop_back(); //	remove the closing brace
+		Result.reserve(Result.size() + Key.size() + RawValue.size() + 5);
+		if (Result.size() > 1)
+			Result += ',';
+		Result += '"';
+		Result += Key;
+		Result += "\":";
+		Result += RawValue;
+		Result += '}';
+		return Result;
+	}
 } // namespace OpenWifi::StateUtils
\ No newline at end of file
@@ -4,9 +4,16 @@
 
 #pragma once
 
+#include <string>
+
 #include "Poco/JSON/Object.h"
 
 namespace OpenWifi::StateUtils {
 	bool ComputeAssociations(const Poco::JSON::Object::Ptr RawObject, uint64_t &Radios_2G,
 							 uint64_t &Radios_5G, uint64_t &Radio_6G, uint64_t &UpTime);
+
+	//	Stringify Obj, using RawValue (already serialized JSON) as the value of Key so that a
+	//	large member is not serialized a second time.
+	std::string StringifyWithRawMember(const Poco::JSON::Object::Ptr &Obj, const std::string &Key,
+									   const std::string &RawValue);
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "StatsWriter.h"
+#include "StorageService.h"
+
+#include <fmt/format.h>
+#include <framework/MicroServiceFuncs.h>
+#include <framework/utils.h>
+
+namespace OpenWifi {
+
+	int StatsWriter::Start() {
+		poco_information(Logger(), "Starting...");
+		BatchSize_ = MicroServiceConfigGetInt("storage.writer.batchsize", 200);
+		FlushInterval_ = MicroServiceConfigGetInt("storage.writer.interval", 1000);
+		MaxQueued_ = MicroServiceConfigGetInt("storage.writer.maxqueue", 50000);
+		if (BatchSize_ == 0)
+			BatchSize_ = 1;
+		if (FlushInterval_ == 0)
+			FlushInterval_ = 1000;
+		Statistics_.reserve(BatchSize_);
+		HealthChecks_.reserve(BatchSize_);
+		Running_ = true;
+		Worker_.start(*this);
+		return 0;
+	}
+
+	void StatsWriter::Stop() {
+		poco_information(Logger(), "Stopping...");
+		{
+			std::lock_guard G(QueueMutex_);
+			Running_ = false;
+		}
+		QueueCondition_.notify_all();
+		Worker_.join();
+		poco_information(Logger(),
+						 fmt::format("Stopped... Written={} Shed={} Failed={}", (std::uint64_t)Written_,
+									 (std::uint64_t)Shed_, (std::uint64_t)Failed_));
+	}
+
+	bool StatsWriter::AddStatistics(const GWObjects::Statistics &Stats) {
+		{
+			std::lock_guard G(QueueMutex_);
+			if (!Running_ || (Statistics_.size() + HealthChecks_.size()) >= MaxQueued_) {
+				++Shed_;
+				return false;
+			}
+			Statistics_.emplace_back(Stats);
+			if (Statistics_.size() < BatchSize_)
+				return true;
+		}
+		QueueCondition_.notify_one();
+		return true;
+	}
+
+	bool StatsWriter::AddHealthCheck(const GWObjects::HealthCheck &Check) {
+		{
+			std::lock_guard G(QueueMutex_);
+			if (!Running_ || (Statistics_.size() + HealthChecks_.size()) >= MaxQueued_) {
+				++Shed_;
+				return false;
+			}
+			HealthChecks_.emplace_back(Check);
+			if (HealthChecks_.size() < BatchSize_)
+				return true;
+		}
+		QueueCondition_.notify_one();
+		return true;
+	}
+
+	void StatsWriter::Flush(std::vector<GWObjects::Statistics> &Stats,
+							std::vector<GWObjects::HealthCheck> &Checks) {
+		if (Stats.empty() && Checks.empty())
+			return;
+
+		try {
+			Poco::Data::Session Session(StorageService()->Pool().get());
+			if (!Stats.empty()) {
+				if (StorageService()->AddStatisticsData(Session, Stats))
+					Written_ += Stats.size();
+				else
+					Failed_ += Stats.size();
+			}
+			if (!Checks.empty()) {
+				if (StorageService()->AddHealthCheckData(Session, Checks))
+					Written_ += Checks.size();
+				else
+					Failed_ += Checks.size();
+			}
+		} catch (const Poco::Exception &E) {
+			Failed_ += Stats.size() + Checks.size();
+			Logger().log(E);
+		} catch (...) {
+			Failed_ += Stats.size() + Checks.size();
+			poco_warning(Logger(), "Exception occurred during flush.");
+		}
+	}
+
+	void StatsWriter::run() {
+		Utils::SetThreadName("db:writer");
+
+		std::vector<GWObjects::Statistics> Stats;
+		std::vector<GWObjects::HealthCheck> Checks;
+		Stats.reserve(BatchSize_);
+		Checks.reserve(BatchSize_);
+		auto LastReport = Utils::Now();
+
+		while (true) {
+			bool Stopping;
+			{
+				std::unique_lock Lock(QueueMutex_);
+				QueueCondition_.wait_for(Lock, std::chrono::milliseconds(FlushInterval_), [this] {
+					return !Running_ || Statistics_.size() >= BatchSize_ ||
+						   HealthChecks_.size() >= BatchSize_;
+				});
+				Stats.swap(Statistics_);
+				Checks.swap(HealthChecks_);
+				Stopping = !Running_;
+			}
+
+			Flush(Stats, Checks);
+			Stats.clear();
+			Checks.clear();
+
+			if (Stopping)
+				break;
+
+			auto Now = Utils::Now();
+			if ((Now - LastReport) > 60) {
+				LastReport = Now;
+				poco_information(Logger(),
+								 fmt::format("Written={} Shed={} Failed={}", (std::uint64_t)Written_,
+											 (std::uint64_t)Shed_, (std::uint64_t)Failed_));
+			}
+		}
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#include <RESTObjects/RESTAPI_GWobjects.h>
+#include <framework/SubSystemServer.h>
+
+namespace OpenWifi {
+
+	//	Write-behind stage for statistics and healthcheck records. Device reactors only append to
+	//	a bounded queue, a single writer thread groups the records into multi-row INSERTs.
+	class StatsWriter : public SubSystemServer, Poco::Runnable {
+	  public:
+		static auto instance() {
+			static auto instance_ = new StatsWriter;
+			return instance_;
+		}
+
+		int Start() override;
+		void Stop() override;
+		void run() final;
+
+		bool AddStatistics(const GWObjects::Statistics &Stats);
+		bool AddHealthCheck(const GWObjects::HealthCheck &Check);
+
+		inline void GetCounters(std::uint64_t &Queued, std::uint64_t &Written,
+								std::uint64_t &Shed, std::uint64_t &Failed) {
+			{
+				std::lock_guard G(QueueMutex_);
+				Queued = Statistics_.size() + HealthChecks_.size();
+			}
+			Written = Written_;
+			Shed = Shed_;
+			Failed = Failed_;
+		}
+
+	  private:
+		std::mutex 								QueueMutex_;
+		std::condition_variable 				QueueCondition_;
+		std::vector<GWObjects::Statistics> 		Statistics_;
+		std::vector<GWObjects::HealthCheck> 	HealthChecks_;
+		Poco::Thread 							Worker_;
+		std::atomic_bool 						Running_ = false;
+
+		std::uint64_t 							BatchSize_ = 200;
+		std::uint64_t 							FlushInterval_ = 1000; 	//	milliseconds
+		std::uint64_t 							MaxQueued_ = 50000;
+
+		std::atomic_uint64_t 					Written_ = 0;
+		std::atomic_uint64_t 					Shed_ = 0;
+		std::atomic_uint64_t 					Failed_ = 0;
+
+		void Flush(std::vector<GWObjects::Statistics> &Stats,
+				   std::vector<GWObjects::HealthCheck> &Checks);
+
+		StatsWriter() noexcept
+			: SubSystemServer("StatsWriter", "STATS-WRITER", "storage.writer") {}
+	};
+
+	inline auto StatsWriter() { return StatsWriter::instance(); }
+
+} // namespace OpenWifi
@@ -99,6 +99,9 @@ namespace OpenWifi {
 			return R;
 		}
 
+		//	Keeps multi-row INSERTs under the bound parameter limits of all supported databases.
+		static constexpr std::size_t MaxRowsPerInsert = 100;
+
 		static auto instance() {
 			static auto instance_ = new Storage;
 			return instance_;
@@ -109,6 +112,7 @@ namespace OpenWifi {
 		bool AddLog(LockedDbSession &Session, const GWObjects::DeviceLog &Log);
 		bool AddStatisticsData(Poco::Data::Session &Session, const GWObjects::Statistics &Stats);
 		bool AddStatisticsData(const GWObjects::Statistics &Stats);
+		bool AddStatisticsData(Poco::Data::Session &Session, std::vector<GWObjects::Statistics> &Stats);
 		bool GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							   uint64_t Offset, uint64_t HowMany,
 							   std::vector<GWObjects::Statistics> &Stats);
@@ -120,6 +124,7 @@ namespace OpenWifi {
 
 		bool AddHealthCheckData(const GWObjects::HealthCheck &Check);
 		bool AddHealthCheckData(LockedDbSession &Session, const GWObjects::HealthCheck &Check);
+		bool AddHealthCheckData(Poco::Data::Session &Session, std::vector<GWObjects::HealthCheck> &Checks);
 		bool GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 								uint64_t Offset, uint64_t HowMany,
 								std::vector<GWObjects::HealthCheck> &Checks);
@@ -232,18 +237,21 @@ namespace OpenWifi {
 		bool UpdateCommand(std::string &UUID, GWObjects::CommandDetails &Command);
 		bool GetCommand(const std::string &UUID, GWObjects::CommandDetails &Command);
 		bool DeleteCommand(std::string &UUID);
-		bool GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
-									   std::vector<GWObjects::CommandDetails> &Commands);
+		bool GetQueuedCommands(std::uint64_t SubmittedSince,
+							   std::vector<GWObjects::CommandDetails> &Commands);
 		bool CommandExecuted(std::string &UUID);
 		bool SetCommandLastTry(std::string &UUID);
 		bool CommandCompleted(std::string &UUID, Poco::JSON::Object::Ptr ReturnVars,
 							  const std::chrono::duration<double, std::milli> &execution_time,
 							  bool FullCommand);
-		bool AttachFileDataToCommand(std::string &UUID, const std::stringstream &s,
-									 const std::string &Type);
+		bool AttachFileDataToCommand(std::string &UUID, const std::string &FileName,
+									 std::uint64_t Size, const std::string &Type);
+		bool AttachFileContentToCommand(std::string &UUID, const std::string &Content,
+										const std::string &Type);
 		bool CancelWaitFile(std::string &UUID, std::string &ErrorText);
-		bool GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-									std::string &FileContent, std::string &Type, int& WaitingForFile);
+		bool GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+							 std::string &FilePath, std::string &FileContent, std::string &Type,
+							 int &WaitingForFile);
 		bool RemoveAttachedFile(std::string &UUID);
 		bool SetCommandResult(std::string &UUID, std::string &Result);
 		bool GetNewestCommands(std::string &SerialNumber, uint64_t HowMany,
@@ -257,7 +265,9 @@ namespace OpenWifi {
 
 		bool RemoveOldCommands(std::string &SerialNumber, std::string &Command);
 
-		bool AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices);
+		bool AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices,
+								 std::vector<std::uint64_t> &NewlyBlackListed);
+		bool ExportBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices);
 		bool AddBlackListDevice(GWObjects::BlackListedDevice &Device);
 		bool GetBlackListDevice(std::string &SerialNumber, GWObjects::BlackListedDevice &Device);
 		bool DeleteBlackListDevice(std::string &SerialNumber);
@@ -281,6 +291,7 @@ namespace OpenWifi {
 		bool SetDeviceLastRecordedContact(LockedDbSession &Session, std::string & SerialNumber, std::uint64_t lastRecordedContact);
 		bool SetDeviceLastRecordedContact(std::string & SerialNumber, std::uint64_t lastRecordedContact);
 		bool SetDeviceLastRecordedContact(Poco::Data::Session & Session, std::string & SerialNumber, std::uint64_t lastRecordedContact);
+		bool SetDeviceLocale(std::string &SerialNumber, std::string &Locale);
 
 		int Create_Tables();
 		int Create_Statistics();
@@ -77,17 +77,35 @@ namespace OpenWifi {
 		poco_information(Logger_, "Starting...");
 
 		Utils::SetThreadName("Kafka:Prod");
+		//	No per-message flush: librdkafka groups messages per partition for up to linger.ms
+		//	or batch.num.messages, whichever comes first.
 		cppkafka::Configuration Config(
 			{{"client.id", MicroServiceConfigGetString("openwifi.kafka.client.id", "")},
-			 {"metadata.broker.list",MicroServiceConfigGetString("openwifi.kafka.brokerlist", "")} // ,
+			 {"metadata.broker.list",MicroServiceConfigGetString("openwifi.kafka.brokerlist", "")},
+			 {"linger.ms", MicroServiceConfigGetString("openwifi.kafka.queue.buffering.max.ms", "50")},
+			 {"batch.num.messages", MicroServiceConfigGetString("openwifi.kafka.producer.batch.messages", "10000")},
+			 {"queue.buffering.max.messages", MicroServiceConfigGetString("openwifi.kafka.producer.buffer.messages", "100000")} // ,
 			 // {"send.buffer.bytes", KafkaManager()->KafkaManagerMaximumPayloadSize() }
 			}
  		);
 
+		//	Messages are keyed by serial number: the partitioner hashes the key so all messages
+		//	from one device land on the same partition, in order.
+		cppkafka::TopicConfiguration TopicConfig = {
+			{"partitioner", MicroServiceConfigGetString("openwifi.kafka.producer.partitioner", "murmur2_random")}};
+		Config.set_default_topic_configuration(TopicConfig);
+
 		AddKafkaSecurity(Config);
 
 		Config.set_log_callback(KafkaLoggerFun);
 		Config.set_error_callback(KafkaErrorFun);
+		Config.set_delivery_report_callback(
+			[this](cppkafka::Producer &, const cppkafka::Message &Msg) {
+				if (Msg.get_error())
+					++Failed_;
+				else
+					++Delivered_;
+			});
 
 		KafkaManager()->SystemInfoWrapper_ =
 			R"lit({ "system" : { "id" : )lit" + std::to_string(MicroServiceID()) +
@@ -97,32 +115,36 @@ namespace OpenWifi {
 		cppkafka::Producer Producer(Config);
 		Running_ = true;
 
-		Poco::AutoPtr<Poco::Notification> Note(Queue_.waitDequeueNotification());
-		while (Note && Running_) {
+		auto LastReport = Utils::Now();
+		while (Running_) {
+			//	The timeout keeps delivery reports flowing while the queue is idle.
+			Poco::AutoPtr<Poco::Notification> Note(Queue_.waitDequeueNotification(100));
+			if (Note) {
+				SpaceAvailable_.notify_one();
+			}
 			try {
 				auto Msg = dynamic_cast<KafkaMessage *>(Note.get());
 				if (Msg != nullptr) {
 					auto NewMessage = cppkafka::MessageBuilder(Msg->Topic());
 					NewMessage.key(Msg->Key());
-					NewMessage.partition(0);
 					NewMessage.payload(Msg->Payload());
-					Producer.produce(NewMessage);
-					if (Queue_.size() < 100) {
-						// use flush when internal queue is lightly loaded, i.e. flush after each
-						// message
-						Producer.flush();
-					}
-					else {
-						// use poll when internal queue is loaded to allow messages to be sent in
-						// batches
-						Producer.poll((std::chrono::milliseconds) 0);
+					while (true) {
+						try {
+							Producer.produce(NewMessage);
+							++Produced_;
+							break;
+						} catch (const cppkafka::HandleException &E) {
+							//	librdkafka's own buffer is full: serve delivery reports to make room.
+							if (E.get_error().get_error() != RD_KAFKA_RESP_ERR__QUEUE_FULL ||
+								!Running_)
+								throw;
+							Producer.poll(std::chrono::milliseconds(10));
+						}
 					}
 				}
-				if (Queue_.size() == 0) {
-					// message queue is empty, flush all previously sent messages
-					Producer.flush();
-				}
+				Producer.poll(std::chrono::milliseconds(0));
 			} catch (const cppkafka::HandleException &E) {
+				++Failed_;
 				poco_warning(Logger_,
 							 fmt::format("Caught a Kafka exception (producer): {}", E.what()));
 			} catch (const Poco::Exception &E) {
@@ -130,8 +152,18 @@ namespace OpenWifi {
 			} catch (...) {
 				poco_error(Logger_, "std::exception");
 			}
-			Note = Queue_.waitDequeueNotification();
+
+			auto Now = Utils::Now();
+			if ((Now - LastReport) > 60) {
+				LastReport = Now;
+				poco_information(
+					Logger_, fmt::format("Queued={} Produced={} Delivered={} Failed={} Dropped={} Blocked={}",
+										 Queue_.size(), (std::uint64_t)Produced_,
+										 (std::uint64_t)Delivered_, (std::uint64_t)Failed_,
+										 (std::uint64_t)Dropped_, (std::uint64_t)Blocked_));
+			}
 		}
+		SpaceAvailable_.notify_all();
 		Producer.flush();
 		poco_information(Logger_, "Stopped...");
 	}
@@ -148,7 +180,7 @@ namespace OpenWifi {
 			{{"client.id", MicroServiceConfigGetString("openwifi.kafka.client.id", "")},
 			 {"metadata.broker.list", MicroServiceConfigGetString("openwifi.kafka.brokerlist", "")},
 			 {"group.id", MicroServiceConfigGetString("openwifi.kafka.group.id", "")},
-			 {"enable.auto.commit", MicroServiceConfigGetBool("openwifi.kafka.auto.commit", false)},
+			 {"enable.auto.commit", AutoCommit_},
 			 {"auto.offset.reset", "latest"},
 			 {"enable.partition.eof", false}});
 
@@ -156,6 +188,11 @@ namespace OpenWifi {
 
 		Config.set_log_callback(KafkaLoggerFun);
 		Config.set_error_callback(KafkaErrorFun);
+		Config.set_offset_commit_callback(
+			[this](cppkafka::Consumer &, cppkafka::Error Error, const cppkafka::TopicPartitionList &) {
+				if (Error)
+					++CommitsFailed_;
+			});
 
 		cppkafka::TopicConfiguration topic_config = {{"auto.offset.reset", "smallest"}};
 
@@ -169,45 +206,47 @@ namespace OpenWifi {
 													  partitions.front().get_partition()));
 			}
 		});
+		//	Called on this thread from within poll: finish what the workers hold and commit it
+		//	before the partitions go to another member of the group.
 		Consumer.set_revocation_callback([&](const cppkafka::TopicPartitionList &partitions) {
 			if (!partitions.empty()) {
 				poco_information(Logger_, fmt::format("Partition revocation: {}...",
 													  partitions.front().get_partition()));
 			}
+			Drain();
+			Commit(Consumer, true, Logger_);
 		});
 
-		// bool AutoCommit = MicroServiceConfigGetBool("openwifi.kafka.auto.commit", false);
-		// auto BatchSize = MicroServiceConfigGetInt("openwifi.kafka.consumer.batchsize", 100);
-
 		Types::StringVec Topics;
 		std::for_each(Topics_.begin(),Topics_.end(),
 					  [&](const std::string & T) { Topics.emplace_back(T); });
 		Consumer.subscribe(Topics);
 
 		Running_ = true;
-		std::vector<cppkafka::Message> MsgVec;
 
 		Dispatcher_ = std::make_unique<cppkafka::ConsumerDispatcher>(Consumer);
 
+		auto LastReport = Utils::Now();
+		auto Report = [&]() {
+			auto Now = Utils::Now();
+			if ((Now - LastReport) > 60) {
+				LastReport = Now;
+				std::uint64_t Received, Processed, Failed, Commits, CommitsFailed, Queued;
+				GetCounters(Received, Processed, Failed, Commits, CommitsFailed, Queued);
+				poco_information(
+					Logger_, fmt::format("Received={} Processed={} Failed={} Queued={} Commits={} "
+										 "CommitsFailed={}",
+										 Received, Processed, Failed, Queued, Commits, CommitsFailed));
+			}
+		};
+
 		Dispatcher_->run(
 			// Callback executed whenever a new message is consumed
 			[&](cppkafka::Message msg) {
-				// Print the key (if any)
-				std::lock_guard G(ConsumerMutex_);
-				auto It = Notifiers_.find(msg.get_topic());
-				if (It != Notifiers_.end()) {
-					const auto &FL = It->second;
-					for (const auto &[CallbackFunc, _] : FL) {
-						try {
-							CallbackFunc(msg.get_key(), msg.get_payload());
-						} catch(const Poco::Exception &E) {
-
-						} catch(...) {
-
-						}
-					}
-				}
-				Consumer.commit(msg);
+				++Received_;
+				Enqueue(std::move(msg));
+				CommitIfDue(Consumer, Logger_);
+				Report();
 			},
 			// Whenever there's an error (other than the EOF soft error)
 			[&Logger_](cppkafka::Error error) {
@@ -216,15 +255,138 @@ namespace OpenWifi {
 			// Whenever EOF is reached on a partition, print this
 			[&Logger_](cppkafka::ConsumerDispatcher::EndOfFile, const cppkafka::TopicPartition& topic_partition) {
 				poco_debug(Logger_,fmt::format("Partition {} EOF", topic_partition.get_partition()));
+			},
+			// Nothing arrived during the poll timeout: commit what the workers finished meanwhile
+			[&](cppkafka::ConsumerDispatcher::Timeout) {
+				CommitIfDue(Consumer, Logger_);
+				Report();
 			}
 		);
 
+		Drain();
+		Commit(Consumer, true, Logger_);
+		StopWorkers();
 		Consumer.unsubscribe();
 		poco_information(Logger_, "Stopped...");
 	}
 
+	//	Routes by topic and partition. When the worker is full, this blocks the dispatcher instead
+	//	of dropping: Kafka keeps the backlog and nothing is committed past an unprocessed message.
+	void KafkaConsumer::Enqueue(cppkafka::Message Msg) {
+		auto &Target = *Workers_[KafkaOffsetTracker::Route(Msg.get_topic(), Msg.get_partition(),
+														   Workers_.size())];
+		{
+			std::unique_lock Lock(Target.Mutex_);
+			Target.Condition_.wait(Lock, [&] {
+				return !Running_ || Target.Messages_.size() < MaxQueued_;
+			});
+			Target.Messages_.emplace_back(std::move(Msg));
+		}
+		Target.Condition_.notify_all();
+	}
+
+	void KafkaConsumer::Dispatch(const cppkafka::Message &Msg) {
+		{
+			std::shared_lock G(ConsumerMutex_);
+			auto It = Notifiers_.find(Msg.get_topic());
+			if (It != Notifiers_.end()) {
+				const auto &FL = It->second;
+				for (const auto &[CallbackFunc, _] : FL) {
+					try {
+						CallbackFunc(Msg.get_key(), Msg.get_payload());
+					} catch (...) {
+						++Failed_;
+					}
+				}
+			}
+		}
+		++Processed_;
+		if (!AutoCommit_)
+			Offsets_.Processed(Msg.get_topic(), Msg.get_partition(), Msg.get_offset());
+	}
+
+	//	Waits until every worker is idle with an empty queue.
+	void KafkaConsumer::Drain() {
+		for (auto &W : Workers_) {
+			std::unique_lock Lock(W->Mutex_);
+			W->Condition_.wait(Lock, [&] { return W->Messages_.empty() && !W->Busy_; });
+		}
+	}
+
+	void KafkaConsumer::StopWorkers() {
+		for (auto &W : Workers_) {
+			{
+				std::lock_guard G(W->Mutex_);
+				W->Stopping_ = true;
+			}
+			W->Condition_.notify_all();
+		}
+		for (auto &W : Workers_) {
+			W->Thread_.join();
+		}
+	}
+
+	void KafkaConsumer::Commit(cppkafka::Consumer &Consumer, bool Synchronous,
+							   Poco::Logger &Logger) {
+		if (AutoCommit_)
+			return;
+		auto Offsets = Offsets_.Take(std::chrono::steady_clock::now());
+		if (Offsets.empty())
+			return;
+
+		cppkafka::TopicPartitionList Partitions;
+		Partitions.reserve(Offsets.size());
+		for (const auto &[TopicPartition, Offset] : Offsets)
+			Partitions.emplace_back(TopicPartition.first, TopicPartition.second, Offset);
+		try {
+			if (Synchronous)
+				Consumer.commit(Partitions);
+			else
+				Consumer.async_commit(Partitions);
+			++Commits_;
+		} catch (const cppkafka::HandleException &E) {
+			++CommitsFailed_;
+			poco_warning(Logger, fmt::format("Offset commit failed: {}", E.what()));
+			Offsets_.Restore(Offsets);
+		}
+	}
+
+	void KafkaConsumer::CommitIfDue(cppkafka::Consumer &Consumer, Poco::Logger &Logger) {
+		if (AutoCommit_)
+			return;
+		if (Offsets_.Due(std::chrono::steady_clock::now()))
+			Commit(Consumer, false, Logger);
+	}
+
+	void KafkaConsumer::Worker::run() {
+		Utils::SetThreadName(fmt::format("Kafka:Cons:{}", Id_).c_str());
+
+		std::deque<cppkafka::Message> Batch;
+		while (true) {
+			{
+				std::unique_lock Lock(Mutex_);
+				Busy_ = false;
+				Condition_.notify_all();
+				Condition_.wait(Lock, [this] { return Stopping_ || !Messages_.empty(); });
+				if (Messages_.empty())
+					break;
+				Batch.swap(Messages_);
+				Busy_ = true;
+			}
+			Condition_.notify_all();
+
+			for (const auto &Msg : Batch) {
+				Consumer_.Dispatch(Msg);
+			}
+			Batch.clear();
+		}
+	}
+
 	void KafkaProducer::Start() {
 		if (!Running_) {
+			MaxQueued_ = MicroServiceConfigGetInt("openwifi.kafka.producer.queue.max", 50000);
+			BlockWhenFull_ = MicroServiceConfigGetString("openwifi.kafka.producer.queue.policy", "drop") == "block";
+			BlockTime_ = MicroServiceConfigGetInt("openwifi.kafka.producer.queue.block.ms", 100);
 			Running_ = true;
 			Worker_.start(*this);
 		}
@@ -232,20 +394,55 @@ namespace OpenWifi {
 
 	void KafkaProducer::Stop() {
 		if (Running_) {
-			Running_ = false;
+			{
+				std::lock_guard G(Mutex_);
+				Running_ = false;
+			}
+			SpaceAvailable_.notify_all();
 			Queue_.wakeUpAll();
 			Worker_.join();
 		}
 	}
 
-	void KafkaProducer::Produce(const char *Topic, const std::string &Key,
+	bool KafkaProducer::Produce(const char *Topic, const std::string &Key,
 								const std::string &Payload) {
-		std::lock_guard G(Mutex_);
+		std::unique_lock G(Mutex_);
+		if (MaxQueued_ && Queue_.size() >= MaxQueued_) {
+			if (BlockWhenFull_) {
+				++Blocked_;
+				SpaceAvailable_.wait_for(G, std::chrono::milliseconds(BlockTime_), [this] {
+					return !Running_ || Queue_.size() < MaxQueued_;
+				});
+			}
+			if (Queue_.size() >= MaxQueued_) {
+				++Dropped_;
+				return false;
+			}
+		}
 		Queue_.enqueueNotification(new KafkaMessage(Topic, Key, Payload));
+		return true;
 	}
 
 	void KafkaConsumer::Start() {
 		if (!Running_) {
+			AutoCommit_ = MicroServiceConfigGetBool("openwifi.kafka.auto.commit", false);
+			Offsets_.Configure(
+				MicroServiceConfigGetInt("openwifi.kafka.consumer.commit.batch", 1000),
+				MicroServiceConfigGetInt("openwifi.kafka.consumer.commit.interval", 1000),
+				std::chrono::steady_clock::now());
+			MaxQueued_ = MicroServiceConfigGetInt("openwifi.kafka.consumer.queue.max", 1000);
+			auto NumberOfWorkers = MicroServiceConfigGetInt("openwifi.kafka.consumer.workers", 4);
+			if (NumberOfWorkers == 0)
+				NumberOfWorkers = 1;
+			if (MaxQueued_ == 0)
+				MaxQueued_ = 1;
+			{
+				std::lock_guard G(WorkersMutex_);
+				for (std::uint64_t i = 0; i < NumberOfWorkers; ++i) {
+					Workers_.emplace_back(std::make_unique<Worker>(*this, i));
+					Workers_.back()->Thread_.start(*Workers_.back());
+				}
+			}
 			Worker_.start(*this);
 		}
 	}
@@ -256,13 +453,25 @@ namespace OpenWifi {
 			if(Dispatcher_) {
 				Dispatcher_->stop();
 			}
+			//	Wakes the dispatcher if it is waiting for room in a worker queue.
+			for (auto &W : Workers_) {
+				{
+					std::lock_guard G(W->Mutex_);
+				}
+				W->Condition_.notify_all();
+			}
 			Worker_.join();
+			//	The dispatcher has stopped, nothing else walks the list now. The workers are normally
+			//	joined by then, but not when the dispatcher failed before running.
+			StopWorkers();
+			std::lock_guard G(WorkersMutex_);
+			Workers_.clear();
 		}
 	}
 
 	std::uint64_t KafkaConsumer::RegisterTopicWatcher(const std::string &Topic,
 											   Types::TopicNotifyFunction &F) {
-		std::lock_guard G(ConsumerMutex_);
+		std::unique_lock G(ConsumerMutex_);
 		auto It = Notifiers_.find(Topic);
 		if (It == Notifiers_.end()) {
 			Types::TopicNotifyFunctionList L;
@@ -276,7 +485,7 @@ namespace OpenWifi {
 	}
 
 	void KafkaConsumer::UnregisterTopicWatcher(const std::string &Topic, int Id) {
-		std::lock_guard G(ConsumerMutex_);
+		std::unique_lock G(ConsumerMutex_);
 		auto It = Notifiers_.find(Topic);
 		if (It != Notifiers_.end()) {
 			Types::TopicNotifyFunctionList &L = It->second;
@@ -4,9 +4,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <shared_mutex>
+
 #include "Poco/Notification.h"
 #include "Poco/NotificationQueue.h"
 #include "Poco/JSON/Object.h"
+#include "framework/KafkaOffsetTracker.h"
 #include "framework/KafkaTopics.h"
 #include "framework/OpenWifiTypes.h"
 #include "framework/SubSystemServer.h"
@@ -36,13 +41,37 @@ namespace OpenWifi {
 		void run() override;
 		void Start();
 		void Stop();
-		void Produce(const char *Topic, const std::string &Key, const std::string & Payload);
+		bool Produce(const char *Topic, const std::string &Key, const std::string & Payload);
+
+		inline void GetCounters(std::uint64_t &Queued, std::uint64_t &Produced,
+								std::uint64_t &Delivered, std::uint64_t &Failed,
+								std::uint64_t &Dropped, std::uint64_t &Blocked) const {
+			Queued = Queue_.size();
+			Produced = Produced_;
+			Delivered = Delivered_;
+			Failed = Failed_;
+			Dropped = Dropped_;
+			Blocked = Blocked_;
+		}
 
 	  private:
 		std::mutex Mutex_;
+		std::condition_variable SpaceAvailable_;
 		Poco::Thread Worker_;
 		mutable std::atomic_bool Running_ = false;
 		Poco::NotificationQueue Queue_;
+
+		//	When the queue is full, "drop" discards the new message, "block" waits up to
+		//	BlockTime_ ms for room before discarding it.
+		std::size_t MaxQueued_ = 50000;
+		bool BlockWhenFull_ = false;
+		std::uint64_t BlockTime_ = 100;
+
+		std::atomic_uint64_t Produced_ = 0;
+		std::atomic_uint64_t Delivered_ = 0;
+		std::atomic_uint64_t Failed_ = 0;
+		std::atomic_uint64_t Dropped_ = 0;
+		std::atomic_uint64_t Blocked_ = 0;
 	};
 
 	class KafkaConsumer : public Poco::Runnable {
@@ -50,19 +79,76 @@ namespace OpenWifi {
 		void Start();
 		void Stop();
 
+		inline void GetCounters(std::uint64_t &Received, std::uint64_t &Processed,
+								std::uint64_t &Failed, std::uint64_t &Commits,
+								std::uint64_t &CommitsFailed, std::uint64_t &Queued) {
+			Queued = 0;
+			std::lock_guard WG(WorkersMutex_);
+			for (auto &W : Workers_) {
+				std::lock_guard G(W->Mutex_);
+				Queued += W->Messages_.size();
+			}
+			Received = Received_;
+			Processed = Processed_;
+			Failed = Failed_;
+			Commits = Commits_;
+			CommitsFailed = CommitsFailed_;
+		}
+
 	  private:
-		std::mutex 				ConsumerMutex_;
+		//	Subscriber callbacks run on these threads. A partition always goes to the same worker,
+		//	and producers key messages by serial number, so messages for one key stay in order.
+		class Worker : public Poco::Runnable {
+		  public:
+			Worker(KafkaConsumer &Consumer, std::uint64_t Id) : Consumer_(Consumer), Id_(Id) {}
+			void run() override;
+
+		  private:
+			friend class KafkaConsumer;
+			KafkaConsumer 					&Consumer_;
+			std::uint64_t 					Id_;
+			std::mutex 						Mutex_;
+			std::condition_variable 		Condition_;
+			std::deque<cppkafka::Message> 	Messages_;
+			bool 							Busy_ = false;
+			bool 							Stopping_ = false;
+			Poco::Thread 					Thread_;
+		};
+
+		std::shared_mutex 		ConsumerMutex_;
 		Types::NotifyTable 		Notifiers_;
 		Poco::Thread 			Worker_;
 		mutable std::atomic_bool Running_ = false;
 		uint64_t 				FunctionId_ = 1;
 		std::unique_ptr<cppkafka::ConsumerDispatcher> 	Dispatcher_;
 		std::set<std::string>	Topics_;
+		//	Only changed by Start, before the dispatcher runs, and by Stop, once it has been joined.
+		//	WorkersMutex_ is for readers on other threads, such as GetCounters.
+		std::mutex 				WorkersMutex_;
+		std::vector<std::unique_ptr<Worker>> 	Workers_;
+		std::size_t 			MaxQueued_ = 1000;
+
+		//	Commits are only ever sent from the dispatcher thread.
+		KafkaOffsetTracker 		Offsets_;
+		bool 					AutoCommit_ = false;
+
+		std::atomic_uint64_t 	Received_ = 0;
+		std::atomic_uint64_t 	Processed_ = 0;
+		std::atomic_uint64_t 	Failed_ = 0;
+		std::atomic_uint64_t 	Commits_ = 0;
+		std::atomic_uint64_t 	CommitsFailed_ = 0;
 
 		void run() override;
 		friend class KafkaManager;
 		std::uint64_t RegisterTopicWatcher(const std::string &Topic, Types::TopicNotifyFunction &F);
 		void UnregisterTopicWatcher(const std::string &Topic, int Id);
+
+		void Enqueue(cppkafka::Message Msg);
+		void Dispatch(const cppkafka::Message &Msg);
+		void Drain();
+		void StopWorkers();
+		void Commit(cppkafka::Consumer &Consumer, bool Synchronous, Poco::Logger &Logger);
+		void CommitIfDue(cppkafka::Consumer &Consumer, Poco::Logger &Logger);
 	};
 
 	class KafkaManager : public SubSystemServer {
@@ -95,6 +181,16 @@ namespace OpenWifi {
 		}
 
 		std::uint64_t KafkaManagerMaximumPayloadSize() const { return MaxPayloadSize_; }
+		inline void GetProducerCounters(std::uint64_t &Queued, std::uint64_t &Produced,
+										std::uint64_t &Delivered, std::uint64_t &Failed,
+										std::uint64_t &Dropped, std::uint64_t &Blocked) const {
+			ProducerThr_.GetCounters(Queued, Produced, Delivered, Failed, Dropped, Blocked);
+		}
+		inline void GetConsumerCounters(std::uint64_t &Received, std::uint64_t &Processed,
+										std::uint64_t &Failed, std::uint64_t &Commits,
+										std::uint64_t &CommitsFailed, std::uint64_t &Queued) {
+			ConsumerThr_.GetCounters(Received, Processed, Failed, Commits, CommitsFailed, Queued);
+		}
 
 	  private:
 		bool KafkaEnabled_ = false;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace OpenWifi {
+
+	//	Routing and commit bookkeeping of the Kafka consumer. The partition workers record the next
+	//	offset to commit once every callback has seen a message. The dispatcher thread takes them
+	//	when a commit is due and puts them back if the commit fails. Due() and Take() are only
+	//	called from the dispatcher thread.
+	class KafkaOffsetTracker {
+	  public:
+		using Clock = std::chrono::steady_clock;
+		using Offsets = std::map<std::pair<std::string, int>, std::int64_t>;
+
+		//	Worker owning a partition: all of its messages go to the same one, in order.
+		[[nodiscard]] static inline std::size_t Route(const std::string &Topic, int Partition,
+													  std::size_t Workers) {
+			auto Hash = std::hash<std::string>{}(Topic) ^
+						((std::uint64_t)Partition * 0x9e3779b97f4a7c15ULL);
+			return Hash % Workers;
+		}
+
+		inline void Configure(std::uint64_t Batch, std::uint64_t IntervalMs, Clock::time_point Now) {
+			Batch_ = Batch;
+			Interval_ = std::chrono::milliseconds(IntervalMs);
+			LastCommit_ = Now;
+		}
+
+		inline void Processed(const std::string &Topic, int Partition, std::int64_t Offset) {
+			std::lock_guard G(Mutex_);
+			auto &Next = Offsets_[std::make_pair(Topic, Partition)];
+			Next = std::max(Next, Offset + 1);
+			++Uncommitted_;
+		}
+
+		[[nodiscard]] inline std::uint64_t Uncommitted() const { return Uncommitted_; }
+
+		[[nodiscard]] inline bool Due(Clock::time_point Now) const {
+			return Uncommitted_ >= Batch_ || (Now - LastCommit_) >= Interval_;
+		}
+
+		inline Offsets Take(Clock::time_point Now) {
+			Offsets Taken;
+			{
+				std::lock_guard G(Mutex_);
+				Taken.swap(Offsets_);
+				Uncommitted_ = 0;
+			}
+			LastCommit_ = Now;
+			return Taken;
+		}
+
+		//	Retried with the next commit, unless a worker has moved the partition further since.
+		inline void Restore(const Offsets &Failed) {
+			std::lock_guard G(Mutex_);
+			for (const auto &[TopicPartition, Offset] : Failed) {
+				auto &Next = Offsets_[TopicPartition];
+				Next = std::max(Next, Offset);
+			}
+		}
+
+	  private:
+		std::mutex 					Mutex_;
+		Offsets 					Offsets_;
+		std::atomic_uint64_t 		Uncommitted_ = 0;
+		std::uint64_t 				Batch_ = 1000;
+		std::chrono::milliseconds 	Interval_{1000};
+		Clock::time_point 			LastCommit_;
+	};
+
+} // namespace OpenWifi
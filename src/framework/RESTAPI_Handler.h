@@ -479,7 +479,7 @@ namespace OpenWifi {
 			Response->sendFile(File.path(), MT.ContentType);
 		}
 
-		inline void SendFile(Poco::TemporaryFile &TempAvatar,
+		inline void SendFile(Poco::File &TempAvatar,
 							 [[maybe_unused]] const std::string &Type, const std::string &Name) {
 			Response->setStatus(Poco::Net::HTTPResponse::HTTPStatus::HTTP_OK);
 			SetCommonHeaders();
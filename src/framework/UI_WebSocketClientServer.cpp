@@ -8,6 +8,7 @@
 #include "Poco/JSON/Parser.h"
 #include "Poco/Logger.h"
 #include "Poco/NObserver.h"
+#include "Poco/Net/WebSocketImpl.h"
 
 #include "framework/AuthClient.h"
 #include "framework/MicroServiceFuncs.h"
@@ -28,7 +29,7 @@ namespace OpenWifi {
 											 const std::string &UserName, std::uint64_t TID) {
 
 		std::lock_guard G(LocalMutex_);
-		auto Client = std::make_unique<UI_WebSocketClientInfo>(WS, Id, UserName);
+		auto Client = std::make_shared<UI_WebSocketClientInfo>(WS, Id, UserName);
 		auto ClientSocket = Client->WS_->impl()->sockfd();
 		TID_ = TID;
 		Client->WS_->setNoDelay(true);
@@ -56,11 +57,12 @@ namespace OpenWifi {
 		: SubSystemServer("WebSocketClientServer", "UI-WSCLNT-SVR", "websocketclients") {}
 
 	void UI_WebSocketClientServer::run() {
-		Running_ = true;
+		auto LastReport = Utils::Now();
 		while (Running_) {
 			if(!Poco::Thread::trySleep(2000)) {
                 break;
             }
+			EvictSlowClients();
 			std::lock_guard G(LocalMutex_);
 			for (const auto i : ToBeRemoved_) {
 				// std::cout << "Erasing old WS UI connection..." << std::endl;
@@ -68,10 +70,201 @@ namespace OpenWifi {
 			}
 			ToBeRemoved_.clear();
 			UsersConnected_ = Clients_.size();
+
+			auto Now = Utils::Now();
+			if ((Now - LastReport) > 60) {
+				LastReport = Now;
+				poco_debug(Logger(), fmt::format("Clients={} FramesSent={} Evicted={}",
+												 Clients_.size(), (std::uint64_t)FramesSent_,
+												 (std::uint64_t)ClientsEvicted_));
+			}
+		}
+	}
+
+	void UI_WebSocketClientServer::RefreshRecipients() {
+		auto List = std::make_shared<RecipientList>();
+		for (const auto &[fd, Client] : Clients_) {
+			if (Client->Authenticated_ && Client->SocketRegistered_)
+				List->push_back(Client);
+		}
+		std::lock_guard G(RecipientsMutex_);
+		Recipients_ = std::move(List);
+	}
+
+	std::shared_ptr<const UI_WebSocketClientServer::RecipientList>
+	UI_WebSocketClientServer::Recipients() {
+		std::lock_guard G(RecipientsMutex_);
+		return Recipients_;
+	}
+
+	bool UI_WebSocketClientServer::Enqueue(const ClientPtr &Client, std::uint64_t id,
+										   const std::shared_ptr<const std::string> &Frame) {
+		bool Evict = false;
+		{
+			std::lock_guard G(Client->QueueMutex_);
+			if (Client->Evicted_ || IsFiltered(id, *Client))
+				return false;
+			if (Client->Outbound_.size() < MaxQueued_) {
+				Client->Outbound_.push_back(Frame);
+				if (Client->Scheduled_)
+					return true;
+				Client->Scheduled_ = true;
+			} else {
+				//	this browser is not keeping up, drop it rather than buffer without bound
+				Client->Evicted_ = Evict = true;
+				Client->Outbound_.clear();
+			}
+		}
+
+		std::lock_guard G(SenderMutex_);
+		if (Evict) {
+			SlowClients_.push_back(Client);
+			return false;
+		}
+		ReadyClients_.push_back(Client);
+		SenderCondition_.notify_one();
+		return true;
+	}
+
+	//	Answers to the browser's own requests: they are not filtered or counted against the queue
+	//	limit, and the reactor writes them right away unless frames are already waiting.
+	void UI_WebSocketClientServer::Reply(const ClientPtr &Client, const std::string &Payload,
+										 int Flags) {
+		{
+			std::lock_guard G(Client->QueueMutex_);
+			if (Client->Evicted_)
+				return;
+			Client->Outbound_.push_back(
+				std::make_shared<const std::string>(Utils::EncodeWebSocketFrame(Payload, Flags)));
+			if (Client->Scheduled_)
+				return;
+			Client->Scheduled_ = true;
+		}
+		Drain(Client);
+	}
+
+	void UI_WebSocketClientServer::SendQueuedFrames() {
+		Utils::SetThreadName("ws:ui-sender");
+		while (true) {
+			ClientPtr Client;
+			{
+				std::unique_lock Lock(SenderMutex_);
+				SenderCondition_.wait(Lock, [this] { return !Running_ || !ReadyClients_.empty(); });
+				if (!Running_)
+					break;
+				Client = std::move(ReadyClients_.front());
+				ReadyClients_.pop_front();
+			}
+			Drain(Client);
+		}
+	}
+
+	//	Writes queued frames until the queue is empty or the socket stops accepting bytes. In that
+	//	case the client waits for a writable notification, which drains it again. Only a socket
+	//	error drops the client here: a full queue is handled by Enqueue().
+	void UI_WebSocketClientServer::Drain(const ClientPtr &Client) {
+		bool Failed = false;
+		{
+			std::lock_guard G(Client->SendMutex_);
+			try {
+				auto SockImpl = dynamic_cast<Poco::Net::WebSocketImpl *>(Client->WS_->impl());
+				auto Stream = SockImpl->streamSocketImpl();
+				while (true) {
+					if (Client->Writing_ == nullptr) {
+						std::lock_guard Q(Client->QueueMutex_);
+						if (Client->Evicted_ || Client->Outbound_.empty()) {
+							Client->Scheduled_ = false;
+							break;
+						}
+						Client->Writing_ = std::move(Client->Outbound_.front());
+						Client->Outbound_.pop_front();
+						Client->WriteOffset_ = 0;
+					}
+
+					const auto &Frame = *Client->Writing_;
+					auto Sent = Stream->sendBytes(Frame.data() + Client->WriteOffset_,
+												  (int)(Frame.size() - Client->WriteOffset_));
+					if (Sent <= 0) {
+						std::lock_guard Q(Client->QueueMutex_);
+						if (!Client->Evicted_ && !Client->WritableRegistered_) {
+							Reactor_.addEventHandler(
+								*Client->WS_,
+								Poco::NObserver<UI_WebSocketClientServer,
+												Poco::Net::WritableNotification>(
+									*this, &UI_WebSocketClientServer::OnSocketWritable));
+							Client->WritableRegistered_ = true;
+						}
+						return;
+					}
+					Client->WriteOffset_ += Sent;
+					if (Client->WriteOffset_ == Frame.size()) {
+						Client->Writing_.reset();
+						++FramesSent_;
+					}
+				}
+				if (Client->WritableRegistered_) {
+					Client->WritableRegistered_ = false;
+					Reactor_.removeEventHandler(
+						*Client->WS_,
+						Poco::NObserver<UI_WebSocketClientServer, Poco::Net::WritableNotification>(
+							*this, &UI_WebSocketClientServer::OnSocketWritable));
+				}
+			} catch (...) {
+				Failed = true;
+			}
+		}
+
+		if (Failed) {
+			{
+				std::lock_guard G(Client->QueueMutex_);
+				Client->Evicted_ = true;
+				Client->Outbound_.clear();
+			}
+			std::lock_guard G(SenderMutex_);
+			SlowClients_.push_back(Client);
+		}
+	}
+
+	void UI_WebSocketClientServer::EvictSlowClients() {
+		std::vector<ClientPtr> Slow;
+		{
+			std::lock_guard G(SenderMutex_);
+			Slow.swap(SlowClients_);
+		}
+		if (Slow.empty())
+			return;
+
+		std::lock_guard G(LocalMutex_);
+		for (const auto &Client : Slow) {
+			auto hint = Clients_.find(Client->WS_->impl()->sockfd());
+			if (hint == end(Clients_) || hint->second != Client || !Client->SocketRegistered_)
+				continue;
+			poco_information(Logger(),
+							 fmt::format("EVICT({}): {} UI Client is too slow or failed, closing WS "
+										 "connection.",
+										 Client->Id_, Client->UserName_));
+			++ClientsEvicted_;
+			EndConnection(hint);
 		}
 	}
 
 	void UI_WebSocketClientServer::EndConnection(ClientList::iterator Client) {
+		{
+			//	no sender may write to, or wait on, this socket from now on
+			std::lock_guard SG(Client->second->SendMutex_);
+			{
+				std::lock_guard QG(Client->second->QueueMutex_);
+				Client->second->Evicted_ = true;
+				Client->second->Outbound_.clear();
+			}
+			if (Client->second->WritableRegistered_) {
+				Client->second->WritableRegistered_ = false;
+				Reactor_.removeEventHandler(
+					*Client->second->WS_,
+					Poco::NObserver<UI_WebSocketClientServer, Poco::Net::WritableNotification>(
+						*this, &UI_WebSocketClientServer::OnSocketWritable));
+			}
+		}
 		if (Client->second->SocketRegistered_) {
 			Client->second->SocketRegistered_ = false;
 			Reactor_.removeEventHandler(
@@ -86,6 +279,7 @@ namespace OpenWifi {
 				*Client->second->WS_,
 				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ErrorNotification>(
 					*this, &UI_WebSocketClientServer::OnSocketError));
+			RefreshRecipients();
 		}
 		ToBeRemoved_.push_back(Client);
 	}
@@ -94,22 +288,46 @@ namespace OpenWifi {
 		poco_information(Logger(), "Starting...");
 		GoogleApiKey_ = MicroServiceConfigGetString("google.apikey", "");
 		GeoCodeEnabled_ = !GoogleApiKey_.empty();
+		MaxQueued_ = MicroServiceConfigGetInt("websocketclients.queue.max", 256);
+		if (MaxQueued_ == 0)
+			MaxQueued_ = 1;
+		Senders_ = MicroServiceConfigGetInt("websocketclients.senders", 2);
+		if (Senders_ == 0)
+			Senders_ = 1;
+		Running_ = true;
 		ReactorThread_.start(Reactor_);
 		ReactorThread_.setName("ws:ui-reactor");
 		CleanerThread_.start(*this);
 		CleanerThread_.setName("ws:ui-cleaner");
+		for (std::uint64_t i = 0; i < Senders_; ++i) {
+			SenderThreads_.push_back(std::make_unique<Poco::Thread>());
+			SenderThreads_.back()->start(SenderAdapter_);
+		}
 		return 0;
 	};
 
 	void UI_WebSocketClientServer::Stop() {
 		if (Running_) {
 			poco_information(Logger(), "Stopping...");
-			Clients_.clear();
 			Reactor_.stop();
 			ReactorThread_.join();
-			Running_ = false;
+			{
+				std::lock_guard G(SenderMutex_);
+				Running_ = false;
+				ReadyClients_.clear();
+				SlowClients_.clear();
+			}
+			SenderCondition_.notify_all();
+			for (auto &Sender : SenderThreads_)
+				Sender->join();
+			SenderThreads_.clear();
 			CleanerThread_.wakeUp();
 			CleanerThread_.join();
+			{
+				std::lock_guard G(RecipientsMutex_);
+				Recipients_ = std::make_shared<const RecipientList>();
+			}
+			Clients_.clear();
 			poco_information(Logger(), "Stopped...");
 		}
 	};
@@ -121,34 +339,32 @@ namespace OpenWifi {
 
 	bool UI_WebSocketClientServer::SendToUser(const std::string &UserName, std::uint64_t id,
 											  const std::string &Payload) {
-		std::lock_guard G(LocalMutex_);
-
-		for (const auto &Client : Clients_) {
-			if (Client.second->UserName_ == UserName) {
-				try {
-					if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_) {
-						return Client.second->WS_->sendFrame(
-								   Payload.c_str(), (int)Payload.size()) == (int)Payload.size();
-					} else {
-						return false;
-					}
-				} catch (...) {
-					return false;
-				}
+		if (!Running_)
+			return false;
+		auto List = Recipients();
+		std::shared_ptr<const std::string> Frame;
+		bool Queued = false;
+		for (const auto &Client : *List) {
+			if (Client->UserName_ == UserName) {
+				if (Frame == nullptr)
+					Frame = std::make_shared<const std::string>(Utils::EncodeWebSocketFrame(
+						Payload, Poco::Net::WebSocket::FRAME_TEXT));
+				Queued |= Enqueue(Client, id, Frame);
 			}
 		}
-		return false;
+		return Queued;
 	}
 
 	void UI_WebSocketClientServer::SendToAll(std::uint64_t id, const std::string &Payload) {
-		std::lock_guard G(LocalMutex_);
-
-		for (const auto &Client : Clients_) {
-			try {
-				if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_)
-					Client.second->WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-			} catch (...) {
-			}
+		if (!Running_)
+			return;
+		auto List = Recipients();
+		if (List->empty())
+			return;
+		auto Frame = std::make_shared<const std::string>(
+			Utils::EncodeWebSocketFrame(Payload, Poco::Net::WebSocket::FRAME_TEXT));
+		for (const auto &Client : *List) {
+			Enqueue(Client, id, Frame);
 		}
 	}
 
@@ -219,9 +435,9 @@ namespace OpenWifi {
 
 			switch (Op) {
 			case Poco::Net::WebSocket::FRAME_OP_PING: {
-				Client->second->WS_->sendFrame("", 0,
-											   (int)Poco::Net::WebSocket::FRAME_OP_PONG |
-												   (int)Poco::Net::WebSocket::FRAME_FLAG_FIN);
+				Reply(Client->second, "",
+					  (int)Poco::Net::WebSocket::FRAME_OP_PONG |
+						  (int)Poco::Net::WebSocket::FRAME_FLAG_FIN);
 			} break;
 			case Poco::Net::WebSocket::FRAME_OP_PONG: {
 			} break;
@@ -258,14 +474,14 @@ namespace OpenWifi {
 						WelcomeMessage.set("success", "Welcome! Bienvenue! Bienvenidos!");
 						std::ostringstream OS;
 						WelcomeMessage.stringify(OS);
-						Client->second->WS_->sendFrame(OS.str().c_str(), (int)OS.str().size());
-						Client->second->UserName_ = Client->second->UserInfo_.userinfo.email;
+						Reply(Client->second, OS.str());
+						RefreshRecipients();
 					} else {
 						Poco::JSON::Object WelcomeMessage;
 						WelcomeMessage.set("error", "Invalid token. Closing connection.");
 						std::ostringstream OS;
 						WelcomeMessage.stringify(OS);
-						Client->second->WS_->sendFrame(OS.str().c_str(), (int)OS.str().size());
+						Reply(Client->second, OS.str());
 						return EndConnection(Client);
 					}
 				} else {
@@ -274,6 +490,7 @@ namespace OpenWifi {
 
 					if (Obj->has(DropMessagesCommand) && Obj->isArray(DropMessagesCommand)) {
 						auto Filters = Obj->getArray(DropMessagesCommand);
+						std::lock_guard QG(Client->second->QueueMutex_);
 						Client->second->Filter_.clear();
 						for (const auto &Filter : *Filters) {
 							Client->second->Filter_.emplace_back((std::uint64_t)Filter);
@@ -289,9 +506,9 @@ namespace OpenWifi {
 											  Client->second->UserInfo_.userinfo);
 					}
 					if (!Answer.empty())
-						Client->second->WS_->sendFrame(Answer.c_str(), (int)Answer.size());
+						Reply(Client->second, Answer);
 					else {
-						Client->second->WS_->sendFrame("{}", 2);
+						Reply(Client->second, "{}");
 					}
 
 					if (CloseConnection) {
@@ -307,6 +524,19 @@ namespace OpenWifi {
 		}
 	}
 
+	void UI_WebSocketClientServer::OnSocketWritable(
+		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf) {
+		ClientPtr Client;
+		{
+			std::lock_guard G(LocalMutex_);
+			auto Hint = Clients_.find(pNf->socket().impl()->sockfd());
+			if (Hint == end(Clients_))
+				return;
+			Client = Hint->second;
+		}
+		Drain(Client);
+	}
+
 	void UI_WebSocketClientServer::OnSocketShutdown(
 		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf) {
 		try {
@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "Poco/JSON/Object.h"
@@ -12,6 +16,7 @@
 #include "Poco/Net/SocketReactor.h"
 #include "Poco/Net/WebSocket.h"
 #include "Poco/Runnable.h"
+#include "Poco/RunnableAdapter.h"
 
 #include "RESTObjects/RESTAPI_SecurityObjects.h"
 #include "framework/SubSystemServer.h"
@@ -36,6 +41,22 @@ namespace OpenWifi {
 		std::vector<std::uint64_t> Filter_;
 		SecurityObjects::UserInfoAndPolicy UserInfo_;
 
+		//	Frames are queued here already encoded, and written by a sender thread or the reactor,
+		//	never by the notifier. Notifications share one encoded copy between all their clients.
+		//	Scheduled_ is set while a sender or a writable notification is due to drain the queue.
+		//	Evicted_ is set once the client is closed or dropped.
+		std::mutex QueueMutex_; //	Filter_, Outbound_, Scheduled_, Evicted_
+		std::deque<std::shared_ptr<const std::string>> Outbound_;
+		bool Scheduled_ = false;
+		bool Evicted_ = false;
+
+		//	The frame being written: a write the socket only partly accepts resumes at WriteOffset_
+		//	when the socket is writable again.
+		std::mutex SendMutex_; //	Writing_, WriteOffset_, WritableRegistered_
+		std::shared_ptr<const std::string> Writing_;
+		std::size_t WriteOffset_ = 0;
+		bool WritableRegistered_ = false;
+
 		UI_WebSocketClientInfo(Poco::Net::WebSocket &WS, const std::string &Id,
 							   const std::string &username) {
 			WS_ = std::make_unique<Poco::Net::WebSocket>(WS);
@@ -97,7 +118,9 @@ namespace OpenWifi {
 			std::string helper;
 		};
 
-		using ClientList = std::map<int, std::unique_ptr<UI_WebSocketClientInfo>>;
+		using ClientPtr = std::shared_ptr<UI_WebSocketClientInfo>;
+		using ClientList = std::map<int, ClientPtr>;
+		using RecipientList = std::vector<ClientPtr>;
 		using NotificationTypeIdVec = std::vector<NotificationEntry>;
 
 		void RegisterNotifications(const NotificationTypeIdVec &Notifications);
@@ -119,10 +142,37 @@ namespace OpenWifi {
 		std::vector<ClientList::iterator> ToBeRemoved_;
 		std::uint64_t TID_ = 0;
 
+		//	Authenticated clients, rebuilt under LocalMutex_ so notifiers never have to take it.
+		std::mutex RecipientsMutex_;
+		std::shared_ptr<const RecipientList> Recipients_ = std::make_shared<const RecipientList>();
+
+		std::mutex SenderMutex_;
+		std::condition_variable SenderCondition_;
+		std::deque<ClientPtr> ReadyClients_;
+		std::vector<ClientPtr> SlowClients_;
+		std::vector<std::unique_ptr<Poco::Thread>> SenderThreads_;
+		Poco::RunnableAdapter<UI_WebSocketClientServer> SenderAdapter_{
+			*this, &UI_WebSocketClientServer::SendQueuedFrames};
+		std::uint64_t MaxQueued_ = 256;
+		std::uint64_t Senders_ = 2;
+		std::atomic_uint64_t FramesSent_ = 0;
+		std::atomic_uint64_t ClientsEvicted_ = 0;
+
 		UI_WebSocketClientServer() noexcept;
 		void EndConnection(ClientList::iterator Client);
 
+		void RefreshRecipients();
+		std::shared_ptr<const RecipientList> Recipients();
+		bool Enqueue(const ClientPtr &Client, std::uint64_t id,
+					 const std::shared_ptr<const std::string> &Frame);
+		void Reply(const ClientPtr &Client, const std::string &Payload,
+				   int Flags = Poco::Net::WebSocket::FRAME_TEXT);
+		void SendQueuedFrames();
+		void Drain(const ClientPtr &Client);
+		void EvictSlowClients();
+
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
+		void OnSocketWritable(const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void OnSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
 
@@ -2,6 +2,7 @@
 // Created by stephane bourque on 2022-10-25.
 //
 
+#include "Poco/MemoryStream.h"
 #include "Poco/Path.h"
 #include "Poco/TemporaryFile.h"
 #include "Poco/Crypto/ECKey.h"
@@ -557,37 +558,80 @@ namespace OpenWifi::Utils {
 	}
 
 	bool ExtractBase64CompressedData(const std::string &CompressedData,
-									 std::string &UnCompressedData, uint64_t compress_sz) {
-		std::istringstream ifs(CompressedData);
-		Poco::Base64Decoder b64in(ifs);
-		std::ostringstream ofs;
-		Poco::StreamCopier::copyStream(b64in, ofs);
-
-		int factor = 20;
-		unsigned long MaxSize = compress_sz ? (unsigned long)(compress_sz + 5000)
-											: (unsigned long)(ofs.str().size() * factor);
-		while (true) {
-			std::vector<uint8_t> UncompressedBuffer(MaxSize);
-			unsigned long FinalSize = MaxSize;
-			auto status = uncompress((uint8_t *)&UncompressedBuffer[0], &FinalSize,
-									 (uint8_t *)ofs.str().c_str(), ofs.str().size());
-			if (status == Z_OK) {
-				UncompressedBuffer[FinalSize] = 0;
-				UnCompressedData = (char *)&UncompressedBuffer[0];
-				return true;
-			}
-			if (status == Z_BUF_ERROR) {
-				if (factor < 300) {
-					factor += 10;
-					MaxSize = ofs.str().size() * factor;
-					continue;
-				} else {
-					return false;
-				}
+									 std::string &UnCompressedData, uint64_t compress_sz,
+									 uint64_t MaxSize) {
+		//	base64 is decoded as a stream and fed to zlib a chunk at a time, so the only buffers are
+		//	the input, two small chunks and the output, which may never exceed MaxSize. The payload
+		//	is only accepted once zlib reports the end of the stream: a truncated one is an error.
+		UnCompressedData.clear();
+		z_stream strm{};
+		if (inflateInit(&strm) != Z_OK)
+			return false;
+
+		bool Complete = false;
+		try {
+			Poco::MemoryInputStream Input(CompressedData.data(), CompressedData.size());
+			Poco::Base64Decoder B64In(Input);
+
+			if (compress_sz != 0 && compress_sz <= MaxSize)
+				UnCompressedData.reserve(compress_sz);
+
+			char In[16384], Out[16384];
+			int rc = Z_OK;
+			bool Failed = false;
+			while (rc != Z_STREAM_END && !Failed) {
+				B64In.read(In, sizeof(In));
+				auto Got = (uInt)B64In.gcount();
+				if (Got == 0)
+					break;
+				strm.next_in = (Bytef *)In;
+				strm.avail_in = Got;
+				do {
+					strm.next_out = (Bytef *)Out;
+					strm.avail_out = sizeof(Out);
+					rc = inflate(&strm, Z_NO_FLUSH);
+					if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+						Failed = true;
+						break;
+					}
+					auto Produced = sizeof(Out) - strm.avail_out;
+					if (UnCompressedData.size() + Produced > MaxSize) {
+						Failed = true;
+						break;
+					}
+					UnCompressedData.append(Out, Produced);
+				} while (strm.avail_out == 0 && rc != Z_STREAM_END);
 			}
+			Complete = !Failed && rc == Z_STREAM_END;
+		} catch (...) {
+		}
+		inflateEnd(&strm);
+
+		if (!Complete || UnCompressedData.empty()) {
+			UnCompressedData.clear();
 			return false;
 		}
-		return false;
+		return true;
+	}
+
+	std::string EncodeWebSocketFrame(const std::string &Payload, int Flags) {
+		std::string Frame;
+		auto Length = Payload.size();
+		Frame.reserve(Length + 10);
+		Frame.push_back((char)(Flags & 0xff));
+		if (Length < 126) {
+			Frame.push_back((char)Length);
+		} else if (Length < 65536) {
+			Frame.push_back((char)126);
+			Frame.push_back((char)((Length >> 8) & 0xff));
+			Frame.push_back((char)(Length & 0xff));
+		} else {
+			Frame.push_back((char)127);
+			for (int Shift = 56; Shift >= 0; Shift -= 8)
+				Frame.push_back((char)((Length >> Shift) & 0xff));
+		}
+		Frame += Payload;
+		return Frame;
 	}
 
 	bool IsAlphaNumeric(const std::string &s) {
@@ -148,8 +148,15 @@ namespace OpenWifi::Utils {
 		return Flag;
 	}
 
+	//	Upper bound for an inflated compress_64/result_64 payload, protects against zip bombs.
+	constexpr std::uint64_t DefaultMaxDecompressedSize = 32 * 1024 * 1024;
+
 	bool ExtractBase64CompressedData(const std::string &CompressedData,
-									 std::string &UnCompressedData, uint64_t compress_sz);
+									 std::string &UnCompressedData, uint64_t compress_sz,
+									 uint64_t MaxSize = DefaultMaxDecompressedSize);
+
+	//	Wire form of a WebSocket frame sent by a server: the header and the unmasked payload.
+	std::string EncodeWebSocketFrame(const std::string &Payload, int Flags);
 
 	inline bool match(const char* first, const char* second)
 	{
@@ -47,14 +47,21 @@ namespace OpenWifi {
 			MaxConcurrentSessions_ = MicroServiceConfigGetInt("rtty.maxsessions", 0);
 			enforce_mTLS_ = MicroServiceConfigGetBool("rtty.enforcemTLS", false);
 			NoSecurity_ = MicroServiceNoAPISecurity();
-
+			auto NumberOfReactors = MicroServiceConfigGetInt("rtty.reactors", 4);
+			if (NumberOfReactors < 1)
+				NumberOfReactors = 1;
+			for (std::uint64_t i = 0; i < NumberOfReactors; ++i)
+				Shards_.emplace_back(std::make_unique<ReactorShard>());
+
+			//	The listener lives on the first reactor, accepted devices are spread over all of them.
+			auto &Listener = Shards_[0]->Reactor;
 			if (NoSecurity_) {
 				Poco::Net::IPAddress Addr(Poco::Net::IPAddress::wildcard(
 					Poco::Net::Socket::supportsIPv6() ? Poco::Net::AddressFamily::IPv6
 													  : Poco::Net::AddressFamily::IPv4));
 				Poco::Net::SocketAddress SockAddr(Addr, DSport);
 				ServerDeviceSocket_ = std::make_unique<Poco::Net::ServerSocket>(SockAddr, 64);
-				Reactor_.addEventHandler(
+				Listener.addEventHandler(
 					*ServerDeviceSocket_, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 										*this, &RTTYS_server::onDeviceAccept));
 			} else {
@@ -112,14 +119,16 @@ namespace OpenWifi {
 				SecureServerDeviceSocket_ = std::make_unique<Poco::Net::SecureServerSocket>(
 					SockAddr, 64, DeviceSecureContext);
 
-				Reactor_.addEventHandler(
+				Listener.addEventHandler(
 					*SecureServerDeviceSocket_,
 					Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 						*this, &RTTYS_server::onDeviceAccept));
 			}
 
-			ReactorThread_.start(Reactor_);
-			Utils::SetThreadName(ReactorThread_, "rt:devreactor");
+			for (auto &Shard : Shards_) {
+				Shard->Thread.start(Shard->Reactor);
+				Utils::SetThreadName(Shard->Thread, "rt:devreactor");
+			}
 
 			auto WebServerHttpParams = new Poco::Net::HTTPServerParams;
 			WebServerHttpParams->setMaxThreads(50);
@@ -186,15 +195,16 @@ namespace OpenWifi {
 		if (Internal_) {
 			WebServer_->stopAll(true);
 			WebServer_->stop();
-			Reactor_.stop();
-			ReactorThread_.join();
+			for (auto &Shard : Shards_)
+				Shard->Reactor.stop();
+			for (auto &Shard : Shards_)
+				Shard->Thread.join();
 		}
 		poco_information(Logger(),"Stopped...");
 	}
 
 	void RTTYS_server::onDeviceAccept(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 		try {
-			std::lock_guard	Lock(ServerMutex_);
 			Poco::Net::SocketAddress Client;
 			Poco::Net::StreamSocket NewSocket(pNf->socket().impl()->acceptConnection(Client));
 			if (NewSocket.secure()) {
@@ -235,20 +245,28 @@ namespace OpenWifi {
 		}
 	}
 
-	void RTTYS_server::RemoveClientEventHandlers(Poco::Net::WebSocket &Socket) {
+	RTTYS_server::ReactorShard &RTTYS_server::ShardOf(const Poco::Net::SocketReactor &Reactor) {
+		for (auto &Shard : Shards_) {
+			if (&Shard->Reactor == &Reactor)
+				return *Shard;
+		}
+		return *Shards_[0];
+	}
+
+	void RTTYS_server::RemoveClientEventHandlers(ReactorShard &Shard, Poco::Net::WebSocket &Socket) {
 		int fd = Socket.impl()->sockfd();
-		if(Reactor_.has(Socket)) {
-			Reactor_.removeEventHandler(
+		if(Shard.Reactor.has(Socket)) {
+			Shard.Reactor.removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 							*this, &RTTYS_server::onClientSocketReadable));
-			Reactor_.removeEventHandler(
+			Shard.Reactor.removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 							*this, &RTTYS_server::onClientSocketShutdown));
-			Reactor_.removeEventHandler(Socket,
+			Shard.Reactor.removeEventHandler(Socket,
 										Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 											*this, &RTTYS_server::onClientSocketError));
 		}
-		Clients_.erase(fd);
+		Shard.Clients.erase(fd);
 	}
 
 	void RTTYS_server::AddNewSocket(Poco::Net::StreamSocket &Socket, std::unique_ptr<Poco::Crypto::X509Certificate> P, bool valid, const std::string &cid, const std::string &cn) {
@@ -260,45 +278,57 @@ namespace OpenWifi {
 		Poco::Timespan TS2(300, 100);
 		Socket.setReceiveTimeout(TS2);
 
-		Reactor_.addEventHandler(Socket,
+		//	Until it registers we do not know which session the device belongs to, so it starts on
+		//	the next reactor in turn and moves to its session's reactor on registration if needed.
+		auto &Shard = *Shards_[NextShard_++ % Shards_.size()];
+		std::lock_guard	Lock(Shard.Mutex);
+		int fd = Socket.impl()->sockfd();
+		Shard.Sockets[fd] = std::make_unique<SecureSocketPair>(Socket, std::move(P), valid, cid, cn);
+		AddDeviceEventHandlers(Shard, Socket);
+	}
+
+	void RTTYS_server::AddDeviceEventHandlers(ReactorShard &Shard, const Poco::Net::Socket &Socket) {
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketReadable));
-		Reactor_.addEventHandler(Socket,
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketShutdown));
-		Reactor_.addEventHandler(Socket,
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketError));
-		int fd = Socket.impl()->sockfd();
-		Sockets_[fd] = std::make_unique<SecureSocketPair>(Socket, std::move(P), valid, cid, cn);
 	}
 
-	void RTTYS_server::RemoveSocket(const Poco::Net::Socket &Socket) {
-		auto hint = Sockets_.find(Socket.impl()->sockfd());
-		if(hint!=end(Sockets_)) {
-			Reactor_.removeEventHandler(
-				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
-							*this, &RTTYS_server::onConnectedDeviceSocketReadable));
-			Reactor_.removeEventHandler(
-				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
-							*this, &RTTYS_server::onConnectedDeviceSocketShutdown));
-			Reactor_.removeEventHandler(Socket,
-										Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
-											*this, &RTTYS_server::onConnectedDeviceSocketError));
-			Sockets_.erase(hint);
+	void RTTYS_server::RemoveDeviceEventHandlers(ReactorShard &Shard, const Poco::Net::Socket &Socket) {
+		Shard.Reactor.removeEventHandler(
+			Socket, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
+						*this, &RTTYS_server::onConnectedDeviceSocketReadable));
+		Shard.Reactor.removeEventHandler(
+			Socket, Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
+						*this, &RTTYS_server::onConnectedDeviceSocketShutdown));
+		Shard.Reactor.removeEventHandler(Socket,
+									Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
+										*this, &RTTYS_server::onConnectedDeviceSocketError));
+	}
+
+	void RTTYS_server::RemoveSocket(ReactorShard &Shard, const Poco::Net::Socket &Socket) {
+		auto hint = Shard.Sockets.find(Socket.impl()->sockfd());
+		if(hint!=end(Shard.Sockets)) {
+			RemoveDeviceEventHandlers(Shard, Socket);
+			Shard.Sockets.erase(hint);
 		}
 	}
 
-	void RTTYS_server::AddClientEventHandlers(Poco::Net::WebSocket &Socket,
+	void RTTYS_server::AddClientEventHandlers(ReactorShard &Shard, Poco::Net::WebSocket &Socket,
 											  std::shared_ptr<RTTYS_EndPoint> EndPoint) {
-		Clients_[Socket.impl()->sockfd()] = EndPoint;
-		Reactor_.addEventHandler(Socket,
+		Shard.Clients[Socket.impl()->sockfd()] = EndPoint;
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 									 *this, &RTTYS_server::onClientSocketReadable));
-		Reactor_.addEventHandler(Socket,
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 									 *this, &RTTYS_server::onClientSocketShutdown));
-		Reactor_.addEventHandler(Socket,
+		Shard.Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 									 *this, &RTTYS_server::onClientSocketError));
 	}
@@ -310,6 +340,7 @@ namespace OpenWifi {
 
 	std::shared_ptr<RTTYS_EndPoint> RTTYS_server::FindRegisteredEndPoint(const std::string &Id,
 														   const std::string &Token) {
+		std::lock_guard	Lock(EndPointsMutex_);
 		auto EndPoint = EndPoints_.find(Id);
 		if (EndPoint != end(EndPoints_) && EndPoint->second->Token_ == Token) {
 			return EndPoint->second;
@@ -318,11 +349,10 @@ namespace OpenWifi {
 	}
 
 
-	bool RTTYS_server::do_msgTypeRegister(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &Buffer, [[maybe_unused]] std::size_t msg_len) {
+	bool RTTYS_server::do_msgTypeRegister(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &Buffer, [[maybe_unused]] std::size_t msg_len, std::shared_ptr<RTTYS_EndPoint> &MoveTo) {
 		bool good = true;
 		try {
 
-			auto fd = Socket.impl()->sockfd();
 			std::string id_ = ReadString(Buffer);
 			std::string desc_ = ReadString(Buffer);
 			std::string token_ = ReadString(Buffer);
@@ -337,19 +367,18 @@ namespace OpenWifi {
 			//	find this device in our connectio end points...
 			poco_information(Logger(),fmt::format("{}: Looking for session", id_));
 
-			auto ConnectionHint = EndPoints_.find(id_);
-			if (ConnectionHint == end(EndPoints_) || ConnectionHint->second->Token_ != token_) {
+			auto ConnectionEp = FindRegisteredEndPoint(id_, token_);
+			if (ConnectionEp == nullptr) {
 				poco_warning(Logger(), fmt::format("{}: Unknown session from device.", id_));
 				return false;
 			}
 
-			auto SocketHint = Sockets_.find(Socket.impl()->sockfd());
-			if(SocketHint==end(Sockets_)) {
+			auto SocketHint = Shard.Sockets.find(Socket.impl()->sockfd());
+			if(SocketHint==end(Shard.Sockets)) {
 				poco_warning(Logger(), fmt::format("{}: Unknown socket from device.", id_));
 				return false;
 			}
 
-			auto ConnectionEp = ConnectionHint->second;
 			poco_information(Logger(),fmt::format("{}: Evaluation of mTLS requirements",id_));
 			if (ConnectionEp->mTLS_) {
 				if(SocketHint->second->valid) {
@@ -368,9 +397,6 @@ namespace OpenWifi {
 			}
 			Poco::Thread::trySleep(50);
 
-			ConnectionEp->Device_fd = fd;
-			Connected_[fd] = ConnectionEp;
-
 			u_char OutBuf[8];
 			OutBuf[0] = RTTYS_EndPoint::msgTypeRegister;
 			OutBuf[1] = 0; //	Data length
@@ -387,14 +413,12 @@ namespace OpenWifi {
 								id_, desc_));
 				return false;
 			}
-			ConnectionEp->DeviceConnected_ = std::chrono::high_resolution_clock::now();
-			ConnectionEp->DeviceIsAttached_ = true;
-			ConnectionEp->DeviceSocket_ = Socket;
-			if(ConnectionEp->WSSocket_!= nullptr && ConnectionEp->WSSocket_->impl()!= nullptr) {
-				poco_information(Logger(),fmt::format("REG{}: Device registered, Client Registered - sending login", ConnectionEp->SerialNumber_));
-				Login(Socket, ConnectionEp);
+
+			if (&ShardOf(ConnectionEp) == &Shard) {
+				AttachDevice(Shard, Socket, ConnectionEp);
 			} else {
-				poco_information(Logger(),fmt::format("REG{}: Device registered, Client Not Registered", ConnectionEp->SerialNumber_));
+				//	the endpoint state belongs to another reactor, the caller hands the socket over
+				MoveTo = ConnectionEp;
 			}
 			return true;
 		} catch (...) {
@@ -404,6 +428,51 @@ namespace OpenWifi {
 		return good;
 	}
 
+	void RTTYS_server::AttachDevice(ReactorShard &Shard, const Poco::Net::Socket &Socket,
+									std::shared_ptr<RTTYS_EndPoint> ConnectionEp) {
+		auto fd = Socket.impl()->sockfd();
+		ConnectionEp->Device_fd = fd;
+		Shard.Connected[fd] = ConnectionEp;
+		ConnectionEp->DeviceConnected_ = std::chrono::high_resolution_clock::now();
+		ConnectionEp->DeviceIsAttached_ = true;
+		ConnectionEp->DeviceSocket_ = Socket;
+		if(ConnectionEp->WSSocket_!= nullptr && ConnectionEp->WSSocket_->impl()!= nullptr) {
+			poco_information(Logger(),fmt::format("REG{}: Device registered, Client Registered - sending login", ConnectionEp->SerialNumber_));
+			Login(Socket, ConnectionEp);
+		} else {
+			poco_information(Logger(),fmt::format("REG{}: Device registered, Client Not Registered", ConnectionEp->SerialNumber_));
+		}
+	}
+
+	void RTTYS_server::MoveDeviceSocket(ReactorShard &From, const Poco::Net::Socket &Socket,
+										std::shared_ptr<RTTYS_EndPoint> EndPoint) {
+		std::unique_ptr<SecureSocketPair>	Pair;
+		{
+			std::lock_guard	Lock(From.Mutex);
+			auto hint = From.Sockets.find(Socket.impl()->sockfd());
+			if (hint == end(From.Sockets))
+				return;
+			RemoveDeviceEventHandlers(From, Socket);
+			Pair = std::move(hint->second);
+			From.Sockets.erase(hint);
+		}
+
+		auto &To = ShardOf(EndPoint);
+		std::lock_guard	Lock(To.Mutex);
+		{
+			std::lock_guard	G(EndPointsMutex_);
+			if (EndPoints_.find(EndPoint->Id_) == end(EndPoints_)) {
+				poco_debug(Logger(), fmt::format("{}: Session ended while moving device.", EndPoint->Id_));
+				Pair->socket.close();
+				return;
+			}
+		}
+		auto fd = Pair->socket.impl()->sockfd();
+		auto &Moved = *(To.Sockets[fd] = std::move(Pair));
+		AddDeviceEventHandlers(To, Moved.socket);
+		AttachDevice(To, Moved.socket, EndPoint);
+	}
+
 	void RTTYS_server::onConnectedDeviceTimeOut(const Poco::AutoPtr<Poco::Net::TimeoutNotification> &pNf) {
 		try {
 			u_char MsgBuf[RTTY_HDR_SIZE];
@@ -418,9 +487,9 @@ namespace OpenWifi {
 		}
 	}
 
-	void RTTYS_server::EmptyBuffer(int fd, const std::uint8_t *buffer, std::size_t len) {
-		auto EndPoint = Connected_.find(fd);
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
+	void RTTYS_server::EmptyBuffer(ReactorShard &Shard, int fd, const std::uint8_t *buffer, std::size_t len) {
+		auto EndPoint = Shard.Connected.find(fd);
+		if (EndPoint!=end(Shard.Connected) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
 			SendToClient(*EndPoint->second->WSSocket_, buffer,
 						 len);
 			EndPoint->second->rx += len;
@@ -431,13 +500,15 @@ namespace OpenWifi {
 	void RTTYS_server::onConnectedDeviceSocketReadable(
 		const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 
-		std::lock_guard	Lock(ServerMutex_);
+		auto &Shard = ShardOf(pNf->source());
+		std::unique_lock	Lock(Shard.Mutex);
 		int fd = pNf->socket().impl()->sockfd();
+		std::shared_ptr<RTTYS_EndPoint>	MoveTo;
 
 		try {
 
-			auto hint = Sockets_.find(fd);
-			if(hint==end(Sockets_)) {
+			auto hint = Shard.Sockets.find(fd);
+			if(hint==end(Shard.Sockets)) {
 				poco_error(Logger(),fmt::format("{}: unknown socket",fd));
 				return;
 			}
@@ -453,26 +524,26 @@ namespace OpenWifi {
 				received_bytes = hint->second->socket.receiveBytes(buffer);
 				if(received_bytes==0) {
 					poco_warning(Logger(), "Device Closing connection - 0 bytes received.");
-					EndConnection( pNf->socket(), __func__, __LINE__ );
+					EndConnection(Shard, pNf->socket(), __func__, __LINE__);
 					return;
 				}
 			} catch (const Poco::TimeoutException &E) {
 				poco_warning(Logger(), "Receive timeout");
-				EndConnection( pNf->socket(), __func__, __LINE__ );
+				EndConnection(Shard, pNf->socket(), __func__, __LINE__);
 				return;
 			} catch (const Poco::Net::NetException &E) {
 				Logger().log(E);
-				EndConnection( pNf->socket(), __func__, __LINE__ );
+				EndConnection(Shard, pNf->socket(), __func__, __LINE__);
 				return;
 			}
 
 			bool good = true;
 
-			while (!buffer.isEmpty() && good) {
+			while (!buffer.isEmpty() && good && MoveTo == nullptr) {
 
 				if(buffer.used() < RTTY_HDR_SIZE) {
 					if(agg_buf_pos>0) {
-						EmptyBuffer(fd, agg_buffer, agg_buf_pos);
+						EmptyBuffer(Shard, fd, agg_buffer, agg_buf_pos);
 					}
 					// poco_debug(Logger(),fmt::format("Not enough data in the pipe for header",buffer.used()));
 					return;
@@ -486,7 +557,7 @@ namespace OpenWifi {
 
 				if(buffer.used()<(RTTY_HDR_SIZE+msg_len)) {
 					if(agg_buf_pos>0) {
-						EmptyBuffer(fd, agg_buffer, agg_buf_pos);
+						EmptyBuffer(Shard, fd, agg_buffer, agg_buf_pos);
 					}
 					// poco_debug(Logger(),fmt::format("Not enough data in the pipe for command data",buffer.used()));
 					return;
@@ -496,16 +567,16 @@ namespace OpenWifi {
 
 				switch (LastCommand) {
 					case RTTYS_EndPoint::msgTypeRegister: {
-						good = do_msgTypeRegister(pNf->socket(), buffer, msg_len);
+						good = do_msgTypeRegister(Shard, pNf->socket(), buffer, msg_len, MoveTo);
 					} break;
 					case RTTYS_EndPoint::msgTypeLogin: {
-						good = do_msgTypeLogin(pNf->socket(), buffer, msg_len);
+						good = do_msgTypeLogin(Shard, pNf->socket(), buffer, msg_len);
 					} break;
 					case RTTYS_EndPoint::msgTypeLogout: {
 						good = do_msgTypeLogout(pNf->socket(), buffer, msg_len);
 					} break;
 					case RTTYS_EndPoint::msgTypeTermData: {
-						good = do_msgTypeTermData(pNf->socket(), buffer, msg_len, agg_buffer, agg_buf_pos);
+						good = do_msgTypeTermData(Shard, pNf->socket(), buffer, msg_len, agg_buffer, agg_buf_pos);
 					} break;
 					case RTTYS_EndPoint::msgTypeWinsize: {
 						good = do_msgTypeWinsize(pNf->socket(), buffer, msg_len);
@@ -514,7 +585,7 @@ namespace OpenWifi {
 						good = do_msgTypeCmd(pNf->socket(), buffer, msg_len);
 					} break;
 					case RTTYS_EndPoint::msgTypeHeartbeat: {
-						good = do_msgTypeHeartbeat(pNf->socket(), buffer, msg_len);
+						good = do_msgTypeHeartbeat(Shard, pNf->socket(), buffer, msg_len);
 					} break;
 					case RTTYS_EndPoint::msgTypeFile: {
 						good = do_msgTypeFile(pNf->socket(), buffer, msg_len);
@@ -538,41 +609,51 @@ namespace OpenWifi {
 			}
 
 			if(agg_buf_pos>0) {
-				EmptyBuffer(fd, agg_buffer, agg_buf_pos);
+				EmptyBuffer(Shard, fd, agg_buffer, agg_buf_pos);
 			}
 
 			if (!good) {
-				EndConnection(pNf->socket(), __func__, __LINE__);
+				EndConnection(Shard, pNf->socket(), __func__, __LINE__);
+			} else if (MoveTo != nullptr) {
+				Lock.unlock();
+				MoveDeviceSocket(Shard, pNf->socket(), MoveTo);
 			}
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
-			EndConnection(pNf->socket(), __func__,__LINE__);
+			if (!Lock.owns_lock())
+				Lock.lock();
+			EndConnection(Shard, pNf->socket(), __func__,__LINE__);
 		} catch (...) {
-			EndConnection(pNf->socket(), __func__,__LINE__);
+			if (!Lock.owns_lock())
+				Lock.lock();
+			EndConnection(Shard, pNf->socket(), __func__,__LINE__);
 		}
 	}
 
 	void RTTYS_server::onConnectedDeviceSocketShutdown(
 		const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf) {
-		std::lock_guard	Lock(ServerMutex_);
-		EndConnection(pNf->socket(), __func__,__LINE__);
+		auto &Shard = ShardOf(pNf->source());
+		std::lock_guard	Lock(Shard.Mutex);
+		EndConnection(Shard, pNf->socket(), __func__,__LINE__);
 	}
 
 	void RTTYS_server::onConnectedDeviceSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf) {
-		std::lock_guard	Lock(ServerMutex_);
-		EndConnection(pNf->socket(), __func__,__LINE__);
+		auto &Shard = ShardOf(pNf->source());
+		std::lock_guard	Lock(Shard.Mutex);
+		EndConnection(Shard, pNf->socket(), __func__,__LINE__);
 	}
 
 	void RTTYS_server::onClientSocketReadable(
 		const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 
-		std::lock_guard	Lock(ServerMutex_);
+		auto &Shard = ShardOf(pNf->source());
+		std::lock_guard	Lock(Shard.Mutex);
 
-		auto Client = Clients_.end();
+		auto Client = Shard.Clients.end();
 		std::shared_ptr<RTTYS_EndPoint> Connection;
 		try {
-			Client = Clients_.find(pNf->socket().impl()->sockfd());
-			if (Client == end(Clients_)) {
+			Client = Shard.Clients.find(pNf->socket().impl()->sockfd());
+			if (Client == end(Shard.Clients)) {
 				poco_warning(Logger(), fmt::format("Cannot find client socket: {}",
 												   pNf->socket().impl()->sockfd()));
 				return;
@@ -647,7 +728,7 @@ namespace OpenWifi {
 			}
 		} catch (...) {
 			poco_error(Logger(), "Frame readable shutdown.");
-			if (Client != Clients_.end() && Connection != nullptr) {
+			if (Client != Shard.Clients.end() && Connection != nullptr) {
 				EndConnection(Connection,__func__,__LINE__);
 			}
 			return;
@@ -656,9 +737,10 @@ namespace OpenWifi {
 
 	void RTTYS_server::onClientSocketShutdown(
 		const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf) {
-		std::lock_guard	Lock(ServerMutex_);
-		auto Client = Clients_.find(pNf->socket().impl()->sockfd());
-		if (Client == end(Clients_)) {
+		auto &Shard = ShardOf(pNf->source());
+		std::lock_guard	Lock(Shard.Mutex);
+		auto Client = Shard.Clients.find(pNf->socket().impl()->sockfd());
+		if (Client == end(Shard.Clients)) {
 			poco_warning(Logger(), fmt::format("Cannot find client socket: {}",
 											   pNf->socket().impl()->sockfd()));
 			return;
@@ -667,9 +749,10 @@ namespace OpenWifi {
 	}
 
 	void RTTYS_server::onClientSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf) {
-		std::lock_guard	Lock(ServerMutex_);
-		auto Client = Clients_.find(pNf->socket().impl()->sockfd());
-		if (Client == end(Clients_)) {
+		auto &Shard = ShardOf(pNf->source());
+		std::lock_guard	Lock(Shard.Mutex);
+		auto Client = Shard.Clients.find(pNf->socket().impl()->sockfd());
+		if (Client == end(Shard.Clients)) {
 			poco_warning(Logger(), fmt::format("Cannot find client socket: {}",
 											   pNf->socket().impl()->sockfd()));
 			return;
@@ -712,15 +795,27 @@ namespace OpenWifi {
 									  Poco::Net::HTTPServerResponse &response,
 									  const std::string &Id) {
 
-		std::lock_guard	Lock(ServerMutex_);
+		std::shared_ptr<RTTYS_EndPoint> EndPoint;
+		{
+			std::lock_guard	G(EndPointsMutex_);
+			auto hint = EndPoints_.find(Id);
+			if (hint != end(EndPoints_))
+				EndPoint = hint->second;
+		}
+		if (EndPoint == nullptr) {
+			poco_warning(Logger(), fmt::format("Session {} is invalid.", Id));
+			return;
+		}
 
-		auto EndPoint = EndPoints_.find(Id);
-		if (EndPoint == end(EndPoints_)) {
+		//	the client socket always joins the reactor that owns its session
+		auto &Shard = ShardOf(EndPoint);
+		std::lock_guard	Lock(Shard.Mutex);
+		if (!ValidId(Id)) {
 			poco_warning(Logger(), fmt::format("Session {} is invalid.", Id));
 			return;
 		}
 
-		if (EndPoint->second->WSSocket_ != nullptr) {
+		if (EndPoint->WSSocket_ != nullptr) {
 			poco_warning(Logger(), fmt::format("Session {} is a duplicate.", Id));
 			return;
 		}
@@ -728,25 +823,24 @@ namespace OpenWifi {
 
 		//	OK Create and register this WS client
 		try {
-			// EndPoint->second->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
-			EndPoint->second->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
-			EndPoint->second->ClientConnected_ = std::chrono::high_resolution_clock::now();
-			EndPoint->second->WSSocket_->setBlocking(false);
-			EndPoint->second->WSSocket_->setNoDelay(false);
-			EndPoint->second->WSSocket_->setKeepAlive(true);
+			EndPoint->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
+			EndPoint->ClientConnected_ = std::chrono::high_resolution_clock::now();
+			EndPoint->WSSocket_->setBlocking(false);
+			EndPoint->WSSocket_->setNoDelay(false);
+			EndPoint->WSSocket_->setKeepAlive(true);
 			Poco::Timespan	ST(600,0);
-			EndPoint->second->WSSocket_->setSendTimeout(ST);
-			EndPoint->second->WSSocket_->setSendBufferSize(1000000);
-			EndPoint->second->WSSocket_->setReceiveTimeout(ST);
-			EndPoint->second->WSSocket_->setReceiveBufferSize(1000000);
-			AddClientEventHandlers(*EndPoint->second->WSSocket_, EndPoint->second);
-			if (EndPoint->second->DeviceIsAttached_ && !EndPoint->second->completed_) {
-				poco_information(Logger(),fmt::format("CLN{}: Device registered, Client Registered - sending login", EndPoint->second->SerialNumber_));
-				auto hint = Sockets_.find(EndPoint->second->Device_fd);
-				if(hint!=end(Sockets_))
-					Login(hint->second->socket, EndPoint->second);
+			EndPoint->WSSocket_->setSendTimeout(ST);
+			EndPoint->WSSocket_->setSendBufferSize(1000000);
+			EndPoint->WSSocket_->setReceiveTimeout(ST);
+			EndPoint->WSSocket_->setReceiveBufferSize(1000000);
+			AddClientEventHandlers(Shard, *EndPoint->WSSocket_, EndPoint);
+			if (EndPoint->DeviceIsAttached_ && !EndPoint->completed_) {
+				poco_information(Logger(),fmt::format("CLN{}: Device registered, Client Registered - sending login", EndPoint->SerialNumber_));
+				auto hint = Shard.Sockets.find(EndPoint->Device_fd);
+				if(hint!=end(Shard.Sockets))
+					Login(hint->second->socket, EndPoint);
 			} else {
-				poco_information(Logger(),fmt::format("CLN{}: Device not registered, Client Registered", EndPoint->second->SerialNumber_));
+				poco_information(Logger(),fmt::format("CLN{}: Device not registered, Client Registered", EndPoint->SerialNumber_));
 			}
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -760,19 +854,36 @@ namespace OpenWifi {
 		Utils::SetThreadName("rt:janitor");
 		static auto LastStats = Utils::Now();
 
-		std::lock_guard	Lock(ServerMutex_);
 		auto Now = std::chrono::high_resolution_clock::now();
-		for (auto EndPoint = EndPoints_.begin(); EndPoint != EndPoints_.end();) {
-			if ((Now - EndPoint->second->Created_) > 2min && !EndPoint->second->completed_) {
-				EndPoint = EndConnection(EndPoint->second,__func__,__LINE__);
-			} else {
-				++EndPoint;
+		std::vector<std::shared_ptr<RTTYS_EndPoint>>	Stale;
+		{
+			std::lock_guard	G(EndPointsMutex_);
+			for (const auto &[Id, EndPoint] : EndPoints_) {
+				if ((Now - EndPoint->Created_) > 2min && !EndPoint->completed_)
+					Stale.push_back(EndPoint);
 			}
 		}
+		for (auto &EndPoint : Stale) {
+			std::lock_guard	Lock(ShardOf(EndPoint).Mutex);
+			if (!EndPoint->completed_)
+				EndConnection(EndPoint,__func__,__LINE__);
+		}
+
+		std::size_t NumberOfEndPoints, Connected = 0, Sockets = 0, Clients = 0;
+		{
+			std::lock_guard	G(EndPointsMutex_);
+			NumberOfEndPoints = EndPoints_.size();
+		}
+		for (auto &Shard : Shards_) {
+			std::lock_guard	Lock(Shard->Mutex);
+			Connected += Shard->Connected.size();
+			Sockets += Shard->Sockets.size();
+			Clients += Shard->Clients.size();
+		}
 
-		poco_information(Logger(),fmt::format("EndPoints:{} Connected:{} Sockets:{} Clients:{}",
-											   EndPoints_.size(),Connected_.size(),
-											   Sockets_.size(), Clients_.size()));
+		poco_information(Logger(),fmt::format("EndPoints:{} Connected:{} Sockets:{} Clients:{} Reactors:{}",
+											   NumberOfEndPoints, Connected,
+											   Sockets, Clients, Shards_.size()));
 
 		if (Utils::Now() - LastStats > (60 * 1)) {
 			LastStats = Utils::Now();
@@ -780,47 +891,47 @@ namespace OpenWifi {
 				"Statistics: Total connections:{} Current-connections:{} Avg-Device-Connection "
 				"Time: {:.2f}ms Avg-Client-Connection Time: {:.2f}ms #Sockets: {}. Connecting "
 				"devices: {}",
-				TotalEndPoints_, EndPoints_.size(),
+				TotalEndPoints_, NumberOfEndPoints,
 				TotalEndPoints_ ? TotalConnectedDeviceTime_.count() / (double)TotalEndPoints_ : 0.0,
 				TotalEndPoints_ ? TotalConnectedClientTime_.count() / (double)TotalEndPoints_ : 0.0,
-				Sockets_.size(), 0));
+				Sockets, 0));
 		}
 	}
 
-	std::map<std::string, std::shared_ptr<RTTYS_EndPoint>>::iterator RTTYS_server::EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t Line) {
-		auto hint1 = Sockets_.find(Connection->Device_fd);
-		if(hint1!=end(Sockets_))
-			RemoveSocket(hint1->second->socket);
+	void RTTYS_server::EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t Line) {
+		auto &Shard = ShardOf(Connection);
+		auto hint1 = Shard.Sockets.find(Connection->Device_fd);
+		if(hint1!=end(Shard.Sockets))
+			RemoveSocket(Shard, hint1->second->socket);
 
-		Connected_.erase(Connection->Device_fd);
+		Shard.Connected.erase(Connection->Device_fd);
 
 		//	find the client linked to this one...
 		if(Connection->WSSocket_!= nullptr && Connection->WSSocket_->impl()!= nullptr) {
-			RemoveClientEventHandlers(*Connection->WSSocket_);
+			RemoveClientEventHandlers(Shard, *Connection->WSSocket_);
 			Connection->WSSocket_->close();
 		}
 		poco_debug(Logger(),fmt::format("Closing connection {}:{}", func, Line));
-		auto hint2 = EndPoints_.find(Connection->Id_);
-		return EndPoints_.erase(hint2);
+		std::lock_guard	G(EndPointsMutex_);
+		EndPoints_.erase(Connection->Id_);
 	}
 
-	void RTTYS_server::EndConnection(const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line) {
+	void RTTYS_server::EndConnection(ReactorShard &Shard, const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line) {
 		//	remove the device
 		auto fd = Socket.impl()->sockfd();
-		RemoveSocket(Socket);
+		RemoveSocket(Shard, Socket);
 
 		//	find the client linked to this one...
-		auto hint = Connected_.find(fd);
-		if(hint!=end(Connected_)) {
+		auto hint = Shard.Connected.find(fd);
+		if(hint!=end(Shard.Connected)) {
+			auto id = hint->second->Id_;
 			if(hint->second->WSSocket_!= nullptr && hint->second->WSSocket_->impl()!= nullptr) {
-				RemoveClientEventHandlers(*hint->second->WSSocket_);
+				RemoveClientEventHandlers(Shard, *hint->second->WSSocket_);
 				hint->second->WSSocket_->close();
-				auto id = hint->second->Id_;
-				Connected_.erase(hint);
-				EndPoints_.erase(id);
-			} else {
-				EndPoints_.erase(hint->second->Id_);
 			}
+			Shard.Connected.erase(hint);
+			std::lock_guard	G(EndPointsMutex_);
+			EndPoints_.erase(id);
 		}
 
 		poco_debug(Logger(),fmt::format("Closing connection at {}:{}", func, Line));
@@ -831,29 +942,20 @@ namespace OpenWifi {
 									  const std::string &SerialNumber,
 									  bool mTLS) {
 
-		auto Start = Utils::Now();
-		while(!ServerMutex_.try_lock()) {
-			Poco::Thread::yield();
-			Poco::Thread::trySleep(100);
-			if((Utils::Now()-Start)>10) {
-				poco_warning(Logger(),"RTTY too busy");
-				return false;
-			}
-		}
-
-		if (MaxConcurrentSessions_ != 0 && EndPoints_.size() == MaxConcurrentSessions_) {
-			ServerMutex_.unlock();
+		std::lock_guard	G(EndPointsMutex_);
+		if (MaxConcurrentSessions_ != 0 && EndPoints_.size() >= MaxConcurrentSessions_) {
 			return false;
 		}
 
-		EndPoints_[Id] = std::make_shared<RTTYS_EndPoint>(Id, Token, SerialNumber, UserName, mTLS);
+		auto EndPoint = std::make_shared<RTTYS_EndPoint>(Id, Token, SerialNumber, UserName, mTLS);
+		EndPoint->Shard_ = NextShard_++ % Shards_.size();
+		EndPoints_[Id] = EndPoint;
 		++TotalEndPoints_;
-		ServerMutex_.unlock();
 		return true;
 	}
 
 	bool RTTYS_server::ValidId(const std::string &Id) {
-		std::lock_guard	Lock(ServerMutex_);
+		std::lock_guard	G(EndPointsMutex_);
 		return EndPoints_.find(Id) != EndPoints_.end();
 	}
 
@@ -995,10 +1097,10 @@ namespace OpenWifi {
 		return true;
 	}
 
-	bool RTTYS_server::do_msgTypeLogin(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, [[maybe_unused]] std::size_t msg_len) {
+	bool RTTYS_server::do_msgTypeLogin(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, [[maybe_unused]] std::size_t msg_len) {
 		poco_debug(Logger(), "Asking for login");
-		auto EndPoint = Connected_.find(Socket.impl()->sockfd());
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
+		auto EndPoint = Shard.Connected.find(Socket.impl()->sockfd());
+		if (EndPoint!=end(Shard.Connected) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
 			try {
 				nlohmann::json doc;
 				unsigned char Error = *buffer.begin();
@@ -1030,9 +1132,9 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool RTTYS_server::do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos) {
-		auto EndPoint = Connected_.find(Socket.impl()->sockfd());
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
+	bool RTTYS_server::do_msgTypeTermData(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos) {
+		auto EndPoint = Shard.Connected.find(Socket.impl()->sockfd());
+		if (EndPoint!=end(Shard.Connected) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
 			try {
 				buffer.drain(1);
 				msg_len--;
@@ -1062,14 +1164,14 @@ namespace OpenWifi {
 		return true;
 	}
 
-	bool RTTYS_server::do_msgTypeHeartbeat(const Poco::Net::Socket &Socket, [[maybe_unused]] Poco::FIFOBuffer &buffer, [[maybe_unused]] std::size_t msg_len) {
+	bool RTTYS_server::do_msgTypeHeartbeat(ReactorShard &Shard, const Poco::Net::Socket &Socket, [[maybe_unused]] Poco::FIFOBuffer &buffer, [[maybe_unused]] std::size_t msg_len) {
 		try {
 			u_char MsgBuf[RTTY_HDR_SIZE + 16]{0};
 			MsgBuf[0] = RTTYS_EndPoint::msgTypeHeartbeat;
 			MsgBuf[1] = 0;
 			MsgBuf[2] = 0;
-			auto hint = Connected_.find(Socket.impl()->sockfd());
-			if(hint!=end(Connected_)) {
+			auto hint = Shard.Connected.find(Socket.impl()->sockfd());
+			if(hint!=end(Shard.Connected)) {
 				auto Sent = SendBytes(hint->second,Socket, MsgBuf, RTTY_HDR_SIZE);
 				return Sent == RTTY_HDR_SIZE;
 			}
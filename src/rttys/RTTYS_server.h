@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "Poco/Net/HTTPServer.h"
 #include "Poco/Net/SocketAcceptor.h"
@@ -106,6 +110,7 @@ namespace OpenWifi {
 		bool DeviceIsAttached_ = false;
 		poco_socket_t	Device_fd=-1;
 		std::uint64_t TID_ = 0;
+		std::size_t Shard_ = 0;		//	reactor owning both the device and the client socket
 		std::unique_ptr<Poco::Net::WebSocket>		WSSocket_;
 		unsigned char sid_=0;
 		unsigned char small_buf_[64 + RTTY_SESSION_ID_LENGTH]{0};
@@ -167,6 +172,17 @@ namespace OpenWifi {
 
 
 	  private:
+		//	Each session is pinned to one reactor. A shard owns the reactor, its thread and the
+		//	sockets dispatched by it. Its mutex also protects the endpoints pinned to it.
+		struct ReactorShard {
+			std::mutex										Mutex;
+			Poco::Net::SocketReactor						Reactor;
+			Poco::Thread									Thread;
+			std::map<int, std::shared_ptr<RTTYS_EndPoint>> 	Connected; 	//	device fd, endpoint
+			std::map<int, std::shared_ptr<RTTYS_EndPoint>> 	Clients;	//	client fd, endpoint
+			std::map<int, std::unique_ptr<SecureSocketPair>>	Sockets;	//	device fd
+		};
+
 		void onTimer(Poco::Timer &timer);
 
 		void onDeviceAccept(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
@@ -181,22 +197,18 @@ namespace OpenWifi {
 		void onClientSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void onClientSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
 
-		void RemoveClientEventHandlers(Poco::Net::WebSocket &Socket);
-		void RemoveConnectedDeviceEventHandlers(Poco::Net::StreamSocket &Socket);
-
-		void RemoveDeviceEventHandlers(const Poco::Net::Socket &Socket);
-		void AddDeviceEventHandlers(Poco::Net::Socket &Socket);
-
-		void AddConnectedDeviceEventHandlers(std::shared_ptr<RTTYS_EndPoint> ep);
-		void AddClientEventHandlers(Poco::Net::WebSocket &Socket,
+		void RemoveClientEventHandlers(ReactorShard &Shard, Poco::Net::WebSocket &Socket);
+		void AddClientEventHandlers(ReactorShard &Shard, Poco::Net::WebSocket &Socket,
 									std::shared_ptr<RTTYS_EndPoint> EndPoint);
 
+		//	Both require the caller to hold the lock of the shard owning the connection.
+		void EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t l);
+		void EndConnection(ReactorShard &Shard, const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line);
 
-
-		std::map<std::string, std::shared_ptr<RTTYS_EndPoint>>::iterator EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t l);
-		void EndConnection(const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line);
-
-		Poco::Net::SocketReactor &Reactor() { return Reactor_; }
+		ReactorShard &ShardOf(const Poco::Net::SocketReactor &Reactor);
+		inline ReactorShard &ShardOf(const std::shared_ptr<RTTYS_EndPoint> &EndPoint) {
+			return *Shards_[EndPoint->Shard_];
+		}
 
 		void SendData(std::shared_ptr<RTTYS_EndPoint> &Connection, const u_char *Buf, size_t len);
 		void SendData(std::shared_ptr<RTTYS_EndPoint> &Connection, const std::string &s);
@@ -208,22 +220,26 @@ namespace OpenWifi {
 															  const std::string &Token);
 
 		void AddNewSocket(Poco::Net::StreamSocket &S, std::unique_ptr<Poco::Crypto::X509Certificate> P, bool valid, const std::string &cid, const std::string &CN);
-		void RemoveSocket(const Poco::Net::Socket &Socket);
+		void RemoveSocket(ReactorShard &Shard, const Poco::Net::Socket &Socket);
+		void AddDeviceEventHandlers(ReactorShard &Shard, const Poco::Net::Socket &Socket);
+		void RemoveDeviceEventHandlers(ReactorShard &Shard, const Poco::Net::Socket &Socket);
+		void AttachDevice(ReactorShard &Shard, const Poco::Net::Socket &Socket, std::shared_ptr<RTTYS_EndPoint> EndPoint);
+		void MoveDeviceSocket(ReactorShard &From, const Poco::Net::Socket &Socket, std::shared_ptr<RTTYS_EndPoint> EndPoint);
 		void LogStdException(const std::exception &E, const std::string & msg);
 
-		bool do_msgTypeRegister(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
-		bool do_msgTypeLogin(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
-		bool do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos);
+		bool do_msgTypeRegister(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::shared_ptr<RTTYS_EndPoint> &MoveTo);
+		bool do_msgTypeLogin(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
+		bool do_msgTypeTermData(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos);
 		bool do_msgTypeLogout(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeWinsize(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeCmd(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
-		bool do_msgTypeHeartbeat(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
+		bool do_msgTypeHeartbeat(ReactorShard &Shard, const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeFile(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeHttp(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeAck(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeMax(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 
-		void EmptyBuffer(int fd, const std::uint8_t *buffer, std::size_t len);
+		void EmptyBuffer(ReactorShard &Shard, int fd, const std::uint8_t *buffer, std::size_t len);
 		bool WindowSize(std::shared_ptr<RTTYS_EndPoint> Conn, int cols, int rows);
 		bool KeyStrokes(std::shared_ptr<RTTYS_EndPoint> Conn, const u_char *buf, size_t len);
 
@@ -235,9 +251,9 @@ namespace OpenWifi {
 		bool SendToClient(Poco::Net::WebSocket &WebSocket, const u_char *Buf, int len);
 		bool SendToClient(Poco::Net::WebSocket &WebSocket, const std::string &s);
 
-		std::mutex					ServerMutex_;
-		Poco::Net::SocketReactor 	Reactor_;
-		Poco::Thread 				ReactorThread_;
+		std::mutex					EndPointsMutex_;	//	EndPoints_ only, never held while taking a shard lock
+		std::vector<std::unique_ptr<ReactorShard>>	Shards_;
+		std::atomic_uint64_t		NextShard_ = 0;
 		std::string 				RTTY_UIAssets_;
 		bool 						Internal_ = false;
 		bool 						NoSecurity_ = false;
@@ -245,9 +261,6 @@ namespace OpenWifi {
 
 		std::unique_ptr<Poco::Net::HTTPServer> 					WebServer_;
 		std::map<std::string, std::shared_ptr<RTTYS_EndPoint>> 	EndPoints_; //	id, endpoint
-		std::map<int, std::shared_ptr<RTTYS_EndPoint>> 			Connected_; //	id, endpoint
-		std::map<int, std::shared_ptr<RTTYS_EndPoint>> 			Clients_;
-		std::map<int, std::unique_ptr<SecureSocketPair>>		Sockets_;
 
 		Poco::Timer Timer_;
 		std::unique_ptr<Poco::TimerCallback<RTTYS_server>> GCCallBack_;
@@ -6,8 +6,15 @@
 //	Arilia Wireless Inc.
 //
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include "Poco/Data/RecordSet.h"
+#include "Poco/String.h"
 #include "RESTObjects/RESTAPI_GWobjects.h"
+#include "SharedSnapshot.h"
 #include "StorageService.h"
 #include "fmt/format.h"
 
@@ -59,8 +66,14 @@ namespace OpenWifi {
 		std::uint64_t created=Utils::Now();
 	};
 
-	static std::map<std::uint64_t , DeviceDetails> BlackListDevices;
-	static std::recursive_mutex BlackListMutex;
+	//	Every device message checks the blacklist, so readers use their thread's copy of the current
+	//	snapshot. Writers are serialised, copy the current map, change the copy and publish it.
+	using BlackListMap = std::unordered_map<std::uint64_t, DeviceDetails>;
+	static SharedSnapshot<BlackListMap> BlackListDevices;
+
+	template <typename Func> static void UpdateBlackList(Func &&Change) {
+		BlackListDevices.Update(std::forward<Func>(Change));
+	}
 
 	bool Storage::InitializeBlackListCache() {
 		try {
@@ -72,16 +85,19 @@ namespace OpenWifi {
 
 			Poco::Data::RecordSet RSet(Select);
 
+			auto Devices = std::make_shared<BlackListMap>();
+			Devices->reserve(RSet.rowCount());
 			bool More = RSet.moveFirst();
 			while (More) {
 				auto SerialNumber = RSet[0].convert<std::string>();
 				auto Reason = RSet[1].convert<std::string>();
 				auto Author = RSet[2].convert<std::string>();
 				auto Created = RSet[3].convert<std::uint64_t>();
-				BlackListDevices[Utils::MACToInt(SerialNumber)] =
+				(*Devices)[Utils::MACToInt(SerialNumber)] =
 					DeviceDetails{.reason = Reason, .author = Author, .created = Created};
 				More = RSet.moveNext();
 			}
+			BlackListDevices.Publish(std::move(Devices));
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -104,9 +120,10 @@ namespace OpenWifi {
 			Insert << ConvertParams(St), Poco::Data::Keywords::use(T);
 			Insert.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
-				.reason = Device.reason, .author = Device.author, .created = Device.created};
+			UpdateBlackList([&](BlackListMap &Devices) {
+				Devices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
+					.reason = Device.reason, .author = Device.author, .created = Device.created};
+			});
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -115,11 +132,71 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices) {
+	bool Storage::AddBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices,
+									  std::vector<std::uint64_t> &NewlyBlackListed) {
+		//	Imports are upserts: each batch deletes the rows it is about to insert, all inside one
+		//	transaction, and the snapshot is published once at the end.
 		try {
-			for (auto &i : Devices) {
-				AddBlackListDevice(i);
+			for (auto &Device : Devices)
+				Poco::toLowerInPlace(Device.serialNumber);
+			//	a serial number may only appear once per INSERT, the last occurrence wins.
+			std::stable_sort(Devices.begin(), Devices.end(),
+							 [](const GWObjects::BlackListedDevice &A,
+								const GWObjects::BlackListedDevice &B) {
+								 return A.serialNumber < B.serialNumber;
+							 });
+			auto Unique = std::unique(Devices.rbegin(), Devices.rend(),
+									  [](const GWObjects::BlackListedDevice &A,
+										 const GWObjects::BlackListedDevice &B) {
+										  return A.serialNumber == B.serialNumber;
+									  });
+			Devices.erase(Devices.begin(), Unique.base());
+
+			Poco::Data::Session Sess = Pool_->get();
+			Sess.begin();
+			for (std::size_t First = 0; First < Devices.size(); First += MaxRowsPerInsert) {
+				auto Last = std::min(Devices.size(), First + MaxRowsPerInsert);
+
+				std::string Del{"DELETE FROM BlackList WHERE SerialNumber IN ("};
+				std::string St{"INSERT INTO BlackList (" + DB_BlackListDeviceSelectFields +
+							   ") VALUES "};
+				for (auto i = First; i < Last; ++i) {
+					Del += (i == First ? "?" : ",?");
+					St += (i == First ? "(?,?,?,?)" : ", (?,?,?,?)");
+				}
+				Del += ")";
+
+				Poco::Data::Statement Delete(Sess);
+				Delete << ConvertParams(Del);
+				for (auto i = First; i < Last; ++i) {
+					Delete, Poco::Data::Keywords::use(Devices[i].serialNumber);
+				}
+				Delete.execute();
+
+				Poco::Data::Statement Insert(Sess);
+				Insert << ConvertParams(St);
+				for (auto i = First; i < Last; ++i) {
+					Insert, Poco::Data::Keywords::use(Devices[i].serialNumber),
+						Poco::Data::Keywords::use(Devices[i].reason),
+						Poco::Data::Keywords::use(Devices[i].created),
+						Poco::Data::Keywords::use(Devices[i].author);
+				}
+				Insert.execute();
 			}
+			Sess.commit();
+
+			UpdateBlackList([&](BlackListMap &Current) {
+				Current.reserve(Current.size() + Devices.size());
+				for (const auto &Device : Devices) {
+					auto SerialNumber = Utils::MACToInt(Device.serialNumber);
+					if (Current.find(SerialNumber) == Current.end())
+						NewlyBlackListed.push_back(SerialNumber);
+					Current[SerialNumber] = DeviceDetails{
+						.reason = Device.reason, .author = Device.author, .created = Device.created};
+				}
+			});
+			poco_information(Logger(), fmt::format("Imported {} blacklist entries, {} new.",
+												   Devices.size(), NewlyBlackListed.size()));
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -140,8 +217,8 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(SerialNumber);
 			Delete.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices.erase(Utils::MACToInt(SerialNumber));
+			UpdateBlackList(
+				[&](BlackListMap &Devices) { Devices.erase(Utils::MACToInt(SerialNumber)); });
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -191,9 +268,10 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
 			Sess.commit();
-			std::lock_guard G(BlackListMutex);
-			BlackListDevices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
-				.reason = Device.reason, .author = Device.author, .created = Device.created};
+			UpdateBlackList([&](BlackListMap &Devices) {
+				Devices[Utils::MACToInt(Device.serialNumber)] = DeviceDetails{
+					.reason = Device.reason, .author = Device.author, .created = Device.created};
+			});
 
 			return true;
 
@@ -231,16 +309,33 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::ExportBlackListDevices(std::vector<GWObjects::BlackListedDevice> &Devices) {
+		auto Snapshot = BlackListDevices.Load();
+		Devices.reserve(Snapshot->size());
+		for (const auto &[SerialNumber, Details] : *Snapshot) {
+			GWObjects::BlackListedDevice D;
+			D.serialNumber = Utils::IntToSerialNumber(SerialNumber);
+			D.reason = Details.reason;
+			D.author = Details.author;
+			D.created = Details.created;
+			Devices.push_back(std::move(D));
+		}
+		std::sort(Devices.begin(), Devices.end(),
+				  [](const GWObjects::BlackListedDevice &A, const GWObjects::BlackListedDevice &B) {
+					  return A.serialNumber < B.serialNumber;
+				  });
+		return true;
+	}
+
 	uint64_t Storage::GetBlackListDeviceCount() {
-		std::lock_guard G(BlackListMutex);
-		return BlackListDevices.size();
+		return BlackListDevices.Get().size();
 	}
 
 	bool Storage::IsBlackListed(std::uint64_t SerialNumber, std::string &reason,
 								std::string &author, std::uint64_t &created) {
-		std::lock_guard G(BlackListMutex);
-		auto DeviceHint = BlackListDevices.find(SerialNumber);
-		if (DeviceHint == end(BlackListDevices))
+		const auto &Devices = BlackListDevices.Get();
+		auto DeviceHint = Devices.find(SerialNumber);
+		if (DeviceHint == Devices.end())
 			return false;
 		reason = DeviceHint->second.reason;
 		author = DeviceHint->second.author;
@@ -249,8 +344,7 @@ namespace OpenWifi {
 	}
 
 	bool Storage::IsBlackListed(std::uint64_t SerialNumber) {
-		std::lock_guard G(BlackListMutex);
-		auto DeviceHint = BlackListDevices.find(SerialNumber);
-		return DeviceHint != end(BlackListDevices);
+		const auto &Devices = BlackListDevices.Get();
+		return Devices.find(SerialNumber) != Devices.end();
 	}
 } // namespace OpenWifi
\ No newline at end of file
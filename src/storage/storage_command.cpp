@@ -11,6 +11,7 @@
 #include "Poco/Data/LOBStream.h"
 #include "Poco/Data/RecordSet.h"
 #include "Poco/File.h"
+#include "Poco/Path.h"
 
 #include "AP_WS_Server.h"
 #include "CommandManager.h"
@@ -21,6 +22,19 @@
 
 namespace OpenWifi {
 
+	//	Uploaded files are kept in the uploader directory, the FileUploads row only has their name.
+	//	Without a usable directory they are kept in the FileContent BLOB instead.
+	static void RemoveUploadedFile(const std::string &FileName, Poco::Logger &Logger) {
+		if (FileName.empty() || FileUploader()->Path().empty())
+			return;
+		try {
+			Poco::File(Poco::Path(FileUploader()->Path(), FileName)).remove();
+		} catch (const Poco::FileNotFoundException &) {
+		} catch (const Poco::Exception &E) {
+			Logger.log(E);
+		}
+	}
+
 	const static std::string DB_Command_SelectFields{"UUID, "
 													 "SerialNumber, "
 													 "Command, "
@@ -433,6 +447,13 @@ namespace OpenWifi {
 	bool Storage::DeleteCommand(std::string &UUID) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+			std::string FileName;
+			Poco::Data::Statement Select(Sess);
+			std::string St0{"SELECT FileName FROM FileUploads WHERE UUID=?"};
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(FileName),
+				Poco::Data::Keywords::use(UUID);
+			Select.execute();
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -445,6 +466,7 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Sess.commit();
+			RemoveUploadedFile(FileName, Logger());
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -480,31 +502,49 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
-											std::vector<GWObjects::CommandDetails> &Commands) {
-
+	bool Storage::GetQueuedCommands(std::uint64_t SubmittedSince,
+									std::vector<GWObjects::CommandDetails> &Commands) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			auto Now = Utils::Now();
-			std::string St{"SELECT " + DB_Command_SelectFields +
-						   " FROM CommandList "
-						   " WHERE ((RunAt<=?) And (Executed=0) And (LastTry=0 or (" +
-						   std::to_string(Now) + "-LastTry)>" +
-						   std::to_string(CommandManager()->CommandRetry()) +
-						   ")) ORDER BY Submitted ASC "};
-			CommandDetailsRecordList Records;
-
-			std::string SS = ConvertParams(St) + ComputeRange(Offset, HowMany);
-			Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now);
-			Select.execute();
+			//	Only what the in-memory queue needs: details are read again when the command is sent.
+			typedef Poco::Tuple<std::string, std::string, std::string, uint64_t, uint64_t, uint64_t>
+				QueuedCommandRecord;
+			std::vector<QueuedCommandRecord> Records;
+
+			//	Pages are keyed on (Submitted, UUID), so each one starts where the previous one
+			//	ended instead of skipping rows. UUIDs are never empty: the first page is every row
+			//	submitted at or after SubmittedSince.
+			constexpr std::uint64_t PageSize = 5000;
+			std::uint64_t LastSubmitted = SubmittedSince;
+			std::string LastUUID;
+			while (true) {
+				std::string St{"SELECT UUID, SerialNumber, Command, Submitted, RunAt, LastTry FROM "
+							   "CommandList WHERE Executed=0 AND (Submitted>? OR (Submitted=? AND "
+							   "UUID>?)) ORDER BY Submitted ASC, UUID ASC " +
+							   ComputeRange(0, PageSize)};
+				Select << ConvertParams(St), Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::use(LastSubmitted), Poco::Data::Keywords::use(LastSubmitted),
+					Poco::Data::Keywords::use(LastUUID);
+				Select.execute();
+				Select.reset(Sess);
 
-			for (const auto &record : Records) {
-				GWObjects::CommandDetails R;
-				ConvertCommandRecord(record, R);
-				if (AP_WS_Server()->Connected(Utils::SerialNumberToInt(R.SerialNumber)))
-					Commands.push_back(R);
+				for (const auto &Record : Records) {
+					GWObjects::CommandDetails R;
+					R.UUID = Record.get<0>();
+					R.SerialNumber = Record.get<1>();
+					R.Command = Record.get<2>();
+					R.Submitted = Record.get<3>();
+					R.RunAt = Record.get<4>();
+					R.lastTry = Record.get<5>();
+					Commands.emplace_back(std::move(R));
+				}
+				if (Records.size() < PageSize)
+					break;
+				LastSubmitted = Commands.back().Submitted;
+				LastUUID = Commands.back().UUID;
+				Records.clear();
 			}
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -636,39 +676,28 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::stringstream &FileContent,
-										  const std::string &Type) {
+	//	The file itself has already been spooled to FileName in the uploader directory.
+	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::string &FileName,
+										  std::uint64_t Size, const std::string &Type) {
 		try {
 			auto Now = Utils::Now();
 			uint64_t WaitForFile = 0;
-			uint64_t Size = FileContent.str().size();
 
 			Poco::Data::Session Sess = Pool_->get();
 			Sess.begin();
 			Poco::Data::Statement Statement(Sess);
 
-			if (Size < FileUploader()->MaxSize()) {
-
-				Poco::Data::BLOB TheBlob;
-
-				TheBlob.appendRaw((const unsigned char *)FileContent.str().c_str(),
-								  FileContent.str().size());
-				Sess.begin();
-				Poco::Data::Statement Insert(Sess);
-				std::string FileType{Type};
+			Poco::Data::Statement Insert(Sess);
+			std::string FileType{Type};
+			std::string Name{FileName};
 
-				std::string St2{
-					"INSERT INTO FileUploads (UUID,Type,Created,FileContent) VALUES(?,?,?,?)"};
+			std::string St2{
+				"INSERT INTO FileUploads (UUID,Type,Created,FileName) VALUES(?,?,?,?)"};
 
-				Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
-					Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
-					Poco::Data::Keywords::use(TheBlob);
-				Insert.execute();
-				Sess.commit();
-			} else {
-				poco_warning(Logger(), fmt::format("File {} is too large.", UUID));
-			}
-			Sess.commit();
+			Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
+				Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
+				Poco::Data::Keywords::use(Name);
+			Insert.execute();
 
 			// update CommandList here to ensure that file us uploaded
 			std::string StatementStr;
@@ -688,15 +717,60 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-										 std::string &FileContent, std::string &Type, int &WaitingForFile) {
+	//	Used when the uploader has no directory to keep files in.
+	bool Storage::AttachFileContentToCommand(std::string &UUID, const std::string &Content,
+											 const std::string &Type) {
+		try {
+			auto Now = Utils::Now();
+			uint64_t WaitForFile = 0;
+			uint64_t Size = Content.size();
+
+			Poco::Data::BLOB TheBlob;
+			TheBlob.appendRaw((const unsigned char *)Content.c_str(), Content.size());
+
+			Poco::Data::Session Sess = Pool_->get();
+			Sess.begin();
+			Poco::Data::Statement Insert(Sess);
+			std::string FileType{Type};
+
+			std::string St2{
+				"INSERT INTO FileUploads (UUID,Type,Created,FileContent) VALUES(?,?,?,?)"};
+
+			Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
+				Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
+				Poco::Data::Keywords::use(TheBlob);
+			Insert.execute();
+
+			Poco::Data::Statement Statement(Sess);
+			std::string StatementStr{
+				"UPDATE CommandList SET WaitingForFile=?, AttachDate=?, AttachSize=? WHERE UUID=?"};
+
+			Statement << ConvertParams(StatementStr), Poco::Data::Keywords::use(WaitForFile),
+				Poco::Data::Keywords::use(Now), Poco::Data::Keywords::use(Size),
+				Poco::Data::Keywords::use(UUID);
+			Statement.execute();
+			Sess.commit();
+
+			return true;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
+	//	Files uploaded since they are spooled to disk come back as FilePath. Older uploads still
+	//	have their content in the FileContent BLOB.
+	bool Storage::GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+								  std::string &FilePath, std::string &FileContent,
+								  std::string &Type, int &WaitingForFile) {
 		try {
 			Poco::Data::BLOB L;
 			/*
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BYTEA"
+						"FileContent	BYTEA, "
+						"FileName		TEXT"
 			*/
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select1(Sess);
@@ -712,11 +786,22 @@ namespace OpenWifi {
 				return false;
 			}
 
-			std::string St2{"SELECT FileContent, Type FROM FileUploads WHERE UUID=?"};
+			std::string FileName;
+			std::string St2{"SELECT FileName, Type FROM FileUploads WHERE UUID=?"};
 			Poco::Data::Statement Select2(Sess);
-			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(L),
+			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(FileName),
 				Poco::Data::Keywords::into(Type), Poco::Data::Keywords::use(UUID);
 			Select2.execute();
+			if (!FileName.empty() && !FileUploader()->Path().empty()) {
+				FilePath = Poco::Path(FileUploader()->Path(), FileName).toString();
+				return true;
+			}
+
+			std::string St3{"SELECT FileContent FROM FileUploads WHERE UUID=?"};
+			Poco::Data::Statement Select3(Sess);
+			Select3 << ConvertParams(St3), Poco::Data::Keywords::into(L),
+				Poco::Data::Keywords::use(UUID);
+			Select3.execute();
 			FileContent.assign(L.content().begin(), L.content().end());
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -751,6 +836,13 @@ namespace OpenWifi {
 	bool Storage::RemoveAttachedFile(std::string &UUID) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+			std::string FileName;
+			Poco::Data::Statement Select(Sess);
+			std::string St0{"SELECT FileName FROM FileUploads WHERE UUID=?"};
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(FileName),
+				Poco::Data::Keywords::use(UUID);
+			Select.execute();
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -759,6 +851,7 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Sess.commit();
+			RemoveUploadedFile(FileName, Logger());
 			return true;
 
 		} catch (const Poco::Exception &E) {
@@ -770,6 +863,13 @@ namespace OpenWifi {
 	bool Storage::RemoveUploadedFilesRecordsOlderThan(uint64_t Date) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
+			std::vector<std::string> FileNames;
+			Poco::Data::Statement Select(Sess);
+			std::string St0{"select FileName from FileUploads where Created<?"};
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(FileNames),
+				Poco::Data::Keywords::use(Date);
+			Select.execute();
+
 			Sess.begin();
 			Poco::Data::Statement Delete(Sess);
 
@@ -777,6 +877,8 @@ namespace OpenWifi {
 			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
 			Delete.execute();
 			Sess.commit();
+			for (const auto &FileName : FileNames)
+				RemoveUploadedFile(FileName, Logger());
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
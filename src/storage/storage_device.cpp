@@ -454,6 +454,24 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::SetDeviceLocale(std::string &SerialNumber, std::string &Locale) {
+		try {
+			Poco::Data::Session Session = Pool_->get();
+			Session.begin();
+			Poco::Data::Statement 	Update(Session);
+			std::string St{"UPDATE Devices SET locale=?  WHERE SerialNumber=?"};
+
+			Update << ConvertParams(St), Poco::Data::Keywords::use(Locale),
+				Poco::Data::Keywords::use(SerialNumber);
+			Update.execute();
+			Session.commit();
+			return true;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+		return false;
+	}
+
 	bool Storage::CreateDevice(Poco::Data::Session &Sess, GWObjects::Device &DeviceDetails) {
 		std::string SerialNumber;
 		try {
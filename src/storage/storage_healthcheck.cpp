@@ -57,6 +57,38 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::AddHealthCheckData(Poco::Data::Session &Session,
+									 std::vector<GWObjects::HealthCheck> &Checks) {
+		try {
+			Session.begin();
+			for (std::size_t First = 0; First < Checks.size(); First += MaxRowsPerInsert) {
+				auto Last = std::min(Checks.size(), First + MaxRowsPerInsert);
+				std::string St{"INSERT INTO HealthChecks ( " + DB_HealthCheckSelectFields +
+							   " ) VALUES "};
+				Poco::Data::Statement Insert(Session);
+				for (auto i = First; i < Last; ++i) {
+					St += (i == First ? "( " : ", ( ") + DB_HealthCheckInsertValues + " )";
+				}
+				Insert << ConvertParams(St);
+				for (auto i = First; i < Last; ++i) {
+					Insert, Poco::Data::Keywords::use(Checks[i].SerialNumber),
+						Poco::Data::Keywords::use(Checks[i].UUID),
+						Poco::Data::Keywords::use(Checks[i].Data),
+						Poco::Data::Keywords::use(Checks[i].Sanity),
+						Poco::Data::Keywords::use(Checks[i].Recorded);
+				}
+				Insert.execute();
+			}
+			Session.commit();
+			poco_trace(Logger(), fmt::format("Added {} healthcheck records.", Checks.size()));
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
 	bool Storage::GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 									 uint64_t Offset, uint64_t HowMany,
 									 std::vector<GWObjects::HealthCheck> &Checks) {
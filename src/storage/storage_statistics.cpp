@@ -54,6 +54,36 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::AddStatisticsData(Poco::Data::Session &Session,
+									std::vector<GWObjects::Statistics> &Stats) {
+		try {
+			Session.begin();
+			for (std::size_t First = 0; First < Stats.size(); First += MaxRowsPerInsert) {
+				auto Last = std::min(Stats.size(), First + MaxRowsPerInsert);
+				std::string St{"INSERT INTO Statistics ( " + DB_StatsSelectFields + " ) VALUES "};
+				Poco::Data::Statement Insert(Session);
+				for (auto i = First; i < Last; ++i) {
+					St += (i == First ? "( " : ", ( ") + DB_StatsInsertValues + " )";
+				}
+				Insert << ConvertParams(St);
+				for (auto i = First; i < Last; ++i) {
+					Insert, Poco::Data::Keywords::use(Stats[i].SerialNumber),
+						Poco::Data::Keywords::use(Stats[i].UUID),
+						Poco::Data::Keywords::use(Stats[i].Data),
+						Poco::Data::Keywords::use(Stats[i].Recorded);
+				}
+				Insert.execute();
+			}
+			Session.commit();
+			poco_trace(Logger(), fmt::format("Added {} statistics records.", Stats.size()));
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
 	bool Storage::GetNumberOfStatisticsDataRecords(std::string &SerialNumber, uint64_t FromDate,
 												   uint64_t ToDate, std::uint64_t &Count) {
 		try {
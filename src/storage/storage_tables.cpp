@@ -382,7 +382,9 @@ namespace OpenWifi {
 			dbType_ == mysql ? "alter table CommandList add column executionTime float default 0.00"
 							 : "alter table CommandList add column executionTime real default 0.00",
 			"alter table CommandList add column LastTry bigint default 0",
-			"alter table CommandList add column deferred BOOLEAN default false"};
+			"alter table CommandList add column deferred BOOLEAN default false",
+			dbType_ == mysql ? "create index CommandListSubmitted on CommandList (Submitted)"
+							 : "create index if not exists CommandListSubmitted on CommandList (Submitted)"};
 
 		for (const auto &i : Script) {
 			try {
@@ -426,7 +428,8 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BLOB"
+						"FileContent	BLOB, "
+						"FileName		TEXT"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == mysql) {
@@ -434,7 +437,8 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	LONGBLOB"
+						"FileContent	LONGBLOB, "
+						"FileName		TEXT"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == pgsql) {
@@ -442,11 +446,23 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BYTEA"
+						"FileContent	BYTEA, "
+						"FileName		TEXT"
 						") ",
 					Poco::Data::Keywords::now;
 			}
 
+			std::vector<std::string> Script{
+				"alter table FileUploads add column FileName TEXT"
+			};
+
+			for (const auto &i : Script) {
+				try {
+					Sess << i, Poco::Data::Keywords::now;
+				} catch (...) {
+				}
+			}
+
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AP_WS_ConnectionTable.h"
+
+using namespace OpenWifi;
+
+namespace {
+
+	//	The table never looks inside a connection, so an aliasing pointer to a plain object stands in
+	//	for one. It is never dereferenced.
+	AP_WS_ConnectionTable::ConnectionPtr Fake() {
+		auto Holder = std::make_shared<int>(0);
+		return {Holder, reinterpret_cast<AP_WS_Connection *>(Holder.get())};
+	}
+
+} // namespace
+
+TEST(AP_WS_ConnectionTable, ShardsAreAPowerOfTwo) {
+	AP_WS_ConnectionTable Table;
+	EXPECT_EQ(Table.Size(), 1u);
+	Table.Resize(1);
+	EXPECT_EQ(Table.Size(), 1u);
+	Table.Resize(200);
+	EXPECT_EQ(Table.Size(), 256u);
+	Table.Resize(256);
+	EXPECT_EQ(Table.Size(), 256u);
+	Table.Resize(1ULL << 40);
+	EXPECT_EQ(Table.Size(), 1ULL << 16);
+}
+
+TEST(AP_WS_ConnectionTable, InsertFindTake) {
+	AP_WS_ConnectionTable Table;
+	Table.Resize(64);
+	auto A = Fake(), B = Fake();
+	EXPECT_TRUE(Table.Insert(1, A));
+	EXPECT_FALSE(Table.Insert(1, B));
+	EXPECT_EQ(Table.Find(1), A);
+	EXPECT_EQ(Table.Find(2), nullptr);
+	EXPECT_EQ(Table.Count(), 1u);
+
+	Table.Assign(1, B);
+	EXPECT_EQ(Table.Find(1), B);
+	EXPECT_EQ(Table.Count(), 1u);
+	Table.Assign(2, A);
+	EXPECT_EQ(Table.Count(), 2u);
+
+	EXPECT_EQ(Table.Take(1), B);
+	EXPECT_EQ(Table.Take(1), nullptr);
+	EXPECT_EQ(Table.Count(), 1u);
+	Table.Erase(2);
+	Table.Erase(2);
+	EXPECT_EQ(Table.Count(), 0u);
+}
+
+TEST(AP_WS_ConnectionTable, EraseIfOnlyErasesOnMatch) {
+	AP_WS_ConnectionTable Table;
+	Table.Resize(8);
+	auto A = Fake(), B = Fake();
+	Table.Insert(7, A);
+	EXPECT_FALSE(Table.EraseIf(7, [&](const auto &C) { return C == B; }));
+	EXPECT_EQ(Table.Find(7), A);
+	EXPECT_FALSE(Table.EraseIf(8, [](const auto &) { return true; }));
+	EXPECT_TRUE(Table.EraseIf(7, [&](const auto &C) { return C == A; }));
+	EXPECT_EQ(Table.Find(7), nullptr);
+	EXPECT_EQ(Table.Count(), 0u);
+}
+
+TEST(AP_WS_ConnectionTable, ForEachAndOccupancy) {
+	AP_WS_ConnectionTable Table;
+	Table.Resize(16);
+	std::set<AP_WS_Connection *> Inserted;
+	for (std::uint64_t Key = 0; Key < 1000; ++Key) {
+		auto C = Fake();
+		Inserted.insert(C.get());
+		Table.Insert(Key, C);
+	}
+	std::set<AP_WS_Connection *> Visited;
+	Table.ForEach([&](const auto &C) { Visited.insert(C.get()); });
+	EXPECT_EQ(Visited, Inserted);
+
+	std::uint64_t Entries = 0, Largest = 0;
+	Table.Occupancy(Entries, Largest);
+	EXPECT_EQ(Entries, 1000u);
+	EXPECT_GE(Largest, 1000u / 16);
+}
+
+//	Serial numbers of one vendor share their top 24 bits and are often sequential: the mixer must
+//	still spread them over every shard.
+TEST(AP_WS_ConnectionTable, ClusteredSerialsAreSpread) {
+	AP_WS_ConnectionTable Table;
+	Table.Resize(64);
+	constexpr std::uint64_t Count = 64 * 200;
+	for (std::uint64_t i = 0; i < Count; ++i)
+		Table.Insert(0x903cb3000000ULL + i * 4, Fake());
+	std::uint64_t Entries = 0, Largest = 0;
+	Table.Occupancy(Entries, Largest);
+	EXPECT_EQ(Entries, Count);
+	//	200 per shard on average, a uniform spread stays far below twice that.
+	EXPECT_LT(Largest, 2 * Count / 64);
+}
+
+//	Run it under -fsanitize=thread to check the shard locking.
+TEST(AP_WS_ConnectionTable, ConcurrentUse) {
+	AP_WS_ConnectionTable Table;
+	Table.Resize(32);
+	constexpr std::uint64_t PerThread = 2000;
+	std::vector<std::thread> Threads;
+	for (std::uint64_t t = 0; t < 4; ++t) {
+		Threads.emplace_back([&, t] {
+			for (std::uint64_t i = 0; i < PerThread; ++i) {
+				auto Key = t * PerThread + i;
+				Table.Insert(Key, Fake());
+				EXPECT_NE(Table.Find(Key), nullptr);
+				if (i % 2) {
+					EXPECT_NE(Table.Take(Key), nullptr);
+				}
+			}
+		});
+	}
+	Threads.emplace_back([&] {
+		for (int i = 0; i < 50; ++i) {
+			std::uint64_t Entries, Largest;
+			Table.Occupancy(Entries, Largest);
+			Table.ForEach([](const auto &) {});
+		}
+	});
+	for (auto &T : Threads)
+		T.join();
+	EXPECT_EQ(Table.Count(), 4 * PerThread / 2);
+}
@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "Poco/Logger.h"
+
+#include "AP_WS_TicketKeys.h"
+
+using namespace OpenWifi;
+
+namespace {
+
+	//	A self signed certificate, enough for a handshake with a client that does not verify it.
+	void UseTestCertificate(SSL_CTX *Context) {
+		auto *KeyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+		EVP_PKEY *Key = nullptr;
+		ASSERT_EQ(EVP_PKEY_keygen_init(KeyContext), 1);
+		ASSERT_EQ(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(KeyContext, NID_X9_62_prime256v1), 1);
+		ASSERT_EQ(EVP_PKEY_keygen(KeyContext, &Key), 1);
+		EVP_PKEY_CTX_free(KeyContext);
+
+		auto *Cert = X509_new();
+		ASN1_INTEGER_set(X509_get_serialNumber(Cert), 1);
+		X509_gmtime_adj(X509_getm_notBefore(Cert), 0);
+		X509_gmtime_adj(X509_getm_notAfter(Cert), 3600);
+		X509_set_pubkey(Cert, Key);
+		X509_NAME_add_entry_by_txt(X509_get_subject_name(Cert), "CN", MBSTRING_ASC,
+								   (const unsigned char *)"owgw-test", -1, -1, 0);
+		X509_set_issuer_name(Cert, X509_get_subject_name(Cert));
+		ASSERT_GT(X509_sign(Cert, Key, EVP_sha256()), 0);
+		ASSERT_EQ(SSL_CTX_use_certificate(Context, Cert), 1);
+		ASSERT_EQ(SSL_CTX_use_PrivateKey(Context, Key), 1);
+		X509_free(Cert);
+		EVP_PKEY_free(Key);
+	}
+
+	//	One listener: a server context using the shared ticket keys.
+	SSL_CTX *Listener(int Version) {
+		auto *Context = SSL_CTX_new(TLS_server_method());
+		SSL_CTX_set_min_proto_version(Context, Version);
+		SSL_CTX_set_max_proto_version(Context, Version);
+		UseTestCertificate(Context);
+		AP_WS_TicketKeys()->Install(Context);
+		return Context;
+	}
+
+	//	Runs a handshake over memory BIOs, then a short exchange so the client also gets the TLS 1.3
+	//	tickets sent after the handshake. Returns whether the session was resumed, and the session
+	//	to resume next time.
+	bool Connect(SSL_CTX *Server, SSL_CTX *Client, SSL_SESSION *Resume, SSL_SESSION **Next) {
+		auto *S = SSL_new(Server);
+		auto *C = SSL_new(Client);
+		auto *ToServer = BIO_new(BIO_s_mem()), *ToClient = BIO_new(BIO_s_mem());
+		BIO_set_mem_eof_return(ToServer, -1);
+		BIO_set_mem_eof_return(ToClient, -1);
+		BIO_up_ref(ToServer);
+		BIO_up_ref(ToClient);
+		SSL_set_bio(S, ToServer, ToClient);
+		SSL_set_bio(C, ToClient, ToServer);
+		SSL_set_accept_state(S);
+		SSL_set_connect_state(C);
+		if (Resume != nullptr)
+			SSL_set_session(C, Resume);
+
+		bool ClientDone = false, ServerDone = false;
+		for (int i = 0; i < 20 && !(ClientDone && ServerDone); ++i) {
+			ClientDone = ClientDone || SSL_do_handshake(C) == 1;
+			ServerDone = ServerDone || SSL_do_handshake(S) == 1;
+		}
+		EXPECT_TRUE(ClientDone && ServerDone);
+
+		char Byte = 'x';
+		EXPECT_EQ(SSL_write(S, &Byte, 1), 1);
+		EXPECT_EQ(SSL_read(C, &Byte, 1), 1);
+
+		bool Resumed = SSL_session_reused(C) == 1;
+		*Next = SSL_get1_session(C);
+		//	A session dropped without a shutdown cannot be resumed.
+		SSL_shutdown(C);
+		SSL_shutdown(S);
+		SSL_free(S);
+		SSL_free(C);
+		return Resumed;
+	}
+
+	class AP_WS_TicketKeysTest : public ::testing::TestWithParam<int> {
+	  public:
+		static void SetUpTestSuite() {
+			char Dir[] = "/tmp/owgw-ticketkeys-XXXXXX";
+			ASSERT_NE(mkdtemp(Dir), nullptr);
+			KeyFile_ = std::string(Dir) + "/ticket.keys";
+			AP_WS_TicketKeys()->Configure(3600, KeyFile_, Poco::Logger::get("test"));
+		}
+
+		static void TearDownTestSuite() {
+			std::remove(KeyFile_.c_str());
+			rmdir(KeyFile_.substr(0, KeyFile_.rfind('/')).c_str());
+		}
+
+	  protected:
+		static inline std::string KeyFile_;
+	};
+
+} // namespace
+
+TEST_P(AP_WS_TicketKeysTest, ResumesOnTheSameListener) {
+	auto *Server = Listener(GetParam());
+	auto *Client = SSL_CTX_new(TLS_client_method());
+	SSL_SESSION *First = nullptr, *Second = nullptr;
+	EXPECT_FALSE(Connect(Server, Client, nullptr, &First));
+	ASSERT_NE(First, nullptr);
+	EXPECT_TRUE(Connect(Server, Client, First, &Second));
+	SSL_SESSION_free(First);
+	SSL_SESSION_free(Second);
+	SSL_CTX_free(Client);
+	SSL_CTX_free(Server);
+}
+
+//	The keys are process wide: a ticket from one listener resumes on another, which plain OpenSSL
+//	contexts, each with their own random keys, do not do.
+TEST_P(AP_WS_TicketKeysTest, ResumesOnAnotherListener) {
+	auto *First = Listener(GetParam()), *Second = Listener(GetParam());
+	auto *Client = SSL_CTX_new(TLS_client_method());
+	SSL_SESSION *Ticket = nullptr, *Next = nullptr;
+	EXPECT_FALSE(Connect(First, Client, nullptr, &Ticket));
+	EXPECT_TRUE(Connect(Second, Client, Ticket, &Next));
+	SSL_SESSION_free(Ticket);
+	SSL_SESSION_free(Next);
+	SSL_CTX_free(Client);
+	SSL_CTX_free(First);
+	SSL_CTX_free(Second);
+}
+
+TEST_P(AP_WS_TicketKeysTest, KeyFileIsPrivate) {
+	struct stat Info {};
+	ASSERT_EQ(stat(KeyFile_.c_str(), &Info), 0);
+	EXPECT_EQ(Info.st_mode & 0777, 0600);
+	//	Current and previous key: name, AES and HMAC keys, and creation time.
+	EXPECT_EQ(Info.st_size, 2 * (16 + 32 + 32 + 8));
+}
+
+INSTANTIATE_TEST_SUITE_P(Versions, AP_WS_TicketKeysTest,
+						 ::testing::Values(TLS1_2_VERSION, TLS1_3_VERSION),
+						 [](const auto &Info) {
+							 return Info.param == TLS1_2_VERSION ? "TLS12" : "TLS13";
+						 });
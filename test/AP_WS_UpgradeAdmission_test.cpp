@@ -0,0 +1,65 @@
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "AP_WS_UpgradeAdmission.h"
+
+using namespace OpenWifi;
+
+TEST(AP_WS_UpgradeAdmission, ZeroRateAdmitsEverything) {
+	AP_WS_UpgradeAdmission Admission(0, 0);
+	Poco::Net::StreamSocket Socket;
+	for (int i = 0; i < 10000; ++i)
+		EXPECT_TRUE(Admission.accept(Socket));
+	EXPECT_EQ(Admission.Admitted(), 10000u);
+	EXPECT_EQ(Admission.Rejected(), 0u);
+}
+
+TEST(AP_WS_UpgradeAdmission, BurstThenReject) {
+	//	At one token a second, the bucket cannot refill during the test.
+	AP_WS_UpgradeAdmission Admission(1, 5);
+	Poco::Net::StreamSocket Socket;
+	for (int i = 0; i < 5; ++i)
+		EXPECT_TRUE(Admission.accept(Socket));
+	EXPECT_FALSE(Admission.accept(Socket));
+	EXPECT_FALSE(Admission.accept(Socket));
+	EXPECT_EQ(Admission.Admitted(), 5u);
+	EXPECT_EQ(Admission.Rejected(), 2u);
+}
+
+TEST(AP_WS_UpgradeAdmission, BurstIsAtLeastOne) {
+	AP_WS_UpgradeAdmission Admission(1, 0);
+	Poco::Net::StreamSocket Socket;
+	EXPECT_TRUE(Admission.accept(Socket));
+	EXPECT_FALSE(Admission.accept(Socket));
+}
+
+TEST(AP_WS_UpgradeAdmission, RefillsAtTheRateUpToTheBurst) {
+	AP_WS_UpgradeAdmission Admission(100, 3);
+	Poco::Net::StreamSocket Socket;
+	while (Admission.accept(Socket))
+		;
+	//	Long enough for many more tokens than the burst, which caps the refill.
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	int Admitted = 0;
+	while (Admission.accept(Socket))
+		++Admitted;
+	EXPECT_GE(Admitted, 3);
+	EXPECT_LE(Admitted, 4);
+}
+
+TEST(AP_WS_UpgradeAdmission, SustainedRate) {
+	AP_WS_UpgradeAdmission Admission(1000, 10);
+	Poco::Net::StreamSocket Socket;
+	auto Start = std::chrono::steady_clock::now();
+	auto End = Start + std::chrono::milliseconds(300);
+	while (std::chrono::steady_clock::now() < End)
+		Admission.accept(Socket);
+	auto Elapsed =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	//	The burst, plus one per millisecond, give or take the scheduler.
+	EXPECT_LE((double)Admission.Admitted(), 10 + 1000 * Elapsed + 1);
+	EXPECT_GE((double)Admission.Admitted(), 0.5 * 1000 * Elapsed);
+	EXPECT_GT(Admission.Rejected(), 0u);
+}
@@ -0,0 +1,90 @@
+#include <string>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include "framework/utils.h"
+
+using namespace OpenWifi;
+
+namespace {
+
+	std::string Compress(const std::string &Data) {
+		std::string Compressed(compressBound(Data.size()), '\0');
+		uLongf Size = Compressed.size();
+		compress2((Bytef *)Compressed.data(), &Size, (const Bytef *)Data.data(), Data.size(),
+				  Z_BEST_COMPRESSION);
+		Compressed.resize(Size);
+		return Compressed;
+	}
+
+	std::string Encode(const std::string &Data) {
+		return Utils::base64encode((const Utils::byte *)Data.data(), Data.size());
+	}
+
+	//	Not very compressible, so it spans several of the decoder's chunks.
+	std::string Payload(std::size_t Size) {
+		std::string Data;
+		Data.reserve(Size);
+		std::uint32_t Seed = 12345;
+		while (Data.size() < Size) {
+			Seed = Seed * 1103515245 + 12345;
+			Data += "{\"state\":" + std::to_string(Seed >> 8) + "},";
+		}
+		Data.resize(Size);
+		return Data;
+	}
+
+} // namespace
+
+TEST(ExtractBase64CompressedData, RoundTrip) {
+	auto Data = Payload(200000);
+	std::string Out;
+	ASSERT_TRUE(Utils::ExtractBase64CompressedData(Encode(Compress(Data)), Out, Data.size()));
+	EXPECT_EQ(Out, Data);
+}
+
+TEST(ExtractBase64CompressedData, WrongSizeHintIsOnlyAHint) {
+	auto Data = Payload(50000);
+	std::string Out;
+	ASSERT_TRUE(Utils::ExtractBase64CompressedData(Encode(Compress(Data)), Out, 10));
+	EXPECT_EQ(Out, Data);
+	ASSERT_TRUE(Utils::ExtractBase64CompressedData(Encode(Compress(Data)), Out, 0));
+	EXPECT_EQ(Out, Data);
+}
+
+TEST(ExtractBase64CompressedData, TruncatedStreamIsRejected) {
+	auto Compressed = Compress(Payload(100000));
+	for (auto Cut : {Compressed.size() - 1, Compressed.size() / 2, (std::size_t)10}) {
+		std::string Out = "previous";
+		EXPECT_FALSE(Utils::ExtractBase64CompressedData(Encode(Compressed.substr(0, Cut)), Out, 0))
+			<< "cut at " << Cut;
+		EXPECT_TRUE(Out.empty());
+	}
+}
+
+TEST(ExtractBase64CompressedData, CorruptStreamIsRejected) {
+	auto Compressed = Compress(Payload(10000));
+	Compressed[Compressed.size() / 2] ^= 0x55;
+	std::string Out;
+	EXPECT_FALSE(Utils::ExtractBase64CompressedData(Encode(Compressed), Out, 0));
+	EXPECT_TRUE(Out.empty());
+}
+
+TEST(ExtractBase64CompressedData, MaxSizeIsEnforced) {
+	auto Data = std::string(1 << 20, 'a');
+	auto Encoded = Encode(Compress(Data));
+	std::string Out;
+	EXPECT_FALSE(Utils::ExtractBase64CompressedData(Encoded, Out, 0, Data.size() - 1));
+	EXPECT_TRUE(Out.empty());
+	EXPECT_TRUE(Utils::ExtractBase64CompressedData(Encoded, Out, 0, Data.size()));
+	EXPECT_EQ(Out.size(), Data.size());
+}
+
+TEST(ExtractBase64CompressedData, GarbageIsRejected) {
+	std::string Out;
+	EXPECT_FALSE(Utils::ExtractBase64CompressedData("", Out, 0));
+	EXPECT_FALSE(Utils::ExtractBase64CompressedData("not base64 at all!", Out, 0));
+	EXPECT_FALSE(Utils::ExtractBase64CompressedData(Encode("plain text, not zlib"), Out, 0));
+	EXPECT_TRUE(Out.empty());
+}
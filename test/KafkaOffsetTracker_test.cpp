@@ -0,0 +1,120 @@
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "framework/KafkaOffsetTracker.h"
+
+using namespace OpenWifi;
+using namespace std::chrono_literals;
+
+namespace {
+	const auto T0 = KafkaOffsetTracker::Clock::time_point{} + 1h;
+}
+
+TEST(KafkaOffsetTracker, RouteIsStablePerPartition) {
+	for (std::size_t Workers : {1, 3, 4, 16}) {
+		for (int Partition = 0; Partition < 64; ++Partition) {
+			auto Worker = KafkaOffsetTracker::Route("command", Partition, Workers);
+			EXPECT_LT(Worker, Workers);
+			EXPECT_EQ(Worker, KafkaOffsetTracker::Route("command", Partition, Workers));
+		}
+	}
+}
+
+TEST(KafkaOffsetTracker, RouteSpreadsPartitions) {
+	std::set<std::size_t> Used;
+	for (int Partition = 0; Partition < 64; ++Partition)
+		Used.insert(KafkaOffsetTracker::Route("command", Partition, 4));
+	EXPECT_EQ(Used.size(), 4u);
+}
+
+TEST(KafkaOffsetTracker, CommitsTheNextOffsetOfEachPartition) {
+	KafkaOffsetTracker Tracker;
+	Tracker.Configure(1000, 1000, T0);
+	Tracker.Processed("a", 0, 10);
+	Tracker.Processed("a", 0, 11);
+	Tracker.Processed("a", 1, 5);
+	Tracker.Processed("b", 0, 0);
+	EXPECT_EQ(Tracker.Uncommitted(), 4u);
+
+	auto Offsets = Tracker.Take(T0);
+	ASSERT_EQ(Offsets.size(), 3u);
+	EXPECT_EQ(Offsets.at({"a", 0}), 12);
+	EXPECT_EQ(Offsets.at({"a", 1}), 6);
+	EXPECT_EQ(Offsets.at({"b", 0}), 1);
+	EXPECT_EQ(Tracker.Uncommitted(), 0u);
+	EXPECT_TRUE(Tracker.Take(T0).empty());
+}
+
+TEST(KafkaOffsetTracker, NeverMovesAPartitionBack) {
+	KafkaOffsetTracker Tracker;
+	Tracker.Configure(1000, 1000, T0);
+	Tracker.Processed("a", 0, 20);
+	Tracker.Processed("a", 0, 7);
+	EXPECT_EQ(Tracker.Take(T0).at({"a", 0}), 21);
+}
+
+TEST(KafkaOffsetTracker, DueOnBatchOrInterval) {
+	KafkaOffsetTracker Tracker;
+	Tracker.Configure(3, 1000, T0);
+	EXPECT_FALSE(Tracker.Due(T0));
+	Tracker.Processed("a", 0, 1);
+	Tracker.Processed("a", 0, 2);
+	EXPECT_FALSE(Tracker.Due(T0 + 999ms));
+	EXPECT_TRUE(Tracker.Due(T0 + 1000ms));
+	Tracker.Processed("a", 0, 3);
+	EXPECT_TRUE(Tracker.Due(T0));
+
+	//	Taking resets both the batch count and the interval.
+	Tracker.Take(T0 + 10ms);
+	EXPECT_FALSE(Tracker.Due(T0 + 500ms));
+	EXPECT_TRUE(Tracker.Due(T0 + 1010ms));
+}
+
+TEST(KafkaOffsetTracker, FailedCommitIsRetried) {
+	KafkaOffsetTracker Tracker;
+	Tracker.Configure(1000, 1000, T0);
+	Tracker.Processed("a", 0, 10);
+	Tracker.Processed("a", 1, 10);
+	auto Failed = Tracker.Take(T0);
+
+	//	A worker moves partition 0 further before the commit fails: its newer offset stays.
+	Tracker.Processed("a", 0, 15);
+	Tracker.Restore(Failed);
+	auto Retry = Tracker.Take(T0);
+	EXPECT_EQ(Retry.at({"a", 0}), 16);
+	EXPECT_EQ(Retry.at({"a", 1}), 11);
+}
+
+//	Workers record offsets while the dispatcher takes them: every partition must end up committed
+//	at its last offset, whatever the interleaving. Run it under -fsanitize=thread too.
+TEST(KafkaOffsetTracker, ConcurrentWorkersAndCommits) {
+	KafkaOffsetTracker Tracker;
+	Tracker.Configure(100, 1, T0);
+	constexpr int Partitions = 8, Messages = 5000;
+	std::vector<std::thread> Workers;
+	for (int w = 0; w < 4; ++w) {
+		Workers.emplace_back([&, w] {
+			for (int Partition = w; Partition < Partitions; Partition += 4)
+				for (int Offset = 0; Offset < Messages; ++Offset)
+					Tracker.Processed("t", Partition, Offset);
+		});
+	}
+	std::map<int, std::int64_t> Committed;
+	auto Commit = [&] {
+		for (const auto &[TopicPartition, Offset] : Tracker.Take(T0)) {
+			EXPECT_GT(Offset, Committed[TopicPartition.second]);
+			Committed[TopicPartition.second] = Offset;
+		}
+	};
+	for (int i = 0; i < 200; ++i)
+		Commit();
+	for (auto &W : Workers)
+		W.join();
+	Commit();
+	for (int Partition = 0; Partition < Partitions; ++Partition)
+		EXPECT_EQ(Committed[Partition], Messages);
+}
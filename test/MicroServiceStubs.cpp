@@ -0,0 +1,15 @@
+//
+//	The few MicroService functions reached by framework/utils.cpp, so the tests that need it do not
+//	have to link the whole service.
+//
+
+#include "framework/MicroServiceFuncs.h"
+
+namespace OpenWifi {
+
+	const std::string &MicroServiceDataDirectory() {
+		static const std::string Directory{"."};
+		return Directory;
+	}
+
+} // namespace OpenWifi
@@ -0,0 +1,151 @@
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "RADIUS_helpers.h"
+
+using namespace OpenWifi;
+using namespace OpenWifi::RADIUS;
+
+namespace {
+
+	std::string Attribute(std::uint8_t Type, const std::string &Value) {
+		return std::string{(char)Type, (char)(Value.size() + 2)} + Value;
+	}
+
+	std::string Vendor(std::uint32_t Id, const std::string &SubAttributes) {
+		std::string Value{(char)(Id >> 24), (char)(Id >> 16), (char)(Id >> 8), (char)Id};
+		return Attribute(Attributes::VENDOR_SPECIFIC, Value + SubAttributes);
+	}
+
+	std::string Packet(const std::string &Attrs, std::uint8_t Code = Accounting_Request) {
+		std::string P(AttributeOffset, '\0');
+		P[0] = (char)Code;
+		P[1] = 7;
+		auto Length = AttributeOffset + Attrs.size();
+		P[2] = (char)(Length >> 8);
+		P[3] = (char)(Length & 0xff);
+		return P + Attrs;
+	}
+
+	std::string Accounting() {
+		return Packet(Attribute(Attributes::AUTH_USERNAME, "alice") +
+					  Attribute(Attributes::CALLING_STATION_ID, "AA-BB-CC-DD-EE-FF") +
+					  Vendor(TIP_vendor_id, Attribute(TIP_serial, "90-3c-b3-00-00-01")) +
+					  Attribute(Attributes::ACCT_SESSION_ID, "0123456789ABCDEF") +
+					  Attribute(Attributes::PROXY_STATE, "903cb3000001|10.0.0.1|1812|wlan0") +
+					  Attribute(Attributes::AUTH_USERNAME, "bob"));
+	}
+
+} // namespace
+
+TEST(RadiusPacket, ParsesAndIndexesAttributes) {
+	RadiusPacket P(Accounting());
+	ASSERT_TRUE(P.IsValid());
+	EXPECT_EQ(P.UserName(), "alice"); //	the first one
+	EXPECT_EQ(P.ExtractCallingStationID(), "AA-BB-CC-DD-EE-FF");
+	EXPECT_EQ(P.ExtractAccountingSessionID(), "0123456789ABCDEF");
+	EXPECT_EQ(P.ExtractSerialNumberTIP(), "903cb3000001");
+	EXPECT_EQ(P.ExtractSerialNumberFromProxyState(), "903cb3000001");
+	EXPECT_TRUE(P.ExtractCalledStationID().empty());
+	EXPECT_TRUE(P.IsAccounting());
+}
+
+TEST(RadiusPacket, EmptyAttributesAreValid) {
+	RadiusPacket P(Packet(""));
+	EXPECT_TRUE(P.IsValid());
+	EXPECT_TRUE(P.UserName().empty());
+	RadiusPacket Q(Packet(Attribute(Attributes::AUTH_USERNAME, "")));
+	EXPECT_TRUE(Q.IsValid());
+	EXPECT_TRUE(Q.UserName().empty());
+}
+
+TEST(RadiusPacket, LengthMustMatch) {
+	auto Raw = Accounting();
+	Raw[3] = (char)(Raw[3] + 1);
+	EXPECT_FALSE(RadiusPacket(Raw).IsValid());
+	EXPECT_FALSE(RadiusPacket(Raw.substr(0, AttributeOffset - 1)).IsValid());
+	EXPECT_FALSE(RadiusPacket(std::string(sizeof(RawRadiusPacket), '\0')).IsValid());
+}
+
+TEST(RadiusPacket, MalformedAttributesAreRejected) {
+	//	Length below the 2 byte header.
+	EXPECT_FALSE(RadiusPacket(Packet(std::string{(char)Attributes::AUTH_USERNAME, 1})).IsValid());
+	EXPECT_FALSE(RadiusPacket(Packet(std::string{(char)Attributes::AUTH_USERNAME, 0})).IsValid());
+	//	Runs past the end of the packet.
+	EXPECT_FALSE(
+		RadiusPacket(Packet(std::string{(char)Attributes::AUTH_USERNAME, 10} + "abc")).IsValid());
+	//	A lone type byte with no length.
+	EXPECT_FALSE(RadiusPacket(Packet(Attribute(Attributes::AUTH_USERNAME, "alice") +
+									 std::string{(char)Attributes::CALLING_STATION_ID}))
+					 .IsValid());
+}
+
+TEST(RadiusPacket, MalformedVendorAttributesAreSkipped) {
+	//	The second sub-attribute overruns the vendor attribute: the packet stays valid, but none
+	//	of that vendor attribute's sub-attributes are indexed.
+	auto Broken = Attribute(TIP_serial, "903cb3000001") + std::string{5, 40} + "x";
+	RadiusPacket P(Packet(Vendor(TIP_vendor_id, Broken) +
+						  Attribute(Attributes::AUTH_USERNAME, "alice")));
+	ASSERT_TRUE(P.IsValid());
+	EXPECT_TRUE(P.VendorAttributeValue(TIP_vendor_id, TIP_serial).empty());
+	EXPECT_EQ(P.UserName(), "alice");
+
+	//	Too short to hold a vendor id.
+	RadiusPacket Q(Packet(Attribute(Attributes::VENDOR_SPECIFIC, "ab")));
+	EXPECT_TRUE(Q.IsValid());
+}
+
+TEST(RadiusPacket, IndexFollowsEdits) {
+	RadiusPacket P(Accounting());
+	ASSERT_TRUE(P.IsValid());
+	P.RemoveAttribute(Attributes::AUTH_USERNAME);
+	EXPECT_EQ(P.UserName(), "bob");
+	EXPECT_EQ(P.ExtractCallingStationID(), "AA-BB-CC-DD-EE-FF");
+	P.ReplaceAttribute(Attributes::ACCT_SESSION_ID, std::string("short"));
+	EXPECT_EQ(P.ExtractAccountingSessionID(), "short");
+	P.ReplaceAttribute(Attributes::ACCT_SESSION_ID, std::string("a much longer session id"));
+	EXPECT_EQ(P.ExtractAccountingSessionID(), "a much longer session id");
+	EXPECT_EQ(P.ExtractSerialNumberFromProxyState(), "903cb3000001");
+	EXPECT_EQ(P.ExtractSerialNumberTIP(), "903cb3000001");
+	EXPECT_EQ(P.Len(), P.Size());
+}
+
+//	Random corruption of a valid packet: whatever the parse decides, every attribute it returns
+//	must lie inside the packet. Build with -DASAN=1 to catch reads past it.
+TEST(RadiusPacket, FuzzedPacketsStayInBounds) {
+	std::mt19937 Random(20240501);
+	auto Valid = Accounting();
+	for (int Round = 0; Round < 100000; ++Round) {
+		auto Raw = Valid;
+		auto Changes = 1 + Random() % 8;
+		for (std::uint32_t c = 0; c < Changes; ++c) {
+			auto Pos = AttributeOffset + Random() % (Raw.size() - AttributeOffset);
+			Raw[Pos] = (char)Random();
+		}
+		if (Random() % 4 == 0) {
+			Raw.resize(AttributeOffset + Random() % (Raw.size() - AttributeOffset + 1));
+			Raw[2] = (char)(Raw.size() >> 8);
+			Raw[3] = (char)(Raw.size() & 0xff);
+		}
+
+		RadiusPacket P(Raw);
+		if (!P.IsValid())
+			continue;
+		const auto *Begin = (const char *)P.Buffer() + AttributeOffset;
+		const auto *End = (const char *)P.Buffer() + P.Size();
+		for (int Type = 0; Type < 256; ++Type) {
+			auto Value = P.AttributeValue((std::uint8_t)Type);
+			if (!Value.empty()) {
+				ASSERT_GE(Value.data(), Begin);
+				ASSERT_LE(Value.data() + Value.size(), End);
+			}
+		}
+		auto Serial = P.VendorAttributeValue(TIP_vendor_id, TIP_serial);
+		if (!Serial.empty()) {
+			ASSERT_GE(Serial.data(), Begin);
+			ASSERT_LE(Serial.data() + Serial.size(), End);
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "SharedSnapshot.h"
+
+using namespace OpenWifi;
+
+TEST(SharedSnapshot, StartsEmpty) {
+	SharedSnapshot<std::map<std::string, int>> Table;
+	EXPECT_TRUE(Table.Get().empty());
+	EXPECT_TRUE(Table.Load()->empty());
+}
+
+TEST(SharedSnapshot, ReadersSeeEachPublish) {
+	SharedSnapshot<std::map<std::string, int>> Table;
+	Table.Update([](auto &T) { T["a"] = 1; });
+	EXPECT_EQ(Table.Get().at("a"), 1);
+	Table.Publish(std::make_shared<const std::map<std::string, int>>(
+		std::map<std::string, int>{{"b", 2}}));
+	EXPECT_EQ(Table.Get().count("a"), 0u);
+	EXPECT_EQ(Table.Get().at("b"), 2);
+}
+
+TEST(SharedSnapshot, UpdateStartsFromTheCurrentTable) {
+	SharedSnapshot<std::map<std::string, int>> Table;
+	Table.Update([](auto &T) { T["a"] = 1; });
+	Table.Update([](auto &T) { T["b"] = 2; });
+	EXPECT_EQ(Table.Get().size(), 2u);
+}
+
+TEST(SharedSnapshot, LoadedSnapshotDoesNotChange) {
+	SharedSnapshot<std::map<std::string, int>> Table;
+	Table.Update([](auto &T) { T["a"] = 1; });
+	auto Old = Table.Load();
+	Table.Update([](auto &T) { T.erase("a"); });
+	EXPECT_EQ(Old->at("a"), 1);
+	EXPECT_TRUE(Table.Get().empty());
+}
+
+//	The per-thread cache is shared by every instance of the type: a thread alternating between two
+//	tables must still read each one's own content.
+TEST(SharedSnapshot, InstancesDoNotShareCachedSnapshots) {
+	SharedSnapshot<std::map<std::string, int>> First, Second;
+	First.Update([](auto &T) { T["first"] = 1; });
+	Second.Update([](auto &T) { T["second"] = 2; });
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_EQ(First.Get().count("first"), 1u);
+		EXPECT_EQ(Second.Get().count("second"), 1u);
+	}
+	SharedSnapshot<std::map<std::string, int>> Fresh;
+	EXPECT_TRUE(Fresh.Get().empty());
+}
+
+//	Readers never see a half built table, and once the writer is done every reader sees its last
+//	publish. Run it under -fsanitize=thread to check the synchronisation itself.
+TEST(SharedSnapshot, ConcurrentReadersAndWriters) {
+	using Table_t = std::vector<int>;
+	SharedSnapshot<Table_t> Table;
+	constexpr int Writes = 2000;
+	std::atomic_bool Done = false;
+	std::atomic_int Torn = 0;
+
+	std::vector<std::thread> Readers;
+	for (int r = 0; r < 4; ++r) {
+		Readers.emplace_back([&] {
+			std::size_t Last = 0;
+			while (!Done) {
+				const auto &T = Table.Get();
+				//	Every published table holds 0..n-1 and only ever grows.
+				for (std::size_t i = 0; i < T.size(); ++i) {
+					if (T[i] != (int)i)
+						++Torn;
+				}
+				if (T.size() < Last)
+					++Torn;
+				Last = T.size();
+			}
+			if (Table.Get().size() != (std::size_t)Writes)
+				++Torn;
+		});
+	}
+
+	std::vector<std::thread> Writers;
+	std::atomic_int Next = 0;
+	for (int w = 0; w < 2; ++w) {
+		Writers.emplace_back([&] {
+			while (Next++ < Writes) {
+				Table.Update([](Table_t &T) { T.push_back((int)T.size()); });
+			}
+		});
+	}
+	for (auto &W : Writers)
+		W.join();
+	Done = true;
+	for (auto &R : Readers)
+		R.join();
+
+	EXPECT_EQ(Torn, 0);
+	EXPECT_EQ(Table.Get().size(), (std::size_t)Writes);
+}
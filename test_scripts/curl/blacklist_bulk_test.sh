@@ -0,0 +1,52 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Import a generated list of serial numbers into the black list in one request, check that the
+#	export returns all of them, then remove them again. The serial numbers start with ffee and
+#	should not match real devices.
+#
+#	blacklist_bulk_test.sh [count]
+#
+
+count=${1:-100}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+serials=()
+i=0
+until [ $i -ge $count ]
+do
+  serials+=("$(printf 'ffee%08x' $i)")
+  ((i=i+1))
+done
+
+printf '%s\n' "${serials[@]}" | \
+  jq -R '{ serialNumber: ., reason: "blacklist_bulk_test" }' | \
+  jq -s '{ devices: . }' > import.json
+
+"${cli}" importblacklist import.json > /dev/null
+imported="$(jq -r '.imported' < result.json)"
+echo "imported: ${imported}, newly added: $(jq -r '.added' < result.json)"
+
+"${cli}" exportblacklist > /dev/null
+exported="$(jq -r '[.devices[] | select(.reason == "blacklist_bulk_test")] | length' < result.json)"
+echo "exported: ${exported}"
+
+for serial in "${serials[@]}"
+do
+  "${cli}" deleteblacklistdevice "${serial}" > /dev/null
+done
+
+"${cli}" exportblacklist > /dev/null
+left="$(jq -r '[.devices[] | select(.reason == "blacklist_bulk_test")] | length' < result.json)"
+echo "left after removal: ${left}"
+
+if [[ "${imported}" != "${count}" || "${exported}" != "${count}" || "${left}" != "0" ]]
+then
+  exit 1
+fi
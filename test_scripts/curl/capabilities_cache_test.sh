@@ -0,0 +1,53 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Run on the gateway host. Watch plat_cache.json and caps_cache.json while devices of known
+#	models keep connecting: the files should only be rewritten when a model reports something
+#	new, not on every connect. Also checks that the capabilities list is still served.
+#
+#	capabilities_cache_test.sh <data directory> [seconds]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: capabilities_cache_test.sh <data directory> [seconds]"
+  exit 1
+fi
+
+datadir=$1
+duration=${2:-300}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+for file in plat_cache.json caps_cache.json
+do
+  if [[ ! -f "${datadir}/${file}" ]]
+  then
+    echo "Error: ${datadir}/${file} not found"
+    exit 1
+  fi
+done
+
+( cd "${work}" && "${cli}" caplist > /dev/null )
+models="$(jq -r '.device_types | length' < "${work}/result.json")"
+echo "${models} models in the capabilities list"
+
+before_plat=$(stat -c %Y "${datadir}/plat_cache.json")
+before_caps=$(stat -c %Y "${datadir}/caps_cache.json")
+( cd "${work}" && "${cli}" connectionstatistics > /dev/null )
+before_connects="$(jq -r '.connectedDevices' < "${work}/result.json")"
+
+sleep "${duration}"
+
+after_plat=$(stat -c %Y "${datadir}/plat_cache.json")
+after_caps=$(stat -c %Y "${datadir}/caps_cache.json")
+( cd "${work}" && "${cli}" connectionstatistics > /dev/null )
+after_connects="$(jq -r '.connectedDevices' < "${work}/result.json")"
+
+echo "connected devices: ${before_connects} -> ${after_connects} over ${duration}s"
+echo "plat_cache.json rewritten: $([[ ${before_plat} != ${after_plat} ]] && echo yes || echo no)"
+echo "caps_cache.json rewritten: $([[ ${before_caps} != ${after_caps} ]] && echo yes || echo no)"
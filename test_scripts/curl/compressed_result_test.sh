@@ -0,0 +1,39 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Run a shell script on a device that prints a large, known output. The device returns it
+#	compressed (result_64), so the gateway has to inflate it before storing the command result.
+#	Check that the stored result is complete. Output larger than openwifi.session.decompressed.max
+#	is not inflated at all, so the stored result is then empty.
+#
+#	compressed_result_test.sh <serial> [lines]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: compressed_result_test.sh <serial> [lines]"
+  exit 1
+fi
+
+serial=$1
+lines=${2:-100000}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+printf '#!/bin/sh\n\nseq 1 %d\n' "${lines}" > script.sh
+"${cli}" runscript "${serial}" shell script.sh > /dev/null
+
+status="$(jq -r '.status' < result.json)"
+results="$(jq -r '.results' < result.json)"
+last="$(printf '%s' "${results}" | grep -o "[0-9]*" | tail -1)"
+echo "status: ${status}, ${#results} characters stored, last line: ${last}"
+if [[ "${status}" != "completed" || "${last}" != "${lines}" ]]
+then
+  echo "Error: the result is missing or incomplete"
+  exit 1
+fi
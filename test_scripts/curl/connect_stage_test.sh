@@ -0,0 +1,71 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Reboot a device and wait for it to connect again, then check in /api/v1/runtimeStats that the
+#	connect stage processed its connection without a failure. Uses runtime_stats.sh, so it needs
+#	OWGW_PRIVATE and OWGW_PUBLIC as well as the usual cli variables.
+#
+#	connect_stage_test.sh <serial> [timeout in seconds]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: connect_stage_test.sh <serial> [timeout]"
+  exit 1
+fi
+
+serial=$1
+timeout=${2:-300}
+here="$(cd "$(dirname "$0")" && pwd)"
+cli="${here}/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+connect_stage() {
+  "${here}/runtime_stats.sh" > /dev/null || exit 1
+  processed="$(jq -r '.connectStage.processed' < result.json)"
+  failed="$(jq -r '.connectStage.failed' < result.json)"
+}
+
+connect_stage
+processed_before=${processed}
+failed_before=${failed}
+
+"${cli}" reboot "${serial}" > /dev/null
+echo "Rebooting ${serial}..."
+
+SECONDS=0
+state=rebooting
+while (( SECONDS < timeout ))
+do
+  sleep 5
+  "${cli}" getdevicestatus "${serial}" > /dev/null
+  connected="$(jq -r '.connected' < result.json)"
+  if [[ "${state}" == "rebooting" && "${connected}" == "false" ]]
+  then
+    state=disconnected
+  elif [[ "${state}" == "disconnected" && "${connected}" == "true" ]]
+  then
+    state=connected
+    break
+  fi
+done
+
+if [[ "${state}" != "connected" ]]
+then
+  echo "Error: ${serial} did not reconnect within ${timeout}s"
+  exit 1
+fi
+sleep 5
+
+connect_stage
+echo "connect stage processed: ${processed_before} -> ${processed}, failed: ${failed_before} -> ${failed}"
+jq '.connectStage' < result.json
+if (( processed <= processed_before || failed != failed_before ))
+then
+  exit 1
+fi
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Compare the connection statistics, which are kept up to date as devices connect and leave,
+#	with what the device list shows: the connected count must match and the average connection
+#	time must fall between the shortest and the longest one. Only valid for up to 500 devices,
+#	the size of one device list page, and while no device connects or leaves during the run.
+#
+#	connection_counters_test.sh
+#
+
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" connectionstatistics > /dev/null
+counted="$(jq -r '.connectedDevices' < result.json)"
+average="$(jq -r '.averageConnectionTime' < result.json)"
+connecting="$(jq -r '.connectingDevices' < result.json)"
+
+"${cli}" deviceswithstatus > /dev/null
+listed="$(jq -r '[.devicesWithStatus[] | select(.connected == true)] | length' < result.json)"
+shortest="$(jq -r '[.devicesWithStatus[] | select(.connected == true) | .totalConnectionTime] | min // 0' < result.json)"
+longest="$(jq -r '[.devicesWithStatus[] | select(.connected == true) | .totalConnectionTime] | max // 0' < result.json)"
+
+echo "connected: ${counted} counted, ${listed} listed, ${connecting} connecting"
+echo "average connection time: ${average}s, listed between ${shortest}s and ${longest}s"
+
+if [[ "${counted}" != "${listed}" ]]
+then
+  echo "Error: the connected count does not match the device list"
+  exit 1
+fi
+if (( listed > 0 && (average < shortest - 5 || average > longest + 5) ))
+then
+  echo "Error: the average connection time is out of range"
+  exit 1
+fi
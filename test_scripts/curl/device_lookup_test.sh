@@ -0,0 +1,53 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Look up every connected device by serial number, several at a time, and check that each
+#	lookup finds the same session as the device list did. Both go through the sharded device
+#	table in AP_WS_Server. A device that reconnects during the run shows up as a mismatch.
+#
+#	device_lookup_test.sh [parallel lookups]
+#
+
+parallel=${1:-10}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" deviceswithstatus > /dev/null
+jq -r '.devicesWithStatus[] | select(.connected == true) | "\(.serialNumber) \(.sessionId)"' < result.json > connected.txt
+echo "$(wc -l < connected.txt) connected devices"
+
+running=0
+while read -r serial session
+do
+  mkdir -p "${serial}"
+  ( cd "${serial}" && "${cli}" getdevicestatus "${serial}" > /dev/null ) &
+  ((running=running+1))
+  if (( running >= parallel ))
+  then
+    wait
+    running=0
+  fi
+done < connected.txt
+wait
+
+failed=0
+while read -r serial session
+do
+  found="$(jq -r 'select(.connected == true) | .sessionId' < "${serial}/result.json" 2>/dev/null)"
+  if [[ "${found}" != "${session}" ]]
+  then
+    echo "${serial}: listed with session ${session}, lookup found '${found}'"
+    ((failed=failed+1))
+  fi
+done < connected.txt
+
+echo "${failed} mismatches"
+if [[ ${failed} -ne 0 ]]
+then
+  exit 1
+fi
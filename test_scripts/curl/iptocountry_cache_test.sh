@@ -0,0 +1,42 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Resolve the same addresses twice through /api/v1/iptocountry. The second pass is answered
+#	from the lookup cache and must return the same countries. The times include the cli login,
+#	so only a large gap, such as a slow remote provider, shows up in them.
+#
+#	iptocountry_cache_test.sh <comma separated ip list>
+#
+
+iplist=${1:-"8.8.8.8,8.8.4.4,1.1.1.1,1.0.0.1,9.9.9.9"}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+lookup() {
+  local start=$(date +%s%N)
+  "${cli}" iptocountry "${iplist}" > /dev/null
+  elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+  countries="$(jq -c '.countryCodes' < result.json)"
+}
+
+lookup
+first="${countries}"
+echo "first pass: ${first} in ${elapsed}ms"
+if [[ "$(jq -r '.enabled' < result.json)" != "true" ]]
+then
+  echo "IP to country resolution is not enabled on this gateway."
+  exit 1
+fi
+
+lookup
+echo "second pass: ${countries} in ${elapsed}ms"
+if [[ "${countries}" != "${first}" ]]
+then
+  echo "Error: cached answers differ from the first lookup"
+  exit 1
+fi
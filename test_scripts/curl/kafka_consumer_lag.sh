@@ -0,0 +1,45 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Show the committed offsets and the lag of the gateway's Kafka consumer group twice, some
+#	seconds apart. With manual commits (openwifi.kafka.auto.commit = false), the committed offsets
+#	must move forward within openwifi.kafka.consumer.commit.interval while messages arrive, and the
+#	lag must not keep growing. Needs kafka-consumer-groups.sh from the Kafka distribution.
+#
+#	kafka_consumer_lag.sh <broker host:port> [group id] [seconds]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: kafka_consumer_lag.sh <broker host:port> [group id] [seconds]"
+  exit 1
+fi
+
+if [[ "$(which kafka-consumer-groups.sh)" == "" ]]
+then
+  echo "kafka-consumer-groups.sh not found. Add the bin directory of a Kafka distribution to PATH."
+  exit 1
+fi
+
+broker=$1
+group=${2:-gateway}
+interval=${3:-10}
+
+describe() {
+  kafka-consumer-groups.sh --bootstrap-server "${broker}" --describe --group "${group}" 2>/dev/null | \
+    awk '$4 ~ /^[0-9]+$/ { committed += $4; lag += $6 } END { print committed + 0, lag + 0 }'
+}
+
+read -r committed_before lag_before <<< "$(describe)"
+sleep "${interval}"
+read -r committed_after lag_after <<< "$(describe)"
+
+echo "group ${group}: committed ${committed_before} -> ${committed_after}, lag ${lag_before} -> ${lag_after} over ${interval}s"
+if (( lag_after > lag_before && committed_after == committed_before ))
+then
+  echo "Error: messages are waiting but no offset was committed"
+  exit 1
+fi
@@ -0,0 +1,47 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Start a telemetry stream to Kafka for one device and read the device_telemetry topic with
+#	kcat. Every message for the device must carry its serial number as key and land in a
+#	single partition, which is what keeps the messages of one device in order.
+#
+#	kafka_keys_test.sh <serial> <broker host:port> [lifetime in seconds]
+#
+
+if [[ -z "$1" || -z "$2" ]]
+then
+  echo "Usage: kafka_keys_test.sh <serial> <broker host:port> [lifetime]"
+  exit 1
+fi
+
+if [[ "$(which kcat)" == "" ]]
+then
+  echo "You need the package kcat installed to use this script."
+  exit 1
+fi
+
+serial=$1
+broker=$2
+lifetime=${3:-30}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+timeout $((lifetime + 10)) kcat -b "${broker}" -C -t device_telemetry -o end -u -f '%k %p\n' > messages.txt &
+reader=$!
+sleep 2
+
+"${cli}" telemetry_to_kafka "${serial}" "${lifetime}" > /dev/null
+wait ${reader}
+
+count="$(grep -c "^${serial} " messages.txt)"
+partitions="$(grep "^${serial} " messages.txt | cut -d' ' -f2 | sort -u | wc -l)"
+echo "${count} messages for ${serial} in ${partitions} partition(s)"
+if [[ ${count} -eq 0 || ${partitions} -ne 1 ]]
+then
+  exit 1
+fi
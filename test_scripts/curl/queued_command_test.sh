@@ -0,0 +1,69 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Queue state requests to run a few seconds from now and wait for the command manager to
+#	dispatch them. Prints how late each one ran after its "when". The dispatch is driven by the
+#	in-memory queue, so this should be a second or two, not a DB polling period.
+#
+#	queued_command_test.sh <serial> [count] [delay in seconds]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: queued_command_test.sh <serial> [count] [delay]"
+  exit 1
+fi
+
+serial=$1
+count=${2:-5}
+delay=${3:-10}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+when=$(( $(date +%s) + delay ))
+uuids=()
+i=0
+until [ $i -ge $count ]
+do
+  "${cli}" requestat "${serial}" state ${when} > /dev/null
+  uuid="$(jq -r '.UUID' < result.json)"
+  if [[ -z "${uuid}" || "${uuid}" == "null" ]]
+  then
+    echo "Error: could not queue a command"
+    jq < result.json
+    exit 1
+  fi
+  uuids+=("${uuid}")
+  ((i=i+1))
+done
+echo "${count} commands queued to run at ${when}"
+
+failed=0
+SECONDS=0
+for uuid in "${uuids[@]}"
+do
+  executed=0
+  while (( executed == 0 && SECONDS < delay + 60 ))
+  do
+    sleep 1
+    "${cli}" getcommand "${uuid}" > /dev/null
+    executed="$(jq -r '.executed // 0' < result.json)"
+  done
+  if (( executed == 0 ))
+  then
+    echo "${uuid}: not executed"
+    ((failed=failed+1))
+  else
+    echo "${uuid}: executed $(( executed - when ))s after its time"
+  fi
+done
+
+if [[ ${failed} -ne 0 ]]
+then
+  exit 1
+fi
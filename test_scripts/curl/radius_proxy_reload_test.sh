@@ -0,0 +1,51 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	While devices send RADIUS traffic through the proxy, store the current proxy configuration
+#	again, which publishes a new routing table and stops the old destinations. Then check in
+#	/api/v1/runtimeStats that packets flow through the new destinations and show how many were
+#	left unrouted meanwhile. Uses runtime_stats.sh, so it needs OWGW_PRIVATE and OWGW_PUBLIC as
+#	well as the usual cli variables.
+#
+#	radius_proxy_reload_test.sh [seconds]
+#
+
+interval=${1:-30}
+here="$(cd "$(dirname "$0")" && pwd)"
+cli="${here}/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+radius_stats() {
+  "${here}/runtime_stats.sh" > /dev/null || exit 1
+  unrouted="$(jq -r '.radiusProxy.unrouted' < result.json)"
+  packets="$(jq -r '[.radiusProxy.destinations[] | .authentication + .accounting + .coa] | add // 0' < result.json)"
+}
+
+"${cli}" getradiusconfig > /dev/null
+if [[ "$(jq -r '.pools | length' < result.json)" == "0" ]]
+then
+  echo "Error: no RADIUS proxy pools are configured"
+  exit 1
+fi
+cp result.json radius_config.json
+
+radius_stats
+unrouted_before=${unrouted}
+
+"${cli}" setradiusconfig radius_config.json > /dev/null
+echo "Configuration stored again, waiting ${interval}s..."
+sleep "${interval}"
+
+radius_stats
+echo "packets through the new destinations: ${packets}, unrouted: ${unrouted_before} -> ${unrouted}"
+jq '.radiusProxy.destinations' < result.json
+if (( packets == 0 ))
+then
+  echo "Error: no packet went through the new routing table"
+  exit 1
+fi
@@ -0,0 +1,39 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	List the RADIUS sessions of every device and check the attributes the gateway reads from the
+#	accounting packets it proxies: every session must have an accounting session id, a calling
+#	and a called station id and a NAS id. Needs devices sending RADIUS accounting through the proxy.
+#
+#	radius_session_attributes_test.sh
+#
+
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" radiusaps > /dev/null
+jq -r '.serialNumbers[]' < result.json > aps.txt
+
+sessions=0
+incomplete=0
+while read -r serial
+do
+  "${cli}" radiussessions "${serial}" > /dev/null
+  count="$(jq -r '.sessions | length' < result.json)"
+  missing="$(jq -r '[.sessions[] | select(.accountingSessionId == "" or .callingStationId == "" or .calledStationId == "" or .nasId == "")] | length' < result.json)"
+  echo "${serial}: ${count} sessions, ${missing} with missing attributes"
+  jq -c '.sessions[] | select(.accountingSessionId == "" or .callingStationId == "" or .calledStationId == "" or .nasId == "")' < result.json
+  ((sessions=sessions+count))
+  ((incomplete=incomplete+missing))
+done < aps.txt
+
+echo "$(wc -l < aps.txt) devices, ${sessions} sessions, ${incomplete} incomplete"
+if [[ ${sessions} -eq 0 || ${incomplete} -ne 0 ]]
+then
+  exit 1
+fi
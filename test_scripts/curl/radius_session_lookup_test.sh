@@ -0,0 +1,62 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Take the RADIUS sessions of every device and look each one up again by user name, by client
+#	MAC (calling station id) and by accounting session id. Every lookup must return the session.
+#	Sessions that end during the run show up as misses.
+#
+#	radius_session_lookup_test.sh [max sessions]
+#
+
+max=${1:-50}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" radiusaps > /dev/null
+for serial in $(jq -r '.serialNumbers[]' < result.json)
+do
+  "${cli}" radiussessions "${serial}" > /dev/null
+  jq -c '.sessions[]' < result.json >> sessions.txt
+done
+touch sessions.txt
+echo "$(wc -l < sessions.txt) sessions found, checking up to ${max}"
+
+lookup() {
+  local command=$1 value=$2 serial=$3 session=$4
+  if [[ -z "${value}" ]]
+  then
+    return
+  fi
+  "${cli}" ${command} "$(jq -rn --arg v "${value}" '$v | @uri')" > /dev/null
+  found="$(jq -r --arg s "${serial}" --arg a "${session}" \
+    '[.sessions[] | select(.serialNumber == $s and .accountingSessionId == $a)] | length' < result.json)"
+  ((lookups=lookups+1))
+  if [[ "${found}" == "0" ]]
+  then
+    echo "${command} ${value}: session ${session} of ${serial} not returned"
+    ((misses=misses+1))
+  fi
+}
+
+lookups=0
+misses=0
+head -n "${max}" sessions.txt > checked.txt
+while read -r entry
+do
+  serial="$(jq -r '.serialNumber' <<< "${entry}")"
+  session="$(jq -r '.accountingSessionId' <<< "${entry}")"
+  lookup radiussearch "$(jq -r '.userName' <<< "${entry}")" "${serial}" "${session}"
+  lookup radiussearchmac "$(jq -r '.callingStationId' <<< "${entry}")" "${serial}" "${session}"
+  lookup radiussearchacct "${session}" "${serial}" "${session}"
+done < checked.txt
+
+echo "${lookups} lookups, ${misses} misses"
+if [[ ${lookups} -eq 0 || ${misses} -ne 0 ]]
+then
+  exit 1
+fi
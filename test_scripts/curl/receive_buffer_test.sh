@@ -0,0 +1,45 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Ask a device for a verbose wifi scan, one of the largest frames a device sends, and show the
+#	receive buffer of each reactor from /api/v1/runtimeStats before and after. The buffer of the
+#	device's reactor grows to fit the frame, and shrinks again once 256 frames in a row fit in a
+#	quarter of it. Uses runtime_stats.sh, so it needs OWGW_PRIVATE and OWGW_PUBLIC as well as the
+#	usual cli variables.
+#
+#	receive_buffer_test.sh <serial>
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: receive_buffer_test.sh <serial>"
+  exit 1
+fi
+
+serial=$1
+here="$(cd "$(dirname "$0")" && pwd)"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+buffers() {
+  "${here}/runtime_stats.sh" > /dev/null || exit 1
+  jq -c '[.reactors[].receiveBuffer]' < result.json
+}
+
+echo "receive buffers before: $(buffers)"
+
+"${here}/cli" wifiscan "${serial}" true > /dev/null
+status="$(jq -r '.status' < result.json)"
+size="$(jq -r '.results | length' < result.json)"
+echo "wifi scan: ${status}, ${size} characters stored"
+
+echo "receive buffers after:  $(buffers)"
+
+if [[ "${status}" != "completed" ]]
+then
+  exit 1
+fi
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Keep RPCs outstanding for several devices at once, so the outstanding request table holds
+#	entries for many serial numbers in different shards, and check that every answer comes
+#	back to the request that was waiting for it.
+#
+#	rpc_burst_test.sh <per device count> <serial> [<serial> ...]
+#
+
+if [[ -z "$1" || -z "$2" ]]
+then
+  echo "Usage: rpc_burst_test.sh <per device count> <serial> [<serial> ...]"
+  exit 1
+fi
+
+count=$1
+shift
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+for serial in "$@"
+do
+  i=0
+  until [ $i -ge $count ]
+  do
+    mkdir -p "${work}/${serial}/$i"
+    ( cd "${work}/${serial}/$i" && "${cli}" deviceping "${serial}" > /dev/null ) &
+    ((i=i+1))
+  done
+done
+wait
+
+failed=0
+for serial in "$@"
+do
+  for result in "${work}/${serial}"/*/result.json
+  do
+    answered="$(jq -r 'select(.deviceUTCTime == true) | .serialNumber' < "${result}" 2>/dev/null)"
+    if [[ "${answered}" != "${serial}" ]]
+    then
+      echo "${serial}: no device answer in ${result#${work}/}"
+      ((failed=failed+1))
+    fi
+  done
+done
+
+echo "$(( count * $# )) pings, ${failed} failed"
+if [[ ${failed} -ne 0 ]]
+then
+  exit 1
+fi
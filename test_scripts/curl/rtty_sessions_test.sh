@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Open RTTY sessions for several devices at the same time, so they are spread over the RTTY
+#	reactors, and check that the viewer page of every session answers.
+#
+#	rtty_sessions_test.sh <serial> [<serial> ...]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: rtty_sessions_test.sh <serial> [<serial> ...]"
+  exit 1
+fi
+
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+for serial in "$@"
+do
+  mkdir -p "${work}/${serial}"
+  ( cd "${work}/${serial}" && "${cli}" rtty "${serial}" noconnect > /dev/null ) &
+done
+wait
+
+failed=0
+for serial in "$@"
+do
+  result="${work}/${serial}/result.json"
+  cid="$(jq -r '.connectionId' < "${result}" 2>/dev/null)"
+  vport="$(jq -r '.viewport' < "${result}" 2>/dev/null)"
+  server="$(jq -r '.server' < "${result}" 2>/dev/null)"
+  if [[ -z "${cid}" || "${cid}" == "null" ]]
+  then
+    echo "${serial}: no RTTY session"
+    ((failed=failed+1))
+    continue
+  fi
+  url=https://${server}:${vport}/connect/${cid}
+  code="$(curl ${FLAGS} -L -o /dev/null -w '%{http_code}' "${url}")"
+  echo "${serial}: ${url} ${code}"
+  if [[ "${code}" != "200" ]]
+  then
+    ((failed=failed+1))
+  fi
+done
+
+echo "$# sessions, ${failed} failed"
+if [[ ${failed} -ne 0 ]]
+then
+  exit 1
+fi
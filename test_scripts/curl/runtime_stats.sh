@@ -0,0 +1,50 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Read /api/v1/runtimeStats from the internal API and show how device connections are spread
+#	over the reactors. The internal API takes the service key instead of a user token: the
+#	SHA-256 of the gateway's openwifi.system.uri.public, sent as X-API-KEY.
+#
+#	OWGW_PRIVATE=gw.example.com:17002 OWGW_PUBLIC=https://gw.example.com:16002 ./runtime_stats.sh
+#
+
+if [[ "$(which jq)" == "" ]]
+then
+  echo "You need the package jq installed to use this script."
+  exit 1
+fi
+
+if [[ -z "${OWGW_PRIVATE}" || -z "${OWGW_PUBLIC}" ]]
+then
+  echo "You must set the variables OWGW_PRIVATE and OWGW_PUBLIC in order to use this script. Something like"
+  echo "export OWGW_PRIVATE=gw.example.com:17002"
+  echo "export OWGW_PUBLIC=https://gw.example.com:16002"
+  exit 1
+fi
+
+if [[ "${FLAGS}" == "" ]]
+then
+  FLAGS="-s"
+fi
+
+result_file=result.json
+apikey="$(printf '%s' "${OWGW_PUBLIC}" | sha256sum | cut -d' ' -f1)"
+
+curl ${FLAGS} -X GET "https://${OWGW_PRIVATE}/api/v1/runtimeStats" \
+  -H "Accept: application/json" \
+  -H "X-INTERNAL-NAME: runtime_stats.sh" \
+  -H "X-API-KEY: ${apikey}" > ${result_file}
+
+if [[ "$(jq -r '.reactors | length' < ${result_file} 2>/dev/null)" == "" ]]
+then
+  echo "Error: no runtime statistics returned"
+  cat ${result_file}
+  exit 1
+fi
+
+jq < ${result_file}
+jq -r '.reactors[] | "reactor \(.id): \(.connections) connections, \(.messageRate) msg/s"' < ${result_file}
+jq -r '[.reactors[].connections] | "spread: min \(min), max \(max)"' < ${result_file}
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Send a burst of concurrent RPCs to one device, so its outbound queue has several frames
+#	waiting at once, and verify every RPC gets its answer and the device stays connected.
+#
+#	send_queue_test.sh <serial> [count]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: send_queue_test.sh <serial> [count]"
+  exit 1
+fi
+
+serial=$1
+count=${2:-20}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+i=0
+until [ $i -ge $count ]
+do
+  mkdir -p "${work}/$i"
+  ( cd "${work}/$i" && "${cli}" deviceping "${serial}" > /dev/null ) &
+  ((i=i+1))
+done
+wait
+
+failed=0
+i=0
+until [ $i -ge $count ]
+do
+  latency="$(jq -r '.latency' < "${work}/$i/result.json" 2>/dev/null)"
+  if [[ -z "${latency}" || "${latency}" == "null" ]]
+  then
+    echo "ping $i: no answer"
+    ((failed=failed+1))
+  else
+    echo "ping $i: ${latency}"
+  fi
+  ((i=i+1))
+done
+
+mkdir -p "${work}/status"
+( cd "${work}/status" && "${cli}" getdevicestatus "${serial}" > /dev/null )
+connected="$(jq -r '.connected' < "${work}/status/result.json")"
+
+echo "${count} pings, ${failed} without answer, connected: ${connected}"
+if [[ ${failed} -ne 0 || "${connected}" != "true" ]]
+then
+  exit 1
+fi
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Ask a device for a state message, then check that what the gateway derives from that one parse
+#	agrees: the last statistics kept in memory and the uptime and memory in the device status.
+#	A device that sends its own periodic state in between can make the uptimes differ; run again.
+#
+#	state_products_test.sh <serial>
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: state_products_test.sh <serial>"
+  exit 1
+fi
+
+serial=$1
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" request "${serial}" state > /dev/null
+status="$(jq -r '.status' < result.json)"
+if [[ "${status}" != "completed" ]]
+then
+  echo "Error: state request status: ${status}"
+  exit 1
+fi
+
+"${cli}" laststats "${serial}" > /dev/null
+stats_uptime="$(jq -r '.unit.uptime // empty' < result.json)"
+
+"${cli}" getdevicestatus "${serial}" > /dev/null
+status_uptime="$(jq -r '.uptime' < result.json)"
+memory_used="$(jq -r '.memoryUsed' < result.json)"
+
+echo "last statistics uptime: ${stats_uptime}, status uptime: ${status_uptime}, memory used: ${memory_used}"
+if [[ -z "${stats_uptime}" || "${stats_uptime}" != "${status_uptime}" || "${memory_used}" == "0" ]]
+then
+  echo "Error: device status does not match the last state message"
+  exit 1
+fi
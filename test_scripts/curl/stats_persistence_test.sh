@@ -0,0 +1,55 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Ask a device for a state and a healthcheck message, then wait until both records have been
+#	written by the statistics writer. The wait covers at least one storage.writer.interval.
+#
+#	stats_persistence_test.sh <serial> [timeout in seconds]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: stats_persistence_test.sh <serial> [timeout]"
+  exit 1
+fi
+
+serial=$1
+timeout=${2:-30}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+start=$(date +%s)
+"${cli}" request "${serial}" state > /dev/null
+"${cli}" request "${serial}" healthcheck > /dev/null
+
+stats=0
+health=0
+SECONDS=0
+while (( SECONDS < timeout ))
+do
+  if [[ ${stats} -eq 0 ]]
+  then
+    "${cli}" neweststats "${serial}" > /dev/null
+    recorded="$(jq -r '.data[0].recorded // 0' < result.json)"
+    if (( recorded >= start )); then stats=1; echo "statistics recorded at ${recorded}"; fi
+  fi
+  if [[ ${health} -eq 0 ]]
+  then
+    "${cli}" newesthealthchecks "${serial}" > /dev/null
+    recorded="$(jq -r '.values[0].recorded // 0' < result.json)"
+    if (( recorded >= start )); then health=1; echo "healthcheck recorded at ${recorded}"; fi
+  fi
+  if [[ ${stats} -eq 1 && ${health} -eq 1 ]]
+  then
+    exit 0
+  fi
+  sleep 2
+done
+
+echo "Error: statistics written: ${stats}, healthcheck written: ${health} after ${timeout}s"
+exit 1
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Read a device's status many times while pings to the same device are in flight, so readers
+#	of the connection snapshot run alongside the device thread updating it. Every read must see
+#	the device connected and every ping must be answered.
+#
+#	status_under_load_test.sh <serial> [count]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: status_under_load_test.sh <serial> [count]"
+  exit 1
+fi
+
+serial=$1
+count=${2:-20}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+i=0
+until [ $i -ge $count ]
+do
+  mkdir -p "${work}/ping.$i" "${work}/status.$i"
+  ( cd "${work}/ping.$i" && "${cli}" deviceping "${serial}" > /dev/null ) &
+  ( cd "${work}/status.$i" && "${cli}" getdevicestatus "${serial}" > /dev/null ) &
+  ((i=i+1))
+done
+wait
+
+pings=0
+reads=0
+i=0
+until [ $i -ge $count ]
+do
+  if [[ "$(jq -r '.deviceUTCTime' < "${work}/ping.$i/result.json" 2>/dev/null)" == "true" ]]
+  then
+    ((pings=pings+1))
+  fi
+  if [[ "$(jq -r '.connected' < "${work}/status.$i/result.json" 2>/dev/null)" == "true" ]]
+  then
+    ((reads=reads+1))
+  fi
+  ((i=i+1))
+done
+
+echo "${pings} of ${count} pings answered, ${reads} of ${count} status reads connected"
+if [[ ${pings} -ne ${count} || ${reads} -ne ${count} ]]
+then
+  exit 1
+fi
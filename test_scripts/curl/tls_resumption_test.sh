@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Connect twice to a device websocket listener with a device certificate and check that the
+#	second TLS handshake resumes the session of the first one, for TLS 1.2 and TLS 1.3.
+#
+#	tls_resumption_test.sh <host:port> <device cert> <device key> [CA file]
+#
+
+if [[ -z "$1" || -z "$2" || -z "$3" ]]
+then
+  echo "Usage: tls_resumption_test.sh <host:port> <device cert> <device key> [CA file]"
+  exit 1
+fi
+
+if [[ "$(which openssl)" == "" ]]
+then
+  echo "You need the package openssl installed to use this script."
+  exit 1
+fi
+
+server=$1
+cert=$2
+key=$3
+cafile=$4
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+handshake() {
+  local version=$1
+  shift
+  ( sleep 1 ) | openssl s_client -connect "${server}" -cert "${cert}" -key "${key}" \
+    ${cafile:+-CAfile "${cafile}"} "-${version}" -ign_eof "$@" 2>/dev/null | \
+    grep -E "^(New|Reused)," | head -1
+}
+
+failed=0
+for version in tls1_2 tls1_3
+do
+  first="$(handshake ${version} -sess_out "${work}/${version}.pem")"
+  second="$(handshake ${version} -sess_in "${work}/${version}.pem")"
+  echo "${version}: first '${first}', second '${second}'"
+  if [[ "${second}" != Reused* ]]
+  then
+    ((failed=failed+1))
+  fi
+done
+
+if [[ ${failed} -ne 0 ]]
+then
+  echo "Error: ${failed} protocol version(s) did not resume"
+  exit 1
+fi
@@ -0,0 +1,69 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Connect several UI notification clients, ask a device for a few state messages and check
+#	that every client received a device_statistics notification (type_id 6000) for each of
+#	them. The device may send its own periodic state as well, so a client may see more.
+#
+#	ui_fanout_test.sh <serial> [clients] [state requests]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: ui_fanout_test.sh <serial> [clients] [state requests]"
+  exit 1
+fi
+
+if [[ "$(which wscat)" == "" ]]
+then
+  echo "wscat command not found. Cannot start a websocket session."
+  exit 1
+fi
+
+serial=$1
+clients=${2:-5}
+requests=${3:-3}
+listen=$(( requests * 5 + 20 ))
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+
+i=0
+until [ $i -ge $clients ]
+do
+  mkdir -p "${work}/$i"
+  ( cd "${work}/$i" && "${cli}" notifications ${listen} > notifications.txt 2>&1 ) &
+  ((i=i+1))
+done
+sleep 5
+
+mkdir -p "${work}/requests"
+i=0
+until [ $i -ge $requests ]
+do
+  ( cd "${work}/requests" && "${cli}" request "${serial}" state > /dev/null )
+  ((i=i+1))
+done
+wait
+
+failed=0
+i=0
+until [ $i -ge $clients ]
+do
+  received="$(grep "${serial}" "${work}/$i/notifications.txt" | grep -c '"type_id" *: *6000')"
+  echo "client $i: ${received} device_statistics notifications"
+  if [[ ${received} -lt ${requests} ]]
+  then
+    ((failed=failed+1))
+  fi
+  ((i=i+1))
+done
+
+if [[ ${failed} -ne 0 ]]
+then
+  echo "Error: ${failed} of ${clients} clients missed notifications"
+  exit 1
+fi
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Open many websocket upgrades on a device listener at once with a device certificate, the way
+#	a reconnect storm does, and count how many were upgraded and how many were closed by the
+#	admission filter (ucentral.websocket.admission.*) or the HTTP server limits. When OWGW_PRIVATE
+#	and OWGW_PUBLIC are set, the upgrade counters of /api/v1/runtimeStats are shown as well.
+#	No connect message is sent, so upgraded sockets are closed by the gateway after a while.
+#
+#	upgrade_storm_test.sh <host:port> <device cert> <device key> [count] [CA file]
+#
+
+if [[ -z "$1" || -z "$2" || -z "$3" ]]
+then
+  echo "Usage: upgrade_storm_test.sh <host:port> <device cert> <device key> [count] [CA file]"
+  exit 1
+fi
+
+server=$1
+cert=$2
+key=$3
+count=${4:-200}
+cafile=$5
+here="$(cd "$(dirname "$0")" && pwd)"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+i=0
+until [ $i -ge $count ]
+do
+  curl -s --http1.1 --max-time 5 -o /dev/null -w '%{http_code}\n' \
+    --cert "${cert}" --key "${key}" ${cafile:+--cacert "${cafile}"} \
+    -H "Connection: Upgrade" \
+    -H "Upgrade: websocket" \
+    -H "Sec-WebSocket-Version: 13" \
+    -H "Sec-WebSocket-Key: $(head -c 16 /dev/urandom | base64)" \
+    -H "Sec-WebSocket-Protocol: ucentral-broker" \
+    "https://${server}/" > "code.$i" &
+  ((i=i+1))
+done
+wait
+
+upgraded="$(cat code.* | grep -c '^101$')"
+closed="$(cat code.* | grep -c '^000$')"
+echo "${count} upgrades: ${upgraded} upgraded, ${closed} closed, $(( count - upgraded - closed )) other answers"
+
+if [[ -n "${OWGW_PRIVATE}" && -n "${OWGW_PUBLIC}" ]]
+then
+  "${here}/runtime_stats.sh" > /dev/null && jq '.upgrades' < result.json
+fi
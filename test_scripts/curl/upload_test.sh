@@ -0,0 +1,63 @@
+#!/bin/bash
+
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+#	Take a network trace on a device, which the device uploads to the file uploader, then fetch
+#	the file back and check it is a complete pcap. The file is stored under fileuploader.path,
+#	or in the database when that directory cannot be used.
+#
+#	upload_test.sh <serial> [duration in seconds] [network]
+#
+
+if [[ -z "$1" ]]
+then
+  echo "Usage: upload_test.sh <serial> [duration] [network]"
+  exit 1
+fi
+
+serial=$1
+duration=${2:-10}
+network=${3:-up}
+cli="$(cd "$(dirname "$0")" && pwd)/cli"
+work=$(mktemp -d)
+trap 'rm -rf ${work}' EXIT
+cd "${work}" || exit 1
+
+"${cli}" trace "${serial}" "${duration}" "${network}" > /dev/null
+status="$(jq -r '.status' < result.json)"
+uuid="$(jq -r '.UUID' < result.json)"
+if [[ "${status}" != "completed" ]]
+then
+  echo "Error: trace status ${status}"
+  exit 1
+fi
+
+SECONDS=0
+attached=0
+while (( SECONDS < 60 ))
+do
+  "${cli}" getcommand "${uuid}" > /dev/null
+  attached="$(jq -r 'if .waitingForFile == 0 then .attachFile else 0 end' < result.json)"
+  if (( attached > 0 )); then break; fi
+  sleep 2
+done
+echo "command ${uuid}: file attached at ${attached}"
+
+rm -f result.json
+"${cli}" getfile "${serial}" "${uuid}" > /dev/null
+file="$(ls -t | grep -v -e '^result.json$' -e '^token.json$' | head -1)"
+received=$(stat -c %s "${file}" 2>/dev/null || echo 0)
+magic="$(od -An -tx1 -N4 "${file}" 2>/dev/null | tr -d ' ')"
+echo "received ${file}: ${received} bytes, magic ${magic}"
+
+if (( attached == 0 || received <= 24 ))
+then
+  echo "Error: the file is missing or incomplete"
+  exit 1
+fi
+case "${magic}" in
+  d4c3b2a1|a1b2c3d4|4d3cb2a1|a1b23c4d|0a0d0d0a) ;;
+  *) echo "Error: not a pcap file"; exit 1 ;;
+esac
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+#	License type: BSD 3-Clause License
+#	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+#
+
+"""
+Slow-peer harness for the device send queue.
+
+The script connects to the gateway as a device, with a tiny receive buffer, and then stops
+reading. While it is stalled, it asks the gateway through the REST API for a number of pings
+(and optionally configurations) to that device, so the gateway has to hold frames in its send
+queue and finish partial writes on later writable events. Meanwhile it pings a probe device,
+which must keep answering on time: a gateway that blocks on the slow socket would delay it.
+
+It then reads the backlog a few hundred bytes at a time, answers every command, and checks that
+every frame arrived whole and parses, that no command id is repeated and that the connection is
+still up.
+
+The device certificate must be one the gateway accepts, and its CN is the serial number used.
+REST access uses the same variables as the cli: OWSEC, OWSEC_USERNAME, OWSEC_PASSWORD and
+optionally OWGW_OVERRIDE.
+
+ ./slow_peer_test.py --gateway gw.example.com:15002 --cert dev-cert.pem --key dev-key.pem \\
+   --serial 112233445566 --probe c4411ef52d0f --pings 40 --stall 20 \\
+   --config ../curl/default_config.json --configs 5
+"""
+
+import argparse
+import base64
+import json
+import os
+import socket
+import ssl
+import struct
+import sys
+import threading
+import time
+import urllib.request
+
+
+def rest(method, url, token=None, body=None, timeout=120):
+    headers = {'Content-Type': 'application/json', 'Accept': 'application/json'}
+    if token:
+        headers['Authorization'] = 'Bearer ' + token
+    data = json.dumps(body).encode() if body is not None else None
+    req = urllib.request.Request(url, data=data, headers=headers, method=method)
+    ctx = ssl.create_default_context()
+    ctx.check_hostname = False
+    ctx.verify_mode = ssl.CERT_NONE
+    with urllib.request.urlopen(req, timeout=timeout, context=ctx) as resp:
+        raw = resp.read()
+        return json.loads(raw) if raw else {}
+
+
+def login():
+    owsec = os.environ['OWSEC']
+    token = rest('POST', 'https://%s/api/v1/oauth2' % owsec,
+                 body={'userId': os.environ['OWSEC_USERNAME'],
+                       'password': os.environ['OWSEC_PASSWORD']})['access_token']
+    owgw = os.environ.get('OWGW_OVERRIDE')
+    if not owgw:
+        endpoints = rest('GET', 'https://%s/api/v1/systemEndpoints' % owsec, token)['endpoints']
+        owgw = [e['uri'] for e in endpoints if e['type'] == 'owgw'][0].split('://')[-1]
+    return token, owgw
+
+
+class Device:
+    def __init__(self, args):
+        host, port = args.gateway.rsplit(':', 1)
+        raw = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        raw.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, args.rcvbuf)
+        raw.connect((host, int(port)))
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+        ctx.load_cert_chain(args.cert, args.key)
+        self.sock = ctx.wrap_socket(raw, server_hostname=host)
+        self.serial = args.serial
+        self.chunk = args.chunk
+        self.delay = args.delay
+        self.buffer = b''
+
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(('GET / HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n'
+                           'Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n'
+                           'Sec-WebSocket-Protocol: ucentral-broker\r\n'
+                           'Sec-WebSocket-Version: 13\r\n\r\n' % (args.gateway, key)).encode())
+        while b'\r\n\r\n' not in self.buffer:
+            self.buffer += self.sock.recv(4096)
+        head, self.buffer = self.buffer.split(b'\r\n\r\n', 1)
+        if b' 101 ' not in head.split(b'\r\n')[0]:
+            raise RuntimeError('upgrade refused: %s' % head.split(b'\r\n')[0].decode())
+
+    def send(self, message, opcode=0x1):
+        payload = json.dumps(message).encode() if opcode == 0x1 else message
+        mask = os.urandom(4)
+        length = len(payload)
+        if length < 126:
+            header = struct.pack('!BB', 0x80 | opcode, 0x80 | length)
+        elif length < 65536:
+            header = struct.pack('!BBH', 0x80 | opcode, 0x80 | 126, length)
+        else:
+            header = struct.pack('!BBQ', 0x80 | opcode, 0x80 | 127, length)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(header + mask + masked)
+
+    def need(self, count):
+        while len(self.buffer) < count:
+            data = self.sock.recv(self.chunk)
+            if not data:
+                raise RuntimeError('connection closed by the gateway')
+            self.buffer += data
+            if self.delay:
+                time.sleep(self.delay)
+
+    def take(self, count):
+        self.need(count)
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def frame(self):
+        first, second = self.take(2)
+        if second & 0x80:
+            raise RuntimeError('the gateway sent a masked frame')
+        length = second & 0x7f
+        if length == 126:
+            length = struct.unpack('!H', self.take(2))[0]
+        elif length == 127:
+            length = struct.unpack('!Q', self.take(8))[0]
+        return first, self.take(length)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Slow-peer harness for the device send queue.')
+    parser.add_argument('--gateway', required=True, help='device websocket host:port')
+    parser.add_argument('--cert', required=True, help='device certificate (PEM)')
+    parser.add_argument('--key', required=True, help='device private key (PEM)')
+    parser.add_argument('--serial', required=True, help='serial number in the certificate')
+    parser.add_argument('--probe', help='another connected device pinged during the stall')
+    parser.add_argument('--pings', type=int, default=40, help='pings sent while stalled')
+    parser.add_argument('--config', help='configuration file sent while stalled')
+    parser.add_argument('--configs', type=int, default=0, help='configurations sent while stalled')
+    parser.add_argument('--stall', type=float, default=20, help='seconds without reading')
+    parser.add_argument('--rcvbuf', type=int, default=2048, help='socket receive buffer')
+    parser.add_argument('--chunk', type=int, default=512, help='bytes per read after the stall')
+    parser.add_argument('--delay', type=float, default=0.01, help='seconds between reads')
+    parser.add_argument('--probe-limit', type=float, default=2.0,
+                        help='maximum probe ping round trip in seconds')
+    args = parser.parse_args()
+
+    token, owgw = login()
+    device = Device(args)
+    device.send({'jsonrpc': '2.0', 'method': 'connect',
+                 'params': {'serial': args.serial, 'uuid': 1, 'firmware': 'slow-peer',
+                            'capabilities': {'compatible': 'slow_peer', 'model': 'slow peer',
+                                             'platform': 'ap'}}})
+    time.sleep(2)
+
+    results = {'errors': 0, 'probe': []}
+
+    def command(path, body):
+        try:
+            rest('POST', 'https://%s/api/v1/device/%s/%s' % (owgw, args.serial, path), token,
+                 body)
+        except Exception as e:
+            print('%s: %s' % (path, e))
+            results['errors'] += 1
+
+    configuration = None
+    if args.config:
+        with open(args.config) as f:
+            configuration = json.load(f)
+
+    callers = []
+    for i in range(args.pings):
+        callers.append(threading.Thread(target=command, args=(
+            'ping', {'serialNumber': args.serial})))
+    for i in range(args.configs):
+        callers.append(threading.Thread(target=command, args=(
+            'configure', {'serialNumber': args.serial, 'UUID': 1000 + i,
+                          'configuration': configuration})))
+    for caller in callers:
+        caller.start()
+
+    stall_end = time.time() + args.stall
+    while time.time() < stall_end:
+        if args.probe:
+            start = time.time()
+            try:
+                rest('POST', 'https://%s/api/v1/device/%s/ping' % (owgw, args.probe), token,
+                     {'serialNumber': args.probe}, timeout=30)
+                results['probe'].append(time.time() - start)
+            except Exception as e:
+                print('probe ping: %s' % e)
+                results['probe'].append(float('inf'))
+        time.sleep(1)
+
+    expected = args.pings + args.configs
+    seen = set()
+    frames = 0
+    received = 0
+    device.sock.settimeout(60)
+    try:
+        while len(seen) < expected:
+            first, payload = device.frame()
+            frames += 1
+            received += len(payload)
+            opcode = first & 0x0f
+            if opcode == 0x9:
+                device.send(payload, opcode=0xA)
+                continue
+            if opcode != 0x1:
+                continue
+            message = json.loads(payload)
+            if 'id' not in message:
+                continue
+            if message['id'] in seen:
+                raise RuntimeError('command id %d received twice' % message['id'])
+            seen.add(message['id'])
+            device.send({'jsonrpc': '2.0', 'id': message['id'],
+                         'result': {'serial': args.serial,
+                                    'status': {'error': 0, 'text': 'ok', 'when': 0},
+                                    'uuid': 1}})
+    except Exception as e:
+        print('device: %s' % e)
+        results['errors'] += 1
+
+    for caller in callers:
+        caller.join()
+
+    status = rest('GET', 'https://%s/api/v1/device/%s/status' % (owgw, args.serial), token)
+    print('frames: %d (%d bytes), commands: %d of %d' % (frames, received, len(seen), expected))
+    print('send queue: high water %s, dropped %s, connected %s' % (
+        status.get('txQueueHighWater'), status.get('txDroppedFrames'), status.get('connected')))
+    if results['probe']:
+        print('probe pings during the stall: %d, slowest %.3fs' % (
+            len(results['probe']), max(results['probe'])))
+
+    failed = results['errors'] != 0 or len(seen) != expected or not status.get('connected')
+    if results['probe'] and max(results['probe']) > args.probe_limit:
+        print('Error: the probe device was slowed down by the stalled one')
+        failed = True
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())